@@ -0,0 +1,267 @@
+//      AdjacencyGraph -- Which TileGroups border each other.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <utility>
+
+#include <SFML/System/Thread.hpp>
+
+#include "AdjacencyGraph.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
+#include "TileMap.hpp"
+
+using namespace Aftermath;
+
+// The most threads to scan the map with
+#define SCAN_THREADS 4
+
+// One band of rows of the map, scanned on a worker thread
+class BorderScan {
+    public:
+        BorderScan(const TileMap & map, const std::map<const TileGroup *,
+            int> & index, std::vector<int> & tileGroup, unsigned first,
+            unsigned last) : mMap(map), mIndex(index),
+            mTileGroup(tileGroup), mFirst(first), mLast(last),
+            mFindBorders(false) {}
+
+        // Numbers the tiles of the band, or finds the borders below and to
+        // the right of each of them once every band has been numbered
+        void run() {
+            unsigned row, column, columns = mMap.columns();
+            for (row = mFirst; row < mLast; ++row) {
+                for (column = 0; column < columns; ++column) {
+                    unsigned tile = row * columns + column;
+                    if (!mFindBorders) {
+                        std::map<const TileGroup *, int>::const_iterator itr;
+                        itr = mIndex.find(mMap(row, column).getTileGroup());
+                        mTileGroup[tile] =
+                            itr == mIndex.end() ? -1 : itr->second;
+                        continue;
+                    }
+                    if (column + 1 < columns)
+                        add(mTileGroup[tile], mTileGroup[tile + 1]);
+                    if (row + 1 < mMap.rows())
+                        add(mTileGroup[tile], mTileGroup[tile + columns]);
+                }
+            }
+        }
+
+        void add(int group, int other) {
+            if (group < 0 || other < 0 || group == other) return;
+            mBorders.push_back(std::make_pair(std::min(group, other),
+                std::max(group, other)));
+        }
+
+        const TileMap & mMap;
+        const std::map<const TileGroup *, int> & mIndex;
+        std::vector<int> & mTileGroup;
+        unsigned mFirst, mLast;
+        bool mFindBorders;
+        std::vector<std::pair<int, int> > mBorders;
+};
+
+// Entry point of the worker threads
+static void runScan(BorderScan * scan) {
+    scan->run();
+}
+
+// Orders groups by name, so that every peer numbers them the same way
+static bool byName(const TileGroup * a, const TileGroup * b) {
+    return a->getName() < b->getName();
+}
+
+AdjacencyGraph::AdjacencyGraph(const TileMap & map) : mMap(map),
+    mBuilt(false), mVersion(0) {}
+
+void AdjacencyGraph::build() {
+    mGroups.assign(mMap.begin(), mMap.end());
+    std::sort(mGroups.begin(), mGroups.end(), byName);
+    mIndex.clear();
+    unsigned group;
+    for (group = 0; group < mGroups.size(); ++group)
+        mIndex[mGroups[group]] = group;
+    mTileGroup.assign(mMap.rows() * mMap.columns(), -1);
+
+    // Split the rows into bands
+    std::vector<BorderScan *> scans;
+    unsigned bands = std::min((unsigned) SCAN_THREADS, mMap.rows()), band;
+    for (band = 0; band < bands; ++band)
+        scans.push_back(new BorderScan(mMap, mIndex, mTileGroup,
+            mMap.rows() * band / bands, mMap.rows() * (band + 1) / bands));
+
+    // Number every tile, then find the borders
+    int pass;
+    for (pass = 0; pass < 2; ++pass) {
+        std::vector<sf::Thread *> threads;
+        for (band = 0; band < bands; ++band) {
+            scans[band]->mFindBorders = pass == 1;
+            threads.push_back(new sf::Thread(&runScan, scans[band]));
+            threads.back()->Launch();
+        }
+        for (band = 0; band < bands; ++band) {
+            threads[band]->Wait();
+            delete threads[band];
+        }
+    }
+
+    // Count the tile edges of each border
+    std::vector<std::pair<int, int> > borders;
+    for (band = 0; band < bands; ++band) {
+        borders.insert(borders.end(), scans[band]->mBorders.begin(),
+            scans[band]->mBorders.end());
+        delete scans[band];
+    }
+    std::sort(borders.begin(), borders.end());
+    std::vector<int> degree(mGroups.size(), 0);
+    std::vector<std::pair<int, int> >::const_iterator itr, run;
+    for (itr = borders.begin(); itr != borders.end(); itr = run) {
+        for (run = itr; run != borders.end() && *run == *itr; ++run);
+        ++degree[itr->first];
+        ++degree[itr->second];
+    }
+
+    // Lay out the rows. The borders are sorted, so each row fills up with
+    // its lower neighbours first, then its higher ones, already in order.
+    mOffsets.assign(mGroups.size() + 1, 0);
+    for (group = 0; group < mGroups.size(); ++group)
+        mOffsets[group + 1] = mOffsets[group] + degree[group];
+    mNeighbours.assign(mOffsets.back(), -1);
+    mLengths.assign(mOffsets.back(), 0);
+    std::vector<unsigned> next(mOffsets.begin(), mOffsets.end() - 1);
+    for (itr = borders.begin(); itr != borders.end(); itr = run) {
+        for (run = itr; run != borders.end() && *run == *itr; ++run);
+        int length = run - itr;
+        mNeighbours[next[itr->first]] = itr->second;
+        mLengths[next[itr->first]++] = length;
+        mNeighbours[next[itr->second]] = itr->first;
+        mLengths[next[itr->second]++] = length;
+    }
+    mBuilt = true;
+    ++mVersion;
+}
+
+bool AdjacencyGraph::isBuilt() const {
+    return mBuilt;
+}
+
+unsigned AdjacencyGraph::getVersion() const {
+    return mVersion;
+}
+
+void AdjacencyGraph::update(unsigned tile) {
+    if (!mBuilt || tile >= mTileGroup.size()) return;
+    unsigned columns = mMap.columns(), rows = mMap.rows();
+    unsigned row = tile / columns, column = tile % columns;
+    const TileGroup * now = mMap(row, column).getTileGroup();
+    int group = find(now);
+    if (now != NULL && group < 0) {
+        build();
+        return;
+    }
+    int before = mTileGroup[tile];
+    if (group == before) return;
+
+    // Move each of the tile's four borders from the old group to the new
+    int neighbours[4] = { -1, -1, -1, -1 };
+    if (row > 0) neighbours[0] = mTileGroup[tile - columns];
+    if (row + 1 < rows) neighbours[1] = mTileGroup[tile + columns];
+    if (column > 0) neighbours[2] = mTileGroup[tile - 1];
+    if (column + 1 < columns) neighbours[3] = mTileGroup[tile + 1];
+    int i;
+    for (i = 0; i < 4; ++i) {
+        if (neighbours[i] < 0) continue;
+        if (before >= 0 && before != neighbours[i])
+            addBorder(before, neighbours[i], -1);
+        if (group >= 0 && group != neighbours[i])
+            addBorder(group, neighbours[i], 1);
+    }
+    mTileGroup[tile] = group;
+    ++mVersion;
+}
+
+unsigned AdjacencyGraph::getGroupCount() const {
+    return mGroups.size();
+}
+
+const TileGroup * AdjacencyGraph::getGroup(int group) const {
+    return mGroups[group];
+}
+
+int AdjacencyGraph::find(const TileGroup * group) const {
+    std::map<const TileGroup *, int>::const_iterator itr =
+        mIndex.find(group);
+    return itr == mIndex.end() ? -1 : itr->second;
+}
+
+int AdjacencyGraph::getTileGroup(unsigned tile) const {
+    return tile < mTileGroup.size() ? mTileGroup[tile] : -1;
+}
+
+unsigned AdjacencyGraph::begin(int group) const {
+    return mOffsets[group];
+}
+
+unsigned AdjacencyGraph::end(int group) const {
+    return mOffsets[group + 1];
+}
+
+int AdjacencyGraph::getNeighbour(unsigned edge) const {
+    return mNeighbours[edge];
+}
+
+int AdjacencyGraph::getLength(unsigned edge) const {
+    return mLengths[edge];
+}
+
+int AdjacencyGraph::getBorder(int group, int other) const {
+    std::vector<int>::const_iterator first = mNeighbours.begin() +
+        begin(group), last = mNeighbours.begin() + end(group);
+    std::vector<int>::const_iterator itr =
+        std::lower_bound(first, last, other);
+    return itr != last && *itr == other ?
+        mLengths[itr - mNeighbours.begin()] : 0;
+}
+
+void AdjacencyGraph::addBorder(int group, int other, int length) {
+    addEdge(group, other, length);
+    addEdge(other, group, length);
+}
+
+// Changes the length of one side of a border, adding or removing the edge
+// when the border starts or stops
+void AdjacencyGraph::addEdge(int group, int other, int length) {
+    unsigned edge = std::lower_bound(mNeighbours.begin() + begin(group),
+        mNeighbours.begin() + end(group), other) - mNeighbours.begin();
+    if (edge == end(group) || mNeighbours[edge] != other) {
+        mNeighbours.insert(mNeighbours.begin() + edge, other);
+        mLengths.insert(mLengths.begin() + edge, 0);
+        unsigned after;
+        for (after = group + 1; after < mOffsets.size(); ++after)
+            ++mOffsets[after];
+    }
+    mLengths[edge] += length;
+    if (mLengths[edge] <= 0) {
+        mNeighbours.erase(mNeighbours.begin() + edge);
+        mLengths.erase(mLengths.begin() + edge);
+        unsigned after;
+        for (after = group + 1; after < mOffsets.size(); ++after)
+            --mOffsets[after];
+    }
+}
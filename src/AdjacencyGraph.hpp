@@ -0,0 +1,178 @@
+//      AdjacencyGraph -- Which TileGroups border each other.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef ADJACENCYGRAPH_HPP_INCLUDED
+#define ADJACENCYGRAPH_HPP_INCLUDED
+
+#include <map>
+#include <vector>
+
+namespace Aftermath { class TileGroup;
+                      class TileMap; }
+
+/**
+ * @file AdjacencyGraph.hpp
+ *
+ * Which TileGroups border each other.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * An AdjacencyGraph records which TileGroups of a TileMap share a border,
+     * and how long that border is in tile edges. Groups are numbered in
+     * order of their names, so every peer numbers them the same way.
+     *
+     * The edges are stored in compressed sparse row form: the edges of
+     * group g are numbered begin(g) up to end(g), sorted by neighbour, and
+     * every border appears once from each side. A loop over a group's
+     * neighbours looks like this:
+     *
+     * @code
+     * unsigned edge;
+     * for (edge = graph.begin(group); edge != graph.end(group); ++edge)
+     *     visit(graph.getNeighbour(edge), graph.getLength(edge));
+     * @endcode
+     *
+     * build() scans the map in horizontal bands, one thread per band. When
+     * a tile moves to another group afterwards, update() adjusts only the
+     * borders around that tile.
+     */
+    class AdjacencyGraph {
+        public:
+            /**
+             * Constructs an empty graph of the given map. Call build() once
+             * the map's groups are in place.
+             *
+             * @param map - The map to describe.
+             */
+            AdjacencyGraph(const TileMap & map);
+
+            /**
+             * Scans the whole map and rebuilds the graph.
+             */
+            void build();
+
+            /**
+             * @return true if build() has been called; false otherwise.
+             */
+            bool isBuilt() const;
+
+            /**
+             * @return A number that changes whenever the graph does, so that
+             * users of the graph know when to recompute what they derived
+             * from it.
+             */
+            unsigned getVersion() const;
+
+            /**
+             * Updates the graph after a tile has changed groups. A tile
+             * joining a group that the graph does not know yet rebuilds the
+             * whole graph. TileGroup::add() and TileGroup::remove() call
+             * this for the groups of a Game.
+             *
+             * @param tile - The tile that changed, numbered row * columns +
+             * column.
+             */
+            void update(unsigned tile);
+
+            /**
+             * @return The number of groups in the graph.
+             */
+            unsigned getGroupCount() const;
+
+            /**
+             * @param group - The number of a group.
+             *
+             * @return The group with the given number.
+             */
+            const TileGroup * getGroup(int group) const;
+
+            /**
+             * @param group - The group to look for.
+             *
+             * @return The number of the group, or -1 if it is not in the
+             * graph.
+             */
+            int find(const TileGroup * group) const;
+
+            /**
+             * @param tile - A tile, numbered row * columns + column.
+             *
+             * @return The number of the tile's group, or -1 if it has none.
+             */
+            int getTileGroup(unsigned tile) const;
+
+            /**
+             * @param group - The number of a group.
+             *
+             * @return The first edge of the group.
+             */
+            unsigned begin(int group) const;
+
+            /**
+             * @param group - The number of a group.
+             *
+             * @return One past the last edge of the group.
+             */
+            unsigned end(int group) const;
+
+            /**
+             * @param edge - An edge.
+             *
+             * @return The number of the group on the far side of the edge.
+             */
+            int getNeighbour(unsigned edge) const;
+
+            /**
+             * @param edge - An edge.
+             *
+             * @return The length of the border, in tile edges.
+             */
+            int getLength(unsigned edge) const;
+
+            /**
+             * @param group - The number of a group.
+             * @param other - The number of another group.
+             *
+             * @return The length of the border between the two groups, or 0
+             * if they do not touch.
+             */
+            int getBorder(int group, int other) const;
+
+        private:
+            void addBorder(int group, int other, int length);
+            void addEdge(int group, int other, int length);
+
+            const TileMap & mMap;
+            bool mBuilt;
+            unsigned mVersion;
+            std::vector<const TileGroup *> mGroups;
+            std::map<const TileGroup *, int> mIndex;
+            std::vector<int> mTileGroup;
+            std::vector<unsigned> mOffsets;
+            std::vector<int> mNeighbours;
+            std::vector<int> mLengths;
+    };
+
+}
+
+#endif // ADJACENCYGRAPH_HPP_INCLUDED
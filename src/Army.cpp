@@ -27,6 +27,6 @@ Army::~Army() {
     for (itr = begin(); itr != end(); ++itr) delete *itr;
 }
 
-bool Army::canAdd(const TileGroupUnit *& unit) const {
+bool Army::canAdd(TileGroupUnit * const & unit) const {
     return unit->getType().isLandUnit();
 }
@@ -20,8 +20,8 @@
 #ifndef ARMY_HPP_INCLUDED
 #define ARMY_HPP_INCLUDED
 
-#include "SelectiveCollection.hpp"
 #include "TileGroupUnit.hpp"
+#include "UnitCollection.hpp"
 
 /**
  * @file Army.hpp
@@ -36,7 +36,7 @@ namespace Aftermath {
     /**
      * An Army is a number of TileGroupUnits that travel on land.
      */
-    class Army : public SelectiveCollection<TileGroupUnit *> {
+    class Army : public UnitCollection {
         public:
             /**
              * Destructor for Army. Frees all units.
@@ -49,7 +49,7 @@ namespace Aftermath {
              * @return true if UnitType::isLandUnit() returns true,
              * false otherwise.
              */
-            bool canAdd(const TileGroupUnit *& unit) const;
+            bool canAdd(TileGroupUnit * const & unit) const;
     };
 
 }
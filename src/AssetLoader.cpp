@@ -0,0 +1,160 @@
+//      AssetLoader.cpp -- Decodes images on background threads.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Lock.hpp>
+#include <SFML/System/Sleep.hpp>
+#include <SFML/System/Thread.hpp>
+#include <SFML/Window/Context.hpp>
+
+#include "AssetLoader.hpp"
+
+using namespace Aftermath;
+
+// How long wait() sleeps before it looks again
+#define WAIT_TIME 0.001f
+
+AssetLoader::AssetLoader(unsigned workers) : mWorkers(workers), mNext(0),
+    mLoaded(0), mActive(0), mStopping(false) {}
+
+AssetLoader::~AssetLoader() {
+    {
+        sf::Lock lock(mMutex);
+        mStopping = true;
+    }
+    std::vector<sf::Thread *>::iterator thread;
+    for (thread = mThreads.begin(); thread != mThreads.end(); ++thread) {
+        (*thread)->Wait();
+        delete *thread;
+    }
+    std::vector<Asset>::iterator asset;
+    for (asset = mAssets.begin(); asset != mAssets.end(); ++asset)
+        delete asset->image;
+}
+
+AssetLoader::Handle AssetLoader::request(const std::string & path) {
+    sf::Lock lock(mMutex);
+    std::map<std::string, Handle>::const_iterator found;
+    found = mHandles.find(path);
+    if (found != mHandles.end()) return found->second;
+    Handle handle = mAssets.size();
+    Asset asset;
+    asset.path = path;
+    asset.image = NULL;
+    asset.failed = false;
+    asset.released = false;
+    mAssets.push_back(asset);
+    mHandles[path] = handle;
+    mQueue.push_back(handle);
+    // Workers that are still running take the new image before they end.
+    // Once they all have ended, they are cleaned up and a new pool starts.
+    if (mActive == 0) {
+        std::vector<sf::Thread *>::iterator thread;
+        for (thread = mThreads.begin(); thread != mThreads.end(); ++thread) {
+            (*thread)->Wait();
+            delete *thread;
+        }
+        mThreads.clear();
+        while (mThreads.size() < mWorkers) {
+            mThreads.push_back(new sf::Thread(&runWorker, this));
+            ++mActive;
+            mThreads.back()->Launch();
+        }
+    }
+    return handle;
+}
+
+sf::Image * AssetLoader::get(Handle handle) const {
+    sf::Lock lock(mMutex);
+    return handle < mAssets.size() ? mAssets[handle].image : NULL;
+}
+
+sf::Image * AssetLoader::wait(Handle handle) const {
+    while (true) {
+        {
+            sf::Lock lock(mMutex);
+            if (handle >= mAssets.size() || mAssets[handle].released)
+                return NULL;
+            if (mAssets[handle].image != NULL) return mAssets[handle].image;
+        }
+        sf::Sleep(WAIT_TIME);
+    }
+}
+
+bool AssetLoader::isFailed(Handle handle) const {
+    sf::Lock lock(mMutex);
+    return handle < mAssets.size() && mAssets[handle].failed;
+}
+
+void AssetLoader::release(Handle handle) {
+    sf::Lock lock(mMutex);
+    if (handle >= mAssets.size() || mAssets[handle].image == NULL) return;
+    delete mAssets[handle].image;
+    mAssets[handle].image = NULL;
+    mAssets[handle].released = true;
+    mHandles.erase(mAssets[handle].path);
+}
+
+unsigned AssetLoader::getRequested() const {
+    sf::Lock lock(mMutex);
+    return mAssets.size();
+}
+
+unsigned AssetLoader::getLoaded() const {
+    sf::Lock lock(mMutex);
+    return mLoaded;
+}
+
+float AssetLoader::getProgress() const {
+    sf::Lock lock(mMutex);
+    if (mAssets.empty()) return 1;
+    return (float) mLoaded / mAssets.size();
+}
+
+// Entry point of the worker threads
+void AssetLoader::runWorker(AssetLoader * loader) {
+    loader->work();
+}
+
+// Decodes queued images until there are none left, or the loader is
+// destructed
+void AssetLoader::work() {
+    sf::Context context;
+    while (true) {
+        Handle handle;
+        std::string path;
+        {
+            // Deciding to end under the lock means request() always knows
+            // whether a running worker will see its image
+            sf::Lock lock(mMutex);
+            if (mStopping || mNext == mQueue.size()) {
+                --mActive;
+                return;
+            }
+            handle = mQueue[mNext++];
+            path = mAssets[handle].path;
+        }
+        sf::Image * image = new sf::Image();
+        bool failed = !image->LoadFromFile(path);
+        sf::Lock lock(mMutex);
+        mAssets[handle].image = image;
+        mAssets[handle].failed = failed;
+        ++mLoaded;
+    }
+}
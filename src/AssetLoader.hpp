@@ -0,0 +1,161 @@
+//      AssetLoader.hpp -- Decodes images on background threads.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef ASSETLOADER_HPP_INCLUDED
+#define ASSETLOADER_HPP_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <SFML/System/Mutex.hpp>
+
+namespace sf { class Image;
+               class Thread; }
+
+/**
+ * @file AssetLoader.hpp
+ *
+ * Decodes images on background threads.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * An AssetLoader reads and decodes image files on a pool of background
+     * threads. Asking for an image returns a handle straight away; the
+     * image is published under that handle once it has been decoded, and
+     * get() returns NULL until then. Each path is only loaded once.
+     *
+     * Every worker thread has its own sf::Context, so the textures of the
+     * images it decodes are shared with the window. The loader owns the
+     * images, and frees them when it is destructed.
+     */
+    class AssetLoader {
+        public:
+            /**
+             * Identifies a requested image.
+             */
+            typedef unsigned Handle;
+
+            /**
+             * Constructs a new loader. Its threads are started when images
+             * are requested, and end once there is nothing left to decode.
+             *
+             * @param workers - The number of decoding threads.
+             */
+            AssetLoader(unsigned workers = 4);
+
+            /**
+             * Stops the threads, waiting for any decode in progress, and
+             * frees every image.
+             */
+            ~AssetLoader();
+
+            /**
+             * Queues an image to be loaded, unless it already has been.
+             *
+             * @param path - The path of the image file.
+             *
+             * @return The handle of the image.
+             */
+            Handle request(const std::string & path);
+
+            /**
+             * @param handle - The handle of an image.
+             *
+             * @return The image, or NULL if it has not been decoded yet.
+             * An image that failed to load is published empty.
+             */
+            sf::Image * get(Handle handle) const;
+
+            /**
+             * Blocks until an image has been decoded.
+             *
+             * @param handle - The handle of the image.
+             *
+             * @return The image, or NULL if the handle was never given out
+             * or its image has been released.
+             */
+            sf::Image * wait(Handle handle) const;
+
+            /**
+             * @param handle - The handle of an image that has been
+             * published.
+             *
+             * @return true if the image could not be loaded; false
+             * otherwise.
+             */
+            bool isFailed(Handle handle) const;
+
+            /**
+             * Frees a published image. Its handle is no longer valid, and
+             * requesting its path again loads it again.
+             *
+             * @param handle - The handle of the image.
+             */
+            void release(Handle handle);
+
+            /**
+             * @return The number of images requested so far.
+             */
+            unsigned getRequested() const;
+
+            /**
+             * @return The number of requested images that have been
+             * published.
+             */
+            unsigned getLoaded() const;
+
+            /**
+             * @return The fraction of requested images that have been
+             * published, from 0 to 1. This is 1 when nothing has been
+             * requested.
+             */
+            float getProgress() const;
+
+        private:
+            // One requested image
+            struct Asset {
+                std::string path;
+                sf::Image * image;
+                bool failed;
+                bool released;
+            };
+
+            unsigned mWorkers;
+            mutable sf::Mutex mMutex;
+            std::vector<Asset> mAssets;
+            std::map<std::string, Handle> mHandles;
+            std::vector<Handle> mQueue;
+            unsigned mNext;
+            unsigned mLoaded;
+            unsigned mActive;
+            bool mStopping;
+            std::vector<sf::Thread *> mThreads;
+
+            static void runWorker(AssetLoader * loader);
+            void work();
+    };
+
+}
+
+#endif // ASSETLOADER_HPP_INCLUDED
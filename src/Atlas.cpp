@@ -0,0 +1,238 @@
+//      Atlas.cpp -- Packs images into a few large pages.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "Atlas.hpp"
+
+using namespace Aftermath;
+
+#define BYTES_PER_PIXEL 4
+#define PAGE_EXTENSION ".png"
+
+// Packs the tallest images first, so that each shelf is filled with images
+// of about its own height
+struct Atlas::Taller {
+    bool operator()(const Entry & first, const Entry & second) const {
+        if (first.image->GetHeight() != second.image->GetHeight())
+            return first.image->GetHeight() > second.image->GetHeight();
+        if (first.image->GetWidth() != second.image->GetWidth())
+            return first.image->GetWidth() > second.image->GetWidth();
+        return first.name < second.name;
+    }
+};
+
+// A row of images on a page
+struct Shelf {
+    unsigned page, top, height, used;
+};
+
+// Gets the path of a page of a saved atlas
+static std::string pagePath(const std::string & path, unsigned page) {
+    std::ostringstream out;
+    out << path << page << PAGE_EXTENSION;
+    return out.str();
+}
+
+bool Atlas::ByPage::operator()(const sf::Sprite * first,
+        const sf::Sprite * second) const {
+    return first->GetImage() < second->GetImage();
+}
+
+Atlas::Atlas(unsigned pageSize, unsigned padding) : mPageSize(pageSize),
+    mPadding(padding) {}
+
+Atlas::~Atlas() {
+    clear();
+}
+
+bool Atlas::add(const std::string & name, const sf::Image & image) {
+    unsigned limit = mPageSize / 2;
+    if (image.GetWidth() + 2 * mPadding > limit ||
+        image.GetHeight() + 2 * mPadding > limit ||
+        mRegions.find(name) != mRegions.end())
+        return false;
+    std::vector<Entry>::const_iterator itr;
+    for (itr = mPending.begin(); itr != mPending.end(); ++itr)
+        if (itr->name == name) return false;
+    Entry entry;
+    entry.name = name;
+    entry.image = &image;
+    mPending.push_back(entry);
+    return true;
+}
+
+void Atlas::pack() {
+    std::stable_sort(mPending.begin(), mPending.end(), Taller());
+    // Place the images, starting after any existing pages
+    unsigned first = mPages.size();
+    std::vector<Shelf> shelves;
+    std::vector<unsigned> widths, heights;
+    std::vector<Region> regions(mPending.size());
+    unsigned i;
+    for (i = 0; i < mPending.size(); ++i) {
+        unsigned width = mPending[i].image->GetWidth() + 2 * mPadding;
+        unsigned height = mPending[i].image->GetHeight() + 2 * mPadding;
+        std::vector<Shelf>::iterator shelf;
+        for (shelf = shelves.begin(); shelf != shelves.end(); ++shelf)
+            if (shelf->height >= height && shelf->used + width <= mPageSize)
+                break;
+        if (shelf == shelves.end()) {
+            // Open a new shelf, on a new page if the last one is full
+            Shelf open;
+            if (heights.empty() || heights.back() + height > mPageSize) {
+                widths.push_back(0);
+                heights.push_back(0);
+            }
+            open.page = heights.size() - 1;
+            open.top = heights.back();
+            open.height = height;
+            open.used = 0;
+            heights.back() += height;
+            shelves.push_back(open);
+            shelf = shelves.end() - 1;
+        }
+        regions[i].page = first + shelf->page;
+        regions[i].rect = sf::IntRect(shelf->used + mPadding,
+            shelf->top + mPadding, width - 2 * mPadding,
+            height - 2 * mPadding);
+        shelf->used += width;
+        widths[shelf->page] = std::max(widths[shelf->page], shelf->used);
+    }
+    // Copy the images into the pages
+    for (i = 0; i < heights.size(); ++i) {
+        mPages.push_back(new sf::Image());
+        mPages.back()->Create(widths[i], heights[i], sf::Color(0, 0, 0, 0));
+    }
+    for (i = 0; i < mPending.size(); ++i) {
+        const sf::IntRect & rect = regions[i].rect;
+        mPages[regions[i].page]->Copy(*mPending[i].image, rect.Left,
+            rect.Top);
+        mRegions[mPending[i].name] = regions[i];
+    }
+    mPending.clear();
+}
+
+bool Atlas::update(const std::string & name, const sf::Image & image) {
+    const Region * region = find(name);
+    if (region == NULL || (unsigned) region->rect.Width != image.GetWidth()
+        || (unsigned) region->rect.Height != image.GetHeight())
+        return false;
+    mPages[region->page]->Copy(image, region->rect.Left, region->rect.Top);
+    return true;
+}
+
+void Atlas::clear() {
+    std::vector<sf::Image *>::iterator page;
+    for (page = mPages.begin(); page != mPages.end(); ++page) delete *page;
+    mPages.clear();
+    mRegions.clear();
+    mPending.clear();
+}
+
+const Atlas::Region * Atlas::find(const std::string & name) const {
+    std::map<std::string, Region>::const_iterator found;
+    found = mRegions.find(name);
+    return found != mRegions.end() ? &found->second : NULL;
+}
+
+unsigned Atlas::getPageCount() const {
+    return mPages.size();
+}
+
+const sf::Image & Atlas::getPage(unsigned page) const {
+    return *mPages[page];
+}
+
+std::size_t Atlas::getBytes() const {
+    std::size_t bytes = 0;
+    std::vector<sf::Image *>::const_iterator page;
+    for (page = mPages.begin(); page != mPages.end(); ++page)
+        bytes += BYTES_PER_PIXEL * (*page)->GetWidth() * (*page)->GetHeight();
+    return bytes;
+}
+
+sf::Sprite * Atlas::newSprite(const std::string & name) const {
+    const Region * region = find(name);
+    if (region == NULL) return NULL;
+    sf::Sprite * sprite = new sf::Sprite(*mPages[region->page]);
+    sprite->SetSubRect(region->rect);
+    return sprite;
+}
+
+bool Atlas::save(const std::string & path, Hash::Value key) const {
+    std::ofstream index(path.c_str());
+    index << std::hex << key << std::dec << " " << mPages.size() << "\n";
+    std::map<std::string, Region>::const_iterator itr;
+    for (itr = mRegions.begin(); itr != mRegions.end(); ++itr) {
+        const sf::IntRect & rect = itr->second.rect;
+        index << itr->second.page << " " << rect.Left << " " << rect.Top
+              << " " << rect.Width << " " << rect.Height << " "
+              << itr->first << "\n";
+    }
+    unsigned page;
+    for (page = 0; page < mPages.size(); ++page)
+        if (!mPages[page]->SaveToFile(pagePath(path, page))) return false;
+    return index.good();
+}
+
+bool Atlas::load(const std::string & path, Hash::Value key) {
+    clear();
+    std::ifstream index(path.c_str());
+    Hash::Value saved;
+    unsigned pages;
+    if (!(index >> std::hex >> saved >> std::dec >> pages) || saved != key)
+        return false;
+    unsigned page;
+    for (page = 0; page < pages; ++page) {
+        mPages.push_back(new sf::Image());
+        if (!mPages.back()->LoadFromFile(pagePath(path, page))) {
+            clear();
+            return false;
+        }
+    }
+    // Every region must lie within its page
+    Region region;
+    std::string name;
+    while (index >> region.page >> region.rect.Left >> region.rect.Top >>
+           region.rect.Width >> region.rect.Height && index.get() == ' ' &&
+           std::getline(index, name)) {
+        const sf::IntRect & rect = region.rect;
+        if (region.page >= pages || rect.Left < 0 || rect.Top < 0 ||
+            rect.Width < 0 || rect.Height < 0 ||
+            (unsigned) (rect.Left + rect.Width) >
+                mPages[region.page]->GetWidth() ||
+            (unsigned) (rect.Top + rect.Height) >
+                mPages[region.page]->GetHeight()) {
+            clear();
+            return false;
+        }
+        mRegions[name] = region;
+    }
+    if (!index.eof()) {
+        clear();
+        return false;
+    }
+    return true;
+}
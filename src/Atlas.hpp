@@ -0,0 +1,200 @@
+//      Atlas.hpp -- Packs images into a few large pages.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef ATLAS_HPP_INCLUDED
+#define ATLAS_HPP_INCLUDED
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Rect.hpp>
+
+#include "Hash.hpp"
+
+namespace sf { class Image;
+               class Sprite; }
+
+/**
+ * @file Atlas.hpp
+ *
+ * Packs images into a few large pages.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * An Atlas packs many small images into a few large pages, so that
+     * drawing them switches textures rarely. Images are added by name and
+     * placed when pack() is called. Each page is filled with shelves: rows
+     * as tall as the tallest image placed in them, which suits the many
+     * images of the same size that a mod has.
+     *
+     * An atlas can be saved to disk and loaded again later, as long as the
+     * images it was built from have not changed.
+     */
+    class Atlas {
+        public:
+            /**
+             * Where an image was placed.
+             */
+            struct Region {
+                unsigned page;
+                sf::IntRect rect;
+            };
+
+            /**
+             * Orders sprites by the image that they draw from. Sorting
+             * things that do not overlap, like map tiles, with this before
+             * drawing them groups them by atlas page.
+             */
+            struct ByPage {
+                bool operator()(const sf::Sprite * first,
+                    const sf::Sprite * second) const;
+            };
+
+            /**
+             * Constructs a new, empty atlas.
+             *
+             * @param pageSize - The width and greatest height of a page.
+             * @param padding - The space left around each image, so that
+             * smoothing does not bleed its neighbours into it.
+             */
+            Atlas(unsigned pageSize = 1024, unsigned padding = 1);
+
+            /**
+             * Frees the pages.
+             */
+            ~Atlas();
+
+            /**
+             * Adds an image to be packed by the next call to pack(). Images
+             * larger than half a page are refused, since they would leave
+             * little room for anything else.
+             *
+             * @param name - The name to find the image by.
+             * @param image - The image, which must outlive the call to
+             * pack().
+             *
+             * @return true if the image will be packed; false if it is too
+             * large or its name is taken.
+             */
+            bool add(const std::string & name, const sf::Image & image);
+
+            /**
+             * Places every added image and copies it into the pages. Pages
+             * are only as tall as their contents.
+             */
+            void pack();
+
+            /**
+             * Replaces a packed image with a new version of the same size,
+             * as when its file has changed.
+             *
+             * @param name - The name of the image.
+             * @param image - The new version of the image.
+             *
+             * @return true if the image was replaced; false if it was not
+             * packed or its size has changed.
+             */
+            bool update(const std::string & name, const sf::Image & image);
+
+            /**
+             * Removes every image and page.
+             */
+            void clear();
+
+            /**
+             * @param name - The name of an image.
+             *
+             * @return Where the image was packed, or NULL if it was not.
+             */
+            const Region * find(const std::string & name) const;
+
+            /**
+             * @return The number of pages.
+             */
+            unsigned getPageCount() const;
+
+            /**
+             * @param page - The index of a page.
+             *
+             * @return The page.
+             */
+            const sf::Image & getPage(unsigned page) const;
+
+            /**
+             * @return The number of bytes that the pages take up, at four
+             * bytes per pixel.
+             */
+            std::size_t getBytes() const;
+
+            /**
+             * Creates a new sprite showing a packed image.
+             *
+             * @param name - The name of the image.
+             *
+             * @return The new sprite, or NULL if the image was not packed.
+             */
+            sf::Sprite * newSprite(const std::string & name) const;
+
+            /**
+             * Writes the pages as images next to an index of the regions.
+             *
+             * @param path - The path of the index. Pages are written to the
+             * same path, followed by their number and ".png".
+             * @param key - Identifies the images the atlas was built from.
+             *
+             * @return true if everything was written; false otherwise.
+             */
+            bool save(const std::string & path, Hash::Value key) const;
+
+            /**
+             * Replaces this atlas with one written by save().
+             *
+             * @param path - The path of the index.
+             * @param key - Identifies the images the atlas should be built
+             * from. A saved atlas with a different key is out of date.
+             *
+             * @return true if the atlas was loaded; false if it is missing,
+             * damaged or out of date, in which case this atlas is empty.
+             */
+            bool load(const std::string & path, Hash::Value key);
+
+        private:
+            // An image waiting to be packed
+            struct Entry {
+                std::string name;
+                const sf::Image * image;
+            };
+
+            struct Taller;
+
+            unsigned mPageSize, mPadding;
+            std::vector<Entry> mPending;
+            std::map<std::string, Region> mRegions;
+            std::vector<sf::Image *> mPages;
+    };
+
+}
+
+#endif // ATLAS_HPP_INCLUDED
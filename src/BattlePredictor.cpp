@@ -0,0 +1,176 @@
+//      BattlePredictor.cpp -- Predicts the outcome of battles.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include <SFML/System/Thread.hpp>
+
+#include "BattlePredictor.hpp"
+#include "CombatResolver.hpp"
+#include "Game.hpp"
+#include "Hash.hpp"
+#include "TileGroupUnit.hpp"
+#include "UnitLevel.hpp"
+
+using namespace Aftermath;
+
+// The number of battles fought for each prediction
+#define TRIALS 1024
+
+// Trials are split between at most this many threads
+#define PREDICT_THREADS 4
+
+// A share of the trials, fought on a worker thread
+class BattlePredictor::Trials {
+    public:
+        Trials(const std::vector<int> & power,
+               const std::vector<int> & toughness,
+               const std::vector<unsigned> & first, Hash::Value seed,
+               unsigned begin, unsigned end) : mPower(power),
+            mToughness(toughness), mFirst(first), mSeed(seed), mBegin(begin),
+            mEnd(end), mWins(0), mLosses(0),
+            mAttackers(first[1] - first[0] + 1, 0),
+            mDefenders(first[2] - first[1] + 1, 0) {}
+
+        void run() {
+            std::vector<bool> hostile(4, true);
+            hostile[0] = hostile[3] = false;
+            std::vector<int> toughness;
+            unsigned trial, i;
+            for (trial = mBegin; trial < mEnd; ++trial) {
+                toughness = mToughness;
+                CombatResolver::fight(mPower, toughness, mFirst, hostile,
+                    Hash::combine(mSeed, trial));
+                unsigned attackers = 0, defenders = 0;
+                for (i = mFirst[0]; i < mFirst[1]; ++i)
+                    if (toughness[i] > 0) ++attackers;
+                for (i = mFirst[1]; i < mFirst[2]; ++i)
+                    if (toughness[i] > 0) ++defenders;
+                ++mAttackers[attackers];
+                ++mDefenders[defenders];
+                if (attackers > 0 && defenders == 0) ++mWins;
+                if (attackers == 0 && defenders > 0) ++mLosses;
+            }
+        }
+
+        const std::vector<int> & mPower;
+        const std::vector<int> & mToughness;
+        const std::vector<unsigned> & mFirst;
+        Hash::Value mSeed;
+        unsigned mBegin, mEnd;
+        unsigned mWins, mLosses;
+        std::vector<unsigned> mAttackers, mDefenders;
+};
+
+// Adds the strength of each unit, weakest first, to a signature
+static void sign(const std::vector<const TileGroupUnit *> & units,
+        std::vector<int> & signature) {
+    std::vector<std::pair<int, int> > strengths;
+    std::vector<const TileGroupUnit *>::const_iterator unit;
+    for (unit = units.begin(); unit != units.end(); ++unit)
+        strengths.push_back(std::make_pair((*unit)->getLevel().getPower(),
+            (*unit)->getToughness()));
+    std::sort(strengths.begin(), strengths.end());
+    signature.push_back(strengths.size());
+    unsigned i;
+    for (i = 0; i < strengths.size(); ++i) {
+        signature.push_back(strengths[i].first);
+        signature.push_back(strengths[i].second);
+    }
+}
+
+// Entry point of the worker threads
+void BattlePredictor::runTrials(Trials * trials) {
+    trials->run();
+}
+
+BattlePredictor::BattlePredictor(const Game & game) : mGame(game),
+    mTurn(game.getTurn()), mSimulations(0) {}
+
+BattlePredictor::Odds BattlePredictor::predict(
+        const std::vector<const TileGroupUnit *> & attackers,
+        const std::vector<const TileGroupUnit *> & defenders) {
+    if (mGame.getTurn() != mTurn) {
+        mOdds.clear();
+        mTurn = mGame.getTurn();
+    }
+    std::vector<int> signature;
+    sign(attackers, signature);
+    sign(defenders, signature);
+    std::map<std::vector<int>, Odds>::iterator found = mOdds.find(signature);
+    if (found != mOdds.end()) return found->second;
+
+    // Pack both sides as CombatResolver::fight() expects
+    std::vector<int> power, toughness;
+    std::vector<unsigned> first(1, 0);
+    Hash::Value seed = 0;
+    unsigned i = 0, side;
+    for (side = 0; side < 2; ++side) {
+        unsigned count = signature[i++], unit;
+        for (unit = 0; unit < count; ++unit) {
+            power.push_back(signature[i++]);
+            toughness.push_back(signature[i++]);
+        }
+        first.push_back(power.size());
+    }
+    for (i = 0; i < signature.size(); ++i)
+        seed = Hash::combine(seed, signature[i]);
+
+    // Fight the trials in parallel
+    std::vector<Trials *> trials;
+    std::vector<sf::Thread *> threads;
+    for (i = 0; i < PREDICT_THREADS; ++i) {
+        trials.push_back(new Trials(power, toughness, first, seed,
+            TRIALS * i / PREDICT_THREADS, TRIALS * (i + 1) / PREDICT_THREADS));
+        threads.push_back(new sf::Thread(&runTrials, trials.back()));
+        threads.back()->Launch();
+    }
+    for (i = 0; i < threads.size(); ++i) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    // Add up the results
+    Odds & odds = mOdds[signature];
+    unsigned wins = 0, losses = 0, k;
+    odds.attackers.assign(first[1] - first[0] + 1, 0);
+    odds.defenders.assign(first[2] - first[1] + 1, 0);
+    for (i = 0; i < trials.size(); ++i) {
+        wins += trials[i]->mWins;
+        losses += trials[i]->mLosses;
+        for (k = 0; k < odds.attackers.size(); ++k)
+            odds.attackers[k] += trials[i]->mAttackers[k] / (float) TRIALS;
+        for (k = 0; k < odds.defenders.size(); ++k)
+            odds.defenders[k] += trials[i]->mDefenders[k] / (float) TRIALS;
+        delete trials[i];
+    }
+    odds.win = wins / (float) TRIALS;
+    odds.loss = losses / (float) TRIALS;
+    odds.draw = 1 - odds.win - odds.loss;
+    ++mSimulations;
+    return odds;
+}
+
+unsigned BattlePredictor::getCacheSize() const {
+    return mOdds.size();
+}
+
+unsigned BattlePredictor::getSimulationCount() const {
+    return mSimulations;
+}
@@ -0,0 +1,110 @@
+//      BattlePredictor.hpp -- Predicts the outcome of battles.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef BATTLEPREDICTOR_HPP_INCLUDED
+#define BATTLEPREDICTOR_HPP_INCLUDED
+
+#include <map>
+#include <vector>
+
+namespace Aftermath { class Game;
+                      class TileGroupUnit; }
+
+/**
+ * @file BattlePredictor.hpp
+ *
+ * Predicts the outcome of battles.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A BattlePredictor estimates how an attack would go by fighting it
+     * many times with CombatResolver::fight(). The trials are split between
+     * worker threads. Each trial has its own random stream, seeded by the
+     * forces involved, so every peer predicts the same odds.
+     *
+     * Predictions are remembered by the strength of each unit on each side,
+     * so asking again about the same forces costs nothing. The memory is
+     * cleared when the game turn changes.
+     */
+    class BattlePredictor {
+        public:
+            /**
+             * The predicted outcome of a battle.
+             */
+            struct Odds {
+                /** The chance that only the attackers survive. */
+                float win;
+                /** The chance that only the defenders survive. */
+                float loss;
+                /** The chance that both sides, or neither, survive. */
+                float draw;
+                /** The chance that exactly k attackers survive, by k. */
+                std::vector<float> attackers;
+                /** The chance that exactly k defenders survive, by k. */
+                std::vector<float> defenders;
+            };
+
+            /**
+             * Constructs a BattlePredictor for the given game.
+             *
+             * @param game - The game whose turns clear the memory.
+             */
+            BattlePredictor(const Game & game);
+
+            /**
+             * Predicts a battle between two forces. The worker threads
+             * fight copies of the units' power and toughness, taken before
+             * they start, so no unit may change while this runs.
+             *
+             * @param attackers - The attacking units.
+             * @param defenders - The defending units.
+             *
+             * @return The predicted outcome.
+             */
+            Odds predict(const std::vector<const TileGroupUnit *> & attackers,
+                const std::vector<const TileGroupUnit *> & defenders);
+
+            /**
+             * @return The number of predictions remembered this turn.
+             */
+            unsigned getCacheSize() const;
+
+            /**
+             * @return The number of predictions that had to be simulated.
+             */
+            unsigned getSimulationCount() const;
+
+        private:
+            class Trials;
+
+            static void runTrials(Trials * trials);
+
+            const Game & mGame;
+            int mTurn;
+            std::map<std::vector<int>, Odds> mOdds;
+            unsigned mSimulations;
+    };
+
+}
+
+#endif // BATTLEPREDICTOR_HPP_INCLUDED
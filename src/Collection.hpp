@@ -21,6 +21,7 @@
 #define COLLECTION_HPP_INCLUDED
 
 #include <set>
+#include <vector>
 
 /**
  * @file Collection.hpp
@@ -59,6 +60,17 @@ namespace Aftermath {
                 mElements.insert(element);
             }
 
+            /**
+             * Adds several elements at once. Elements that are already in
+             * this Collection are skipped. This is quickest when the
+             * elements are sorted.
+             *
+             * @param elements - The elements to add.
+             */
+            virtual void addAll(const std::vector<T> & elements) {
+                mElements.insert(elements.begin(), elements.end());
+            }
+
             /**
              * Removes an element from this collection.
              *
@@ -71,7 +83,7 @@ namespace Aftermath {
             /**
              * Removes all elements from this collection.
              */
-            void clear() {
+            virtual void clear() {
                 mElements.clear();
             }
 
@@ -0,0 +1,302 @@
+//      CombatResolver.cpp -- Resolves the battles of a game turn.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <map>
+
+#include <SFML/System/Thread.hpp>
+
+#include "CombatResolver.hpp"
+#include "Game.hpp"
+#include "Hash.hpp"
+#include "Player.hpp"
+#include "TileGroup.hpp"
+#include "TileGroupUnit.hpp"
+#include "TileMap.hpp"
+#include "Treaty.hpp"
+#include "UnitCollection.hpp"
+
+using namespace Aftermath;
+
+// Battles are fought on at most this many threads
+#define BATTLE_THREADS 4
+
+// The longest a battle can last in one turn
+#define MAX_ROUNDS 8
+
+// A side deals its power divided by this as damage each round
+#define DAMAGE_DIVISOR 4
+
+// Toughness is kept in 1/256ths of a point during a battle
+#define FIXED_SHIFT 8
+
+// Rolls are in [0, ROLL_RANGE)
+#define ROLL_RANGE 65536
+
+// @return The next roll from the given random stream
+static int roll(Hash::Value & seed) {
+    seed += Hash::make(0x9e3779b9UL, 0x7f4a7c15UL);
+    return (int) (Hash::mix(seed) >> 48);
+}
+
+// Orders groups by name
+static bool byName(const TileGroup * a, const TileGroup * b) {
+    return a->getName() < b->getName();
+}
+
+// Orders unit slots by owner, then strength. Units that tie are
+// interchangeable.
+struct ByOwner {
+    ByOwner(const TileGroupUnit::Columns & columns) : mColumns(columns) {}
+
+    bool operator()(unsigned a, unsigned b) const {
+        int owner = mColumns.owners[a]->getId(),
+            other = mColumns.owners[b]->getId();
+        if (owner != other) return owner < other;
+        if (mColumns.power[a] != mColumns.power[b])
+            return mColumns.power[a] < mColumns.power[b];
+        return mColumns.toughness[a] < mColumns.toughness[b];
+    }
+
+    const TileGroupUnit::Columns & mColumns;
+};
+
+// @return true if either player has declared war on the other
+static bool atWar(const Player & a, const Player & b) {
+    return a.getTreaty(&b).getMission() == WAR ||
+           b.getTreaty(&a).getMission() == WAR;
+}
+
+// The units of one contested group, packed for the worker threads
+class CombatResolver::Battle {
+    public:
+        Battle(TileGroup & group, Hash::Value seed,
+            const std::vector<unsigned> & slots) : mGroup(group),
+            mSeed(seed), mSlots(slots) {}
+
+        // Packs the units of the group from the unit columns. This runs on
+        // the main thread, and returns false if there is nobody to fight.
+        bool prepare(const TileGroupUnit::Columns & columns) {
+            std::sort(mSlots.begin(), mSlots.end(), ByOwner(columns));
+            std::vector<const Player *> owners;
+            unsigned i;
+            for (i = 0; i < mSlots.size(); ++i) {
+                mPower.push_back(columns.power[mSlots[i]]);
+                mToughness.push_back(columns.toughness[mSlots[i]]);
+                const Player * owner = columns.owners[mSlots[i]];
+                if (owners.empty() || owners.back() != owner) {
+                    owners.push_back(owner);
+                    mFirst.push_back(i);
+                }
+            }
+            mFirst.push_back(mSlots.size());
+
+            bool hostile = false;
+            unsigned a, b;
+            mHostile.assign(owners.size() * owners.size(), false);
+            for (a = 0; a < owners.size(); ++a) {
+                for (b = a + 1; b < owners.size(); ++b) {
+                    if (!atWar(*owners[a], *owners[b])) continue;
+                    mHostile[a * owners.size() + b] = true;
+                    mHostile[b * owners.size() + a] = true;
+                    hostile = true;
+                }
+            }
+            return hostile;
+        }
+
+        // Fights the battle. This touches nothing but the packed arrays, so
+        // any number of battles can run at once.
+        void run() {
+            fight(mPower, mToughness, mFirst, mHostile, mSeed);
+        }
+
+        // Writes the result back to the group. This runs on the main
+        // thread, and returns the number of units destroyed.
+        int apply() {
+            int casualties = 0;
+            unsigned i;
+            for (i = 0; i < mSlots.size(); ++i) {
+                TileGroupUnit * unit = TileGroupUnit::getSlot(mSlots[i]);
+                if (mToughness[i] <= 0) {
+                    mGroup.getUnits().remove(unit);
+                    delete unit;
+                    ++casualties;
+                } else if (mToughness[i] != unit->getToughness()) {
+                    unit->setToughness(mToughness[i]);
+                }
+            }
+            return casualties;
+        }
+
+    private:
+        TileGroup & mGroup;
+        Hash::Value mSeed;
+        // The slots of the units, grouped by owner; side s is
+        // [mFirst[s], mFirst[s + 1])
+        std::vector<unsigned> mSlots;
+        std::vector<int> mPower;
+        std::vector<int> mToughness;
+        std::vector<unsigned> mFirst;
+        std::vector<bool> mHostile;
+};
+
+// Entry point of the worker threads
+void CombatResolver::runBattles(std::vector<Battle *> * battles) {
+    std::vector<Battle *>::iterator itr;
+    for (itr = battles->begin(); itr != battles->end(); ++itr) (*itr)->run();
+}
+
+void CombatResolver::fight(const std::vector<int> & power,
+        std::vector<int> & toughness, const std::vector<unsigned> & first,
+        const std::vector<bool> & hostile, Hash::Value seed) {
+    unsigned sides = first.size() - 1, units = toughness.size(), side, enemy,
+        i, end, round;
+    std::vector<int> strength(sides), alive(sides), damage(sides);
+    if (toughness.empty()) return;
+    // The bounds are read into locals, since stores through t could alias
+    // first as far as the compiler knows, and that stops vectorization
+    std::vector<int> fixed(toughness);
+    const int * p = &power[0];
+    int * t = &fixed[0];
+    for (i = 0; i < units; ++i) t[i] <<= FIXED_SHIFT;
+    for (round = 0; round < MAX_ROUNDS; ++round) {
+        // Sum up the surviving units of each side
+        for (side = 0; side < sides; ++side) {
+            int total = 0, count = 0;
+            end = first[side + 1];
+            for (i = first[side]; i < end; ++i) {
+                int live = t[i] > 0;
+                total += p[i] * live;
+                count += live;
+            }
+            strength[side] = total;
+            alive[side] = count;
+            damage[side] = 0;
+        }
+        // Each side splits its fire between the enemies left
+        bool fighting = false;
+        for (side = 0; side < sides; ++side) {
+            if (alive[side] == 0) continue;
+            int enemies = 0;
+            for (enemy = 0; enemy < sides; ++enemy)
+                if (hostile[side * sides + enemy] && alive[enemy] > 0)
+                    ++enemies;
+            if (enemies == 0) continue;
+            fighting = true;
+            // The roll scales the fire by [0.5, 1.5)
+            Hash::Value scaled = ((Hash::Value) strength[side] <<
+                FIXED_SHIFT) * (ROLL_RANGE / 2 + roll(seed));
+            int fire = (int) (scaled / ((Hash::Value) ROLL_RANGE *
+                DAMAGE_DIVISOR * enemies));
+            for (enemy = 0; enemy < sides; ++enemy)
+                if (hostile[side * sides + enemy] && alive[enemy] > 0)
+                    damage[enemy] += fire;
+        }
+        if (!fighting) break;
+        // Spread the damage evenly over each side's survivors
+        for (side = 0; side < sides; ++side) {
+            if (damage[side] == 0) continue;
+            int hit = damage[side] / alive[side];
+            end = first[side + 1];
+            for (i = first[side]; i < end; ++i) {
+                int left = t[i] - hit;
+                t[i] = left > 0 ? left : 0;
+            }
+        }
+    }
+
+    // Round up, so that only destroyed units end up with nothing
+    for (i = 0; i < units; ++i)
+        toughness[i] = (t[i] + (1 << FIXED_SHIFT) - 1) >> FIXED_SHIFT;
+}
+
+CombatResolver::CombatResolver(Game & game) : mGame(game), mBattles(0),
+    mCasualties(0) {}
+
+int CombatResolver::resolve() {
+    // Number the groups in name order
+    TileMap & map = mGame.getMap();
+    std::vector<TileGroup *> groups(map.begin(), map.end());
+    std::sort(groups.begin(), groups.end(), byName);
+    std::map<const UnitCollection *, unsigned> index;
+    unsigned i;
+    for (i = 0; i < groups.size(); ++i)
+        index[static_cast<const UnitCollection *>(&groups[i]->getUnits())] =
+            i;
+
+    // Stream through the unit columns once, sorting the slots by group.
+    // Units of other games are in the columns too, but not in the index.
+    const TileGroupUnit::Columns & columns = TileGroupUnit::getColumns();
+    std::vector<std::vector<unsigned> > slots(groups.size());
+    std::map<const UnitCollection *, unsigned>::const_iterator found =
+        index.end();
+    unsigned slot;
+    for (slot = 0; slot < columns.locations.size(); ++slot) {
+        const UnitCollection * location = columns.locations[slot];
+        if (location == NULL) continue;
+        // Units made together tend to sit side by side in the same group
+        if (found == index.end() || found->first != location)
+            found = index.find(location);
+        if (found != index.end()) slots[found->second].push_back(slot);
+    }
+
+    // Find the battles, in name order
+    std::vector<Battle *> battles;
+    for (i = 0; i < groups.size(); ++i) {
+        if (slots[i].size() < 2) continue;
+        Battle * battle = new Battle(*groups[i], Hash::combine(
+            Hash::string(groups[i]->getName()), mGame.getTurn()), slots[i]);
+        if (battle->prepare(columns)) battles.push_back(battle);
+        else delete battle;
+    }
+
+    // Fight them in parallel
+    unsigned workers = std::min((unsigned) BATTLE_THREADS,
+        (unsigned) battles.size());
+    std::vector<std::vector<Battle *> > shares(workers);
+    for (i = 0; i < battles.size(); ++i)
+        shares[i % workers].push_back(battles[i]);
+    std::vector<sf::Thread *> threads;
+    for (i = 0; i < workers; ++i) {
+        threads.push_back(new sf::Thread(&runBattles, &shares[i]));
+        threads.back()->Launch();
+    }
+    for (i = 0; i < threads.size(); ++i) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    // Write the results back in the same order on every peer
+    mCasualties = 0;
+    for (i = 0; i < battles.size(); ++i) {
+        mCasualties += battles[i]->apply();
+        delete battles[i];
+    }
+    mBattles = battles.size();
+    return mBattles;
+}
+
+int CombatResolver::getBattleCount() const {
+    return mBattles;
+}
+
+int CombatResolver::getCasualties() const {
+    return mCasualties;
+}
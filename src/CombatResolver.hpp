@@ -0,0 +1,118 @@
+//      CombatResolver.hpp -- Resolves the battles of a game turn.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef COMBATRESOLVER_HPP_INCLUDED
+#define COMBATRESOLVER_HPP_INCLUDED
+
+#include <vector>
+
+#include "Hash.hpp"
+
+namespace Aftermath { class Game; }
+
+/**
+ * @file CombatResolver.hpp
+ *
+ * Resolves the battles of a game turn.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A CombatResolver fights out every battle in the game at once. A
+     * TileGroup is contested when its Army or Navy holds units of two
+     * players, one of whom is at WAR with the other. Each owner in a
+     * contested group is a side, and each side fires on every side it is at
+     * war with for up to a fixed number of rounds. A side's fire is the
+     * power of its surviving units, scaled by a random roll, and is spread
+     * evenly over the surviving units of the sides it hits. A unit whose
+     * toughness drops to zero is destroyed.
+     *
+     * The units of each battle are packed into flat arrays, grouped by side,
+     * so that each round is a few tight loops the compiler can vectorize.
+     * The arithmetic is all integer, with toughness kept in fixed point
+     * during a battle, so that it is exact and the same on every platform
+     * and the loops vectorize without relaxing floating point rules.
+     * Battles are independent and are fought in parallel. Each one draws
+     * from its own random stream, seeded by the turn and the name of its
+     * group, so every peer gets the same result whatever the thread timing.
+     * The results are written back on the calling thread in name order.
+     */
+    class CombatResolver {
+        public:
+            /**
+             * Constructs a CombatResolver for the given game.
+             *
+             * @param game - The game to fight battles in.
+             */
+            CombatResolver(Game & game);
+
+            /**
+             * Fights every battle in the game. The units are read into
+             * each battle before the worker threads start, and changed
+             * after they end, so no unit may change while this runs.
+             *
+             * @return The number of battles fought.
+             */
+            int resolve();
+
+            /**
+             * @return The number of battles fought by the last resolve().
+             */
+            int getBattleCount() const;
+
+            /**
+             * @return The number of units destroyed by the last resolve().
+             */
+            int getCasualties() const;
+
+            /**
+             * Fights one battle on packed arrays. This is the combat model
+             * used by resolve(), and is safe to call from any thread.
+             *
+             * @param power - The power of each unit, grouped by side.
+             * @param toughness - The toughness of each unit, in the same
+             * order. This is updated with what is left after the battle,
+             * rounded up, so only destroyed units are left with 0.
+             * @param first - The index of the first unit of each side,
+             * followed by the number of units.
+             * @param hostile - For sides a and b, hostile[a * sides + b] is
+             * true if side a fires on side b.
+             * @param seed - The seed of the battle's random stream.
+             */
+            static void fight(const std::vector<int> & power,
+                std::vector<int> & toughness,
+                const std::vector<unsigned> & first,
+                const std::vector<bool> & hostile, Hash::Value seed);
+
+        private:
+            class Battle;
+
+            static void runBattles(std::vector<Battle *> * battles);
+
+            Game & mGame;
+            int mBattles;
+            int mCasualties;
+    };
+
+}
+
+#endif // COMBATRESOLVER_HPP_INCLUDED
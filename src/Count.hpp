@@ -53,7 +53,7 @@ namespace Aftermath {
 
     template <typename T>
     int Count<T>::getCount(const T & element) const {
-        typename Count<T>::const_iterator itr = find(element);
+        typename Count<T>::const_iterator itr = this->find(element);
         if (itr != std::map<T, int>::end()) return itr->second;
         else return 0;
     }
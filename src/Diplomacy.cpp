@@ -0,0 +1,372 @@
+//      Diplomacy.cpp -- The treaties between the players of a game.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include "Diplomacy.hpp"
+#include "StateHash.hpp"
+
+using namespace Aftermath;
+
+// The number of kinds of Mission
+#define MISSIONS (COLONY + 1)
+
+// The number of bits in a bitset word
+#define BITS 32
+
+// @return true if the mission binds players into a coalition whose closure
+// is kept
+static bool isCoalition(int mission) {
+    return mission == PACT || mission == ALLIANCE || mission == EMPIRE ||
+           mission == COLONY;
+}
+
+Diplomacy::Diplomacy() : mHash(NULL), mSize(0), mWords(0),
+    mStale(MISSIONS, false), mStaleEmpires(false) {}
+
+void Diplomacy::attach(StateHash * hash) {
+    Hash::Value facts = 0;
+    unsigned index;
+    for (index = 0; index < mMissions.size(); ++index)
+        facts += StateHash::treaty(index / mSize, index % mSize, load(index));
+    if (mHash != NULL) mHash->remove(facts);
+    mHash = hash;
+    if (mHash != NULL) mHash->add(facts);
+}
+
+Treaty Diplomacy::get(int player, int other) const {
+    if (player < 0 || other < 0 || (unsigned) player >= mSize ||
+        (unsigned) other >= mSize)
+        return Treaty();
+    return load(player * mSize + other);
+}
+
+void Diplomacy::set(int player, int other, const Treaty & treaty) {
+    if (player < 0 || other < 0) return;
+    unsigned needed = std::max(player, other) + 1;
+    if (needed > mSize) grow(std::max(needed, mSize * 2));
+    store(player, other, treaty);
+    close();
+    if (mHash != NULL) mHash->changeBorders();
+}
+
+void Diplomacy::reset(int player) {
+    if (player < 0 || (unsigned) player >= mSize) return;
+    Treaty initial;
+    unsigned other;
+    for (other = 0; other < mSize; ++other) {
+        store(player, other, initial);
+        store(other, player, initial);
+    }
+    close();
+}
+
+void Diplomacy::decay(int amount) {
+    int neutral = Treaty().getRelationship();
+    // Only the treaties that move change the hash
+    std::vector<unsigned> moved;
+    Hash::Value before = 0, after = 0;
+    unsigned index, count = mRelationships.size();
+    for (index = 0; index < count; ++index) {
+        if (mRelationships[index] == neutral) continue;
+        moved.push_back(index);
+        before += StateHash::treaty(index / mSize, index % mSize,
+            load(index));
+    }
+    if (moved.empty()) return;
+
+    int * relationships = &mRelationships[0];
+    for (index = 0; index < count; ++index) {
+        int relationship = relationships[index];
+        int down = std::max(relationship - amount, neutral);
+        int up = std::min(relationship + amount, neutral);
+        relationships[index] = relationship > neutral ? down : up;
+    }
+
+    std::vector<unsigned>::const_iterator itr;
+    for (itr = moved.begin(); itr != moved.end(); ++itr)
+        after += StateHash::treaty(*itr / mSize, *itr % mSize, load(*itr));
+    if (mHash != NULL) mHash->replace(before, after);
+}
+
+bool Diplomacy::hasMission(int player, int other,
+        enum Mission mission) const {
+    if (player < 0 || other < 0 || (unsigned) player >= mSize ||
+        (unsigned) other >= mSize)
+        return Treaty().getMission() == mission;
+    return test(mFrom, mission * mSize + player, other);
+}
+
+bool Diplomacy::isAtWar(int player, int other) const {
+    if (player < 0 || other < 0 || (unsigned) player >= mSize ||
+        (unsigned) other >= mSize)
+        return Treaty().getMission() == WAR;
+    // A war declared by either side sets a bit of one of the rows
+    unsigned word = (WAR * mSize + player) * mWords + other / BITS;
+    return ((mFrom[word] | mTo[word]) >> (other % BITS)) & 1;
+}
+
+void Diplomacy::find(int player, enum Mission mission,
+        std::vector<int> & others) const {
+    others.clear();
+    if (player < 0 || (unsigned) player >= mSize) return;
+    collect(&mFrom[(mission * mSize + player) * mWords], others);
+}
+
+void Diplomacy::findEnemies(int player, std::vector<int> & enemies) const {
+    enemies.clear();
+    if (player < 0 || (unsigned) player >= mSize) return;
+    unsigned row = (WAR * mSize + player) * mWords, word;
+    std::vector<sf::Uint32> either(mWords);
+    for (word = 0; word < mWords; ++word)
+        either[word] = mFrom[row + word] | mTo[row + word];
+    collect(&either[0], enemies);
+}
+
+bool Diplomacy::isConnected(int player, int other,
+        enum Mission mission) const {
+    if (player == other) return true;
+    if (player < 0 || other < 0 || (unsigned) player >= mSize ||
+        (unsigned) other >= mSize)
+        return false;
+    if (!isCoalition(mission)) return false;
+    return test(mConnected, mission * mSize + player, other);
+}
+
+void Diplomacy::findConnected(int player, enum Mission mission,
+        std::vector<int> & others) const {
+    others.clear();
+    if (player < 0 || (unsigned) player >= mSize || !isCoalition(mission))
+        return;
+    collect(&mConnected[(mission * mSize + player) * mWords], others);
+    others.erase(std::find(others.begin(), others.end(), player));
+}
+
+bool Diplomacy::isSubject(int player, int overlord) const {
+    if (player < 0 || overlord < 0 || (unsigned) player >= mSize ||
+        (unsigned) overlord >= mSize)
+        return false;
+    return test(mSubjects, overlord, player);
+}
+
+void Diplomacy::findSubjects(int overlord, std::vector<int> & subjects)
+        const {
+    subjects.clear();
+    if (overlord < 0 || (unsigned) overlord >= mSize) return;
+    collect(&mSubjects[overlord * mWords], subjects);
+}
+
+// Makes room for the given number of players, keeping every treaty
+void Diplomacy::grow(unsigned size) {
+    Treaty initial;
+    std::vector<sf::Uint8> missions(size * size, initial.getMission());
+    std::vector<sf::Uint8> boycotts(size * size, initial.getBoycott());
+    std::vector<int> grants(size * size, initial.getGrant());
+    std::vector<int> subsidies(size * size, initial.getSubsidy());
+    std::vector<int> relationships(size * size, initial.getRelationship());
+    unsigned player, other;
+    for (player = 0; player < mSize; ++player) {
+        for (other = 0; other < mSize; ++other) {
+            unsigned from = player * mSize + other, to = player * size + other;
+            missions[to] = mMissions[from];
+            boycotts[to] = mBoycotts[from];
+            grants[to] = mGrants[from];
+            subsidies[to] = mSubsidies[from];
+            relationships[to] = mRelationships[from];
+        }
+    }
+    mMissions.swap(missions);
+    mBoycotts.swap(boycotts);
+    mGrants.swap(grants);
+    mSubsidies.swap(subsidies);
+    mRelationships.swap(relationships);
+    mSize = size;
+    mWords = (size + BITS - 1) / BITS;
+    mFrom.assign(MISSIONS * mSize * mWords, 0);
+    mTo.assign(MISSIONS * mSize * mWords, 0);
+    for (player = 0; player < mSize; ++player)
+        for (other = 0; other < mSize; ++other)
+            mark(player, other, mMissions[player * mSize + other], true);
+    mConnected.assign(MISSIONS * mSize * mWords, 0);
+    mSubjects.assign(mSize * mWords, 0);
+    int mission;
+    for (mission = 0; mission < MISSIONS; ++mission)
+        mStale[mission] = isCoalition(mission);
+    mStaleEmpires = true;
+}
+
+// Writes one treaty, keeping the hash and the bitsets up to date
+void Diplomacy::store(unsigned player, unsigned other, const Treaty & treaty) {
+    unsigned index = player * mSize + other;
+    Treaty before = load(index);
+    if (mHash != NULL)
+        mHash->replace(StateHash::treaty(player, other, before),
+            StateHash::treaty(player, other, treaty));
+    mark(player, other, before.getMission(), false);
+    if (before.getMission() != treaty.getMission()) {
+        unlink(before.getMission(), player, other);
+        link(treaty.getMission(), player, other);
+    }
+    mMissions[index] = treaty.getMission();
+    mBoycotts[index] = treaty.getBoycott();
+    mGrants[index] = treaty.getGrant();
+    mSubsidies[index] = treaty.getSubsidy();
+    mRelationships[index] = treaty.getRelationship();
+    mark(player, other, treaty.getMission(), true);
+}
+
+// Sets or clears the bits of one treaty's mission
+void Diplomacy::mark(unsigned player, unsigned other, int mission, bool on) {
+    sf::Uint32 & from =
+        mFrom[(mission * mSize + player) * mWords + other / BITS];
+    sf::Uint32 & to = mTo[(mission * mSize + other) * mWords + player / BITS];
+    if (on) {
+        from |= 1UL << (other % BITS);
+        to |= 1UL << (player % BITS);
+    } else {
+        from &= ~(1UL << (other % BITS));
+        to &= ~(1UL << (player % BITS));
+    }
+}
+
+// @return The treaty at the given index of the matrix
+Treaty Diplomacy::load(unsigned index) const {
+    Treaty treaty;
+    treaty.setMission((enum Mission) mMissions[index]);
+    treaty.setBoycott(mBoycotts[index]);
+    treaty.setGrant(mGrants[index]);
+    treaty.setSubsidy(mSubsidies[index]);
+    treaty.setRelationship(mRelationships[index]);
+    return treaty;
+}
+
+// Adds the ids of the set bits of a bitset row
+void Diplomacy::collect(const sf::Uint32 * row, std::vector<int> & ids)
+        const {
+    unsigned word, bit;
+    for (word = 0; word < mWords; ++word) {
+        sf::Uint32 bits = row[word];
+        for (bit = 0; bits != 0; ++bit, bits >>= 1)
+            if (bits & 1) ids.push_back(word * BITS + bit);
+    }
+}
+
+// @return true if the given bit of the given bitset row is set
+bool Diplomacy::test(const std::vector<sf::Uint32> & rows, unsigned row,
+        int bit) const {
+    return (rows[row * mWords + bit / BITS] >> (bit % BITS)) & 1;
+}
+
+// Marks the closures that a broken treaty may split. Nothing splits if the
+// players are still linked the other way round.
+void Diplomacy::unlink(int mission, unsigned player, unsigned other) {
+    if (!isCoalition(mission)) return;
+    if (!test(mFrom, mission * mSize + other, player))
+        mStale[mission] = true;
+    if (mission == EMPIRE && !test(mFrom, COLONY * mSize + other, player))
+        mStaleEmpires = true;
+    if (mission == COLONY && !test(mFrom, EMPIRE * mSize + other, player))
+        mStaleEmpires = true;
+}
+
+// Adds a treaty to the closures that have not gone stale. Making a treaty
+// only ever joins closures.
+void Diplomacy::link(int mission, unsigned player, unsigned other) {
+    unsigned word, i;
+    if (!isCoalition(mission)) return;
+    if (!mStale[mission]) {
+        // Both players' coalitions become one
+        sf::Uint32 * a = &mConnected[(mission * mSize + player) * mWords];
+        sf::Uint32 * b = &mConnected[(mission * mSize + other) * mWords];
+        if (!((a[other / BITS] >> (other % BITS)) & 1)) {
+            std::vector<sf::Uint32> joined(mWords);
+            for (word = 0; word < mWords; ++word)
+                joined[word] = a[word] | b[word];
+            std::vector<int> members;
+            collect(&joined[0], members);
+            for (i = 0; i < members.size(); ++i)
+                std::copy(joined.begin(), joined.end(), &mConnected[
+                    (mission * mSize + members[i]) * mWords]);
+        }
+    }
+    if ((mission == EMPIRE || mission == COLONY) && !mStaleEmpires) {
+        // The subject, and its subjects, join every empire above it
+        unsigned overlord = mission == EMPIRE ? player : other;
+        unsigned subject = mission == EMPIRE ? other : player;
+        std::vector<sf::Uint32> joined(&mSubjects[subject * mWords],
+            &mSubjects[subject * mWords] + mWords);
+        joined[subject / BITS] |= 1UL << (subject % BITS);
+        for (i = 0; i < mSize; ++i)
+            if (i == overlord || test(mSubjects, i, overlord))
+                for (word = 0; word < mWords; ++word)
+                    mSubjects[i * mWords + word] |= joined[word];
+    }
+}
+
+// Rebuilds the closures that have gone stale
+void Diplomacy::close() {
+    unsigned mission, player, other, word;
+    for (mission = 0; mission < MISSIONS; ++mission) {
+        if (!mStale[mission]) continue;
+        mStale[mission] = false;
+        // Spread from each unvisited player along its links in either
+        // direction, then give every member the whole set
+        std::vector<bool> visited(mSize, false);
+        for (player = 0; player < mSize; ++player) {
+            if (visited[player]) continue;
+            std::vector<sf::Uint32> members(mWords, 0);
+            std::vector<unsigned> open(1, player);
+            visited[player] = true;
+            while (!open.empty()) {
+                unsigned next = open.back();
+                open.pop_back();
+                members[next / BITS] |= 1UL << (next % BITS);
+                unsigned row = (mission * mSize + next) * mWords;
+                for (other = 0; other < mSize; ++other) {
+                    if (visited[other]) continue;
+                    sf::Uint32 bit = 1UL << (other % BITS);
+                    if ((mFrom[row + other / BITS] | mTo[row + other / BITS])
+                        & bit) {
+                        visited[other] = true;
+                        open.push_back(other);
+                    }
+                }
+            }
+            for (other = 0; other < mSize; ++other)
+                if ((members[other / BITS] >> (other % BITS)) & 1)
+                    std::copy(members.begin(), members.end(), &mConnected[
+                        (mission * mSize + other) * mWords]);
+        }
+    }
+    if (mStaleEmpires) {
+        mStaleEmpires = false;
+        // Direct subjects, then Warshall's algorithm, one row at a time
+        for (player = 0; player < mSize; ++player)
+            for (word = 0; word < mWords; ++word)
+                mSubjects[player * mWords + word] =
+                    mFrom[(EMPIRE * mSize + player) * mWords + word] |
+                    mTo[(COLONY * mSize + player) * mWords + word];
+        for (other = 0; other < mSize; ++other)
+            for (player = 0; player < mSize; ++player)
+                if (test(mSubjects, player, other))
+                    for (word = 0; word < mWords; ++word)
+                        mSubjects[player * mWords + word] |=
+                            mSubjects[other * mWords + word];
+    }
+}
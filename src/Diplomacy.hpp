@@ -0,0 +1,233 @@
+//      Diplomacy.hpp -- The treaties between the players of a game.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef DIPLOMACY_HPP_INCLUDED
+#define DIPLOMACY_HPP_INCLUDED
+
+#include <vector>
+
+#include <SFML/Config.hpp>
+
+#include "Treaty.hpp"
+
+namespace Aftermath { class StateHash; }
+
+/**
+ * @file Diplomacy.hpp
+ *
+ * The treaties between the players of a game.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * Diplomacy holds the Treaty of every player with every other player,
+     * indexed by player id, from the first player's point of view. The
+     * treaties are kept as a dense matrix with one compact array per field,
+     * so that operations on every treaty, like decay(), are a single pass
+     * over contiguous memory. For each Mission, a bitset per player records
+     * who that player has the mission with and who has it with them, so
+     * questions like "who is at war with this player" read a few words.
+     *
+     * Diplomacy also keeps the transitive closure of each coalition
+     * mission, that is PACT, ALLIANCE, EMPIRE, and COLONY, so that
+     * coalitions can be asked about in constant time. For coalitions, a
+     * treaty links two players whichever of them holds it, and players are
+     * connected if a chain of such links joins them. Empires are directed:
+     * a player's subjects are the players it holds as EMPIRE, the players
+     * that hold it as COLONY, and their subjects in turn. Closures grow in
+     * place when a treaty is made, and are only rebuilt when breaking one
+     * removes the last link between two players.
+     *
+     * Player::getTreaty() and Player::setTreaty() go through the Diplomacy
+     * of the player's game. Every treaty starts out as the default Treaty.
+     */
+    class Diplomacy {
+        public:
+            /**
+             * Constructs a Diplomacy in which every treaty is the default.
+             */
+            Diplomacy();
+
+            /**
+             * For use by Game. Adds every treaty to the given state hash, and
+             * keeps it up to date from then on.
+             *
+             * @param hash - The hash of the game, or NULL.
+             */
+            void attach(StateHash * hash);
+
+            /**
+             * @param player - The id of the player.
+             * @param other - The id of the other player.
+             *
+             * @return The treaty of player with other, from player's point of
+             * view.
+             */
+            Treaty get(int player, int other) const;
+
+            /**
+             * Changes a treaty. Negative ids are ignored.
+             *
+             * @param player - The id of the player.
+             * @param other - The id of the other player.
+             * @param treaty - The new treaty, from player's point of view.
+             */
+            void set(int player, int other, const Treaty & treaty);
+
+            /**
+             * Returns every treaty of a player, in both directions, to the
+             * default. Game calls this when a player leaves.
+             *
+             * @param player - The id of the player.
+             */
+            void reset(int player);
+
+            /**
+             * Moves every relationship toward the default relationship.
+             *
+             * @param amount - The most that any relationship changes.
+             */
+            void decay(int amount = 1);
+
+            /**
+             * @param player - The id of the player.
+             * @param other - The id of the other player.
+             * @param mission - The mission to check for.
+             *
+             * @return true if player's treaty with other has the given
+             * mission; false otherwise.
+             */
+            bool hasMission(int player, int other,
+                enum Mission mission) const;
+
+            /**
+             * @param player - The id of one player.
+             * @param other - The id of the other player.
+             *
+             * @return true if either player is at WAR with the other; false
+             * otherwise.
+             */
+            bool isAtWar(int player, int other) const;
+
+            /**
+             * Finds the players that a player has a given mission with. For
+             * the default mission, this can include ids that no player in
+             * the game has.
+             *
+             * @param player - The id of the player.
+             * @param mission - The mission to look for.
+             * @param others - Filled with the ids of the other players, in
+             * order.
+             */
+            void find(int player, enum Mission mission,
+                std::vector<int> & others) const;
+
+            /**
+             * Finds the players who are at WAR with a player, or whom the
+             * player is at WAR with.
+             *
+             * @param player - The id of the player.
+             * @param enemies - Filled with the ids of the enemies, in order.
+             */
+            void findEnemies(int player, std::vector<int> & enemies) const;
+
+            /**
+             * @param player - The id of one player.
+             * @param other - The id of the other player.
+             * @param mission - The coalition mission to follow, such as
+             * ALLIANCE.
+             *
+             * @return true if a chain of treaties with the given mission
+             * joins the players; false otherwise. A player is always
+             * connected to itself, and other missions join nobody else.
+             */
+            bool isConnected(int player, int other,
+                enum Mission mission) const;
+
+            /**
+             * Finds every player joined to a player by a chain of treaties
+             * with the given mission, such as the player's whole alliance.
+             *
+             * @param player - The id of the player.
+             * @param mission - The coalition mission to follow.
+             * @param others - Filled with the ids of the other players, in
+             * order. The player itself is left out, and other missions
+             * find nobody.
+             */
+            void findConnected(int player, enum Mission mission,
+                std::vector<int> & others) const;
+
+            /**
+             * @param player - The id of the player.
+             * @param overlord - The id of the possible overlord.
+             *
+             * @return true if the player belongs to the overlord's empire,
+             * directly or through other subjects; false otherwise.
+             */
+            bool isSubject(int player, int overlord) const;
+
+            /**
+             * Finds every player that belongs to an empire.
+             *
+             * @param overlord - The id of the head of the empire.
+             * @param subjects - Filled with the ids of the subjects, in
+             * order.
+             */
+            void findSubjects(int overlord, std::vector<int> & subjects)
+                const;
+
+        private:
+            StateHash * mHash;
+            unsigned mSize;
+            unsigned mWords;
+            std::vector<sf::Uint8> mMissions;
+            std::vector<sf::Uint8> mBoycotts;
+            std::vector<int> mGrants;
+            std::vector<int> mSubsidies;
+            std::vector<int> mRelationships;
+            // One bitset row per mission and player; mFrom holds the
+            // player's own treaties, mTo the treaties toward the player
+            std::vector<sf::Uint32> mFrom;
+            std::vector<sf::Uint32> mTo;
+            // The closures, with one row per mission and player, and the
+            // subjects of each player
+            std::vector<sf::Uint32> mConnected;
+            std::vector<sf::Uint32> mSubjects;
+            std::vector<bool> mStale;
+            bool mStaleEmpires;
+
+            void grow(unsigned size);
+            void store(unsigned player, unsigned other, const Treaty & treaty);
+            void mark(unsigned player, unsigned other, int mission, bool on);
+            Treaty load(unsigned index) const;
+            void collect(const sf::Uint32 * row, std::vector<int> & ids)
+                const;
+            bool test(const std::vector<sf::Uint32> & rows, unsigned row,
+                int bit) const;
+            void unlink(int mission, unsigned player, unsigned other);
+            void link(int mission, unsigned player, unsigned other);
+            void close();
+    };
+
+}
+
+#endif // DIPLOMACY_HPP_INCLUDED
@@ -0,0 +1,238 @@
+//      DistanceField -- Distances from each player's capital and harbor.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#include <SFML/Config.hpp>
+#include <SFML/System/Thread.hpp>
+
+#include "AdjacencyGraph.hpp"
+#include "DistanceField.hpp"
+#include "Game.hpp"
+#include "Mod.hpp"
+#include "Player.hpp"
+#include "Terrain.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
+#include "TileMap.hpp"
+
+using namespace Aftermath;
+
+// Distances are stored in 16 bits, with the top value meaning unreachable
+#define UNREACHABLE 0xFFFF
+#define FARTHEST (UNREACHABLE - 1)
+
+// One player's field, updated on a worker thread
+class DistanceField::Field {
+    public:
+        Field(const Game & game) : mGame(game), mVersion(0), mTerrain(0),
+            mRebuild(false) {}
+
+        // Works out what changed since the last update. This runs on the
+        // main thread, and returns true if there is work for run().
+        bool prepare(const Player & player) {
+            const AdjacencyGraph & adjacency = mGame.getAdjacency();
+            unsigned groups = adjacency.getGroupCount(), group;
+            std::vector<bool> owned(groups, false);
+            for (group = 0; group < groups; ++group)
+                owned[group] = adjacency.getGroup(group)->isLand() &&
+                    adjacency.getGroup(group)->getOwner() == &player;
+            std::vector<unsigned> sources;
+            addSources(player.getCapital(), sources);
+            addSources(player.getHarbor(), sources);
+            std::sort(sources.begin(), sources.end());
+
+            mRebuild = sources != mSources || owned.size() != mOwned.size() ||
+                adjacency.getVersion() != mVersion ||
+                mGame.getMod().getTerrainVersion() != mTerrain;
+            mGained.assign(groups, false);
+            bool gained = false;
+            for (group = 0; group < groups && !mRebuild; ++group) {
+                if (mOwned[group] && !owned[group]) mRebuild = true;
+                if (!mOwned[group] && owned[group]) {
+                    mGained[group] = true;
+                    gained = true;
+                }
+            }
+            mSources = sources;
+            mOwned = owned;
+            mVersion = adjacency.getVersion();
+            mTerrain = mGame.getMod().getTerrainVersion();
+            return mRebuild || gained;
+        }
+
+        // Runs Dijkstra's algorithm from the sources, or from the border of
+        // the newly gained groups
+        void run() {
+            const TileMap & map = mGame.getMap();
+            const AdjacencyGraph & adjacency = mGame.getAdjacency();
+            int columns = map.columns(), rows = map.rows();
+            std::priority_queue<Entry, std::vector<Entry>,
+                std::greater<Entry> > open;
+            unsigned tile;
+            if (mRebuild) {
+                mDistance.assign(rows * columns, UNREACHABLE);
+                std::vector<unsigned>::const_iterator source;
+                for (source = mSources.begin(); source != mSources.end();
+                        ++source) {
+                    if (!isInside(*source)) continue;
+                    mDistance[*source] = 0;
+                    open.push(Entry(0, *source));
+                }
+            } else {
+                for (tile = 0; tile < mDistance.size(); ++tile) {
+                    int group = adjacency.getTileGroup(tile);
+                    if (group < 0 || !mGained[group] ||
+                        mDistance[tile] != UNREACHABLE)
+                        continue;
+                    int direction;
+                    for (direction = 0; direction < 4; ++direction) {
+                        int next = step(tile, direction, rows, columns);
+                        if (next >= 0 && mDistance[next] != UNREACHABLE)
+                            open.push(Entry(mDistance[next], next));
+                    }
+                }
+            }
+            while (!open.empty()) {
+                Entry entry = open.top();
+                open.pop();
+                tile = entry.second;
+                if (entry.first > mDistance[tile]) continue;
+                int direction;
+                for (direction = 0; direction < 4; ++direction) {
+                    int next = step(tile, direction, rows, columns);
+                    if (next < 0 || !isInside(next)) continue;
+                    int distance = std::min(entry.first + map(next / columns,
+                        next % columns).getTerrain()->getMoveCost(),
+                        FARTHEST);
+                    if (distance >= mDistance[next]) continue;
+                    mDistance[next] = distance;
+                    open.push(Entry(distance, next));
+                }
+            }
+        }
+
+        const Game & mGame;
+        std::vector<sf::Uint16> mDistance;
+        std::vector<unsigned> mSources;
+        std::vector<bool> mOwned;
+        std::vector<bool> mGained;
+        unsigned mVersion;
+        unsigned mTerrain;
+        bool mRebuild;
+
+    private:
+        typedef std::pair<int, unsigned> Entry;
+
+        // Adds the tiles that a group's distances are measured from
+        void addSources(const TileGroup * group,
+                std::vector<unsigned> & sources) const {
+            if (group == NULL) return;
+            const TileMap & map = mGame.getMap();
+            std::pair<unsigned, unsigned> at;
+            if (group->getCapital() != NULL) {
+                at = map.locate(group->getCapital());
+                sources.push_back(at.first * map.columns() + at.second);
+                return;
+            }
+            TileGroup::const_iterator tile;
+            for (tile = group->begin(); tile != group->end(); ++tile) {
+                at = map.locate(*tile);
+                sources.push_back(at.first * map.columns() + at.second);
+            }
+        }
+
+        // Whether a tile is part of the player's land
+        bool isInside(unsigned tile) const {
+            const TileMap & map = mGame.getMap();
+            int group = mGame.getAdjacency().getTileGroup(tile);
+            const Terrain * terrain = map(tile / map.columns(),
+                tile % map.columns()).getTerrain();
+            return group >= 0 && mOwned[group] && terrain != NULL &&
+                   terrain->isLandTerrain();
+        }
+
+        // The tile one step in the given direction, or -1 off the map
+        static int step(unsigned tile, int direction, int rows,
+                int columns) {
+            int row = tile / columns + (direction == 0) - (direction == 1);
+            int column = tile % columns + (direction == 2) - (direction == 3);
+            if (row < 0 || row >= rows || column < 0 || column >= columns)
+                return -1;
+            return row * columns + column;
+        }
+};
+
+// Entry point of the worker threads
+void DistanceField::runField(Field * field) {
+    field->run();
+}
+
+DistanceField::DistanceField(const Game & game) : mGame(game),
+    mRebuilds(0) {}
+
+DistanceField::~DistanceField() {
+    std::map<int, Field *>::iterator itr;
+    for (itr = mFields.begin(); itr != mFields.end(); ++itr)
+        delete itr->second;
+}
+
+void DistanceField::update() {
+    // Forget players that have left
+    std::map<int, Field *>::iterator field = mFields.begin();
+    while (field != mFields.end()) {
+        if (mGame.getPlayer(field->first) == NULL) {
+            delete field->second;
+            mFields.erase(field++);
+        } else ++field;
+    }
+
+    // Find the fields that need work, and do it in parallel
+    std::vector<sf::Thread *> threads;
+    Game::const_iterator player;
+    for (player = mGame.begin(); player != mGame.end(); ++player) {
+        Field *& f = mFields[(*player)->getId()];
+        if (f == NULL) f = new Field(mGame);
+        if (!f->prepare(**player)) continue;
+        if (f->mRebuild) ++mRebuilds;
+        threads.push_back(new sf::Thread(&runField, f));
+        threads.back()->Launch();
+    }
+    unsigned i;
+    for (i = 0; i < threads.size(); ++i) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+}
+
+int DistanceField::getDistance(const Player & player, unsigned tile) const {
+    std::map<int, Field *>::const_iterator itr =
+        mFields.find(player.getId());
+    if (itr == mFields.end() || tile >= itr->second->mDistance.size() ||
+        itr->second->mDistance[tile] == UNREACHABLE)
+        return -1;
+    return itr->second->mDistance[tile];
+}
+
+unsigned DistanceField::getRebuildCount() const {
+    return mRebuilds;
+}
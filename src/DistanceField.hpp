@@ -0,0 +1,99 @@
+//      DistanceField -- Distances from each player's capital and harbor.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef DISTANCEFIELD_HPP_INCLUDED
+#define DISTANCEFIELD_HPP_INCLUDED
+
+#include <map>
+
+namespace Aftermath { class Game;
+                      class Player; }
+
+/**
+ * @file DistanceField.hpp
+ *
+ * Distances from each player's capital and harbor.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A DistanceField holds, for every player, how far each tile of their
+     * territory is from the nearest of their capital and their harbor.
+     * Distances are measured over the player's own land tiles, and entering
+     * a tile costs its Terrain::getMoveCost(). The sources are the capital
+     * tile of each group, or all of its tiles if it has none.
+     *
+     * Each player's field is a compact array of 16-bit distances, one per
+     * tile. update() brings every field up to date, working on the fields
+     * of different players in parallel, and only does the work that is
+     * needed. A field whose sources are unchanged and whose territory only
+     * grew is extended from its new border; any other change rebuilds that
+     * one field.
+     */
+    class DistanceField {
+        public:
+            /**
+             * Constructs an empty DistanceField for the given game.
+             *
+             * @param game - The game to measure.
+             */
+            DistanceField(const Game & game);
+
+            /**
+             * Destructs this DistanceField.
+             */
+            ~DistanceField();
+
+            /**
+             * Updates the field of every player in the game.
+             */
+            void update();
+
+            /**
+             * @param player - The player to measure from.
+             * @param tile - The tile to measure to, numbered row * columns +
+             * column.
+             *
+             * @return The distance as of the last update(), or -1 if the
+             * tile can not be reached.
+             */
+            int getDistance(const Player & player, unsigned tile) const;
+
+            /**
+             * @return The number of times that a field has been rebuilt from
+             * scratch.
+             */
+            unsigned getRebuildCount() const;
+
+        private:
+            class Field;
+
+            static void runField(Field * field);
+
+            const Game & mGame;
+            std::map<int, Field *> mFields;
+            unsigned mRebuilds;
+    };
+
+}
+
+#endif // DISTANCEFIELD_HPP_INCLUDED
@@ -17,38 +17,162 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <algorithm>
+#include <cassert>
+
+#include "AdjacencyGraph.hpp"
+#include "BattlePredictor.hpp"
+#include "CombatResolver.hpp"
+#include "Diplomacy.hpp"
+#include "DistanceField.hpp"
 #include "Game.hpp"
+#include "Market.hpp"
 #include "Mod.hpp"
+#include "Move.hpp"
+#include "Pathfinder.hpp"
 #include "Player.hpp"
+#include "PriceSolver.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
 #include "TileMap.hpp"
+#include "Timeline.hpp"
+#include "TransportNetwork.hpp"
+#include "UpgradeQueue.hpp"
 
 using namespace Aftermath;
 
 Game::Game(TileMap * map, const Mod & mod) :
-    mMap(map), mMod(mod) {}
+        mMap(map), mMod(mod), mTurn(0), mNextId(0), mPlayer(0),
+        mDiplomacy(new Diplomacy()),
+        mMarket(new Market(mod)), mPrices(new PriceSolver(mod)),
+        mPathfinder(new Pathfinder(*this)),
+        mAdjacency(new AdjacencyGraph(*map)),
+        mDistances(new DistanceField(*this)),
+        mCombat(new CombatResolver(*this)),
+        mPredictor(new BattlePredictor(*this)),
+        mTimeline(new Timeline(*this)) {
+    unsigned row, column;
+    for (row = 0; row < mMap->rows(); ++row)
+        for (column = 0; column < mMap->columns(); ++column)
+            (*mMap)(row, column).attach(&mState,
+                row * mMap->columns() + column);
+    TileMap::iterator group;
+    for (group = mMap->begin(); group != mMap->end(); ++group) {
+        (*group)->attach(&mState);
+        (*group)->setAdjacency(mAdjacency);
+    }
+    mDiplomacy->attach(&mState);
+    // Built now, since the phase workers read it from several threads
+    mAdjacency->build();
+}
 
 Game::~Game() {
+    delete mTimeline;
+    delete mPredictor;
+    delete mCombat;
+    delete mDistances;
+    delete mAdjacency;
+    delete mPathfinder;
+    delete mPrices;
+    delete mMarket;
     delete mMap;
     iterator itr;
     for (itr = begin(); itr != end(); ++itr) delete *itr;
+    delete mDiplomacy;
+}
+
+void Game::add(Player * const & player) {
+    if (contains(player)) return;
+    if (player->getId() < 0) player->setId(mNextId);
+    mNextId = std::max(mNextId, player->getId() + 1);
+    // A new player has only default treaties, which add nothing
+    player->attach(&mState);
+    mState.changeBorders();
+    Collection<Player *>::add(player);
+    mOrder.push_back(player);
+}
+
+void Game::remove(Player * const & player) {
+    std::vector<Player *>::iterator itr;
+    itr = std::find(mOrder.begin(), mOrder.end(), player);
+    if (itr == mOrder.end()) return;
+    mMarket->cancel(*player);
+    if ((unsigned) (itr - mOrder.begin()) < mPlayer) --mPlayer;
+    mOrder.erase(itr);
+    Collection<Player *>::remove(player);
+    mDiplomacy->reset(player->getId());
+    mState.changeBorders();
+    player->attach(NULL);
+}
+
+Player * Game::getPlayer(int id) {
+    std::vector<Player *>::iterator itr;
+    for (itr = mOrder.begin(); itr != mOrder.end(); ++itr)
+        if ((*itr)->getId() == id) return *itr;
+    return NULL;
+}
+
+const Player * Game::getPlayer(int id) const {
+    return ((Game *) this)->getPlayer(id);
 }
 
 void Game::start(Player * player, int turn) {
     mTurn = turn;
-    mPlayer = find(player);
+    mPlayer = std::find(mOrder.begin(), mOrder.end(), player) -
+              mOrder.begin();
     beginTurn();
-    beginTurn(**mPlayer);
+    beginTurn(*mOrder[mPlayer]);
 }
 
 void Game::nextTurn() {
-    endTurn(**mPlayer);
+    endTurn(*mOrder[mPlayer]);
     ++mPlayer;
-    if (mPlayer == end()) {
+    if (mPlayer >= mOrder.size()) {
         ++mTurn;
         beginTurn();
-        mPlayer = begin();
+        mPlayer = 0;
     }
-    beginTurn(**mPlayer);
+    beginTurn(*mOrder[mPlayer]);
+}
+
+int Game::resolveTurn() {
+    // Everyone's orders, in player order
+    std::vector<std::vector<Move *> > orders(mOrder.size());
+    unsigned i, j;
+    Move * move;
+    for (i = 0; i < mOrder.size(); ++i)
+        while ((move = mOrder[i]->popMove()) != NULL)
+            orders[i].push_back(move);
+
+    // Apply each phase in player order; earlier moves win conflicts
+    int applied = 0, phase;
+    for (phase = ECONOMY_PHASE; phase <= COMBAT_PHASE; ++phase) {
+        for (i = 0; i < orders.size(); ++i) {
+            for (j = 0; j < orders[i].size(); ++j) {
+                move = orders[i][j];
+                if (move->getPhase() == phase && move->isLegal(*this)) {
+                    move->apply(*this);
+                    ++applied;
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < orders.size(); ++i)
+        for (j = 0; j < orders[i].size(); ++j) delete orders[i][j];
+
+    std::vector<Player *>::iterator player;
+    for (player = mOrder.begin(); player != mOrder.end(); ++player)
+        endTurn(**player);
+    ++mTurn;
+    beginTurn();
+    for (player = mOrder.begin(); player != mOrder.end(); ++player)
+        beginTurn(**player);
+    return applied;
+}
+
+const Player & Game::getPlayer() {
+    return *mOrder[mPlayer];
 }
 
 int Game::getTurn() const {
@@ -63,17 +187,147 @@ const Mod & Game::getMod() const {
     return mMod;
 }
 
+Market & Game::getMarket() {
+    return *mMarket;
+}
+
+const Market & Game::getMarket() const {
+    return *mMarket;
+}
+
+const PriceSolver & Game::getPrices() const {
+    return *mPrices;
+}
+
+AdjacencyGraph & Game::getAdjacency() {
+    return *mAdjacency;
+}
+
+const AdjacencyGraph & Game::getAdjacency() const {
+    return *mAdjacency;
+}
+
+DistanceField & Game::getDistances() {
+    return *mDistances;
+}
+
+const DistanceField & Game::getDistances() const {
+    return *mDistances;
+}
+
+Pathfinder & Game::getPathfinder() {
+    return *mPathfinder;
+}
+
+const CombatResolver & Game::getCombat() const {
+    return *mCombat;
+}
+
+BattlePredictor & Game::getPredictor() {
+    return *mPredictor;
+}
+
+Timeline & Game::getTimeline() {
+    return *mTimeline;
+}
+
+const Timeline & Game::getTimeline() const {
+    return *mTimeline;
+}
+
+Diplomacy & Game::getDiplomacy() {
+    return *mDiplomacy;
+}
+
+const Diplomacy & Game::getDiplomacy() const {
+    return *mDiplomacy;
+}
+
+TileMap & Game::getMap() {
+    return *mMap;
+}
+
+const TileMap & Game::getMap() const {
+    return *mMap;
+}
+
+Hash::Value Game::hash() const {
+#ifdef DEBUG
+    assert(mState.getValue() == rehash());
+#endif
+    return mState.getValue();
+}
+
+Hash::Value Game::rehash() const {
+    Hash::Value hash = 0;
+    // Players
+    std::vector<Player *>::const_iterator player;
+    for (player = mOrder.begin(); player != mOrder.end(); ++player) {
+        const Player & p = **player;
+        hash += StateHash::money(p.getId(), p.getMoney());
+        Count<const Resource *>::const_iterator stock;
+        for (stock = p.getStockpile().begin();
+                stock != p.getStockpile().end(); ++stock)
+            hash += StateHash::stockpile(p.getId(), stock->first,
+                stock->second);
+        const TechTree & tree = getMod().getTechTree();
+        unsigned tech;
+        for (tech = 0; tech < tree.size(); ++tech)
+            if (TechTree::test(p.getTechnology(), tech))
+                hash += StateHash::technology(p.getId(), tree.get(tech));
+        std::vector<Player *>::const_iterator other;
+        for (other = mOrder.begin(); other != mOrder.end(); ++other)
+            hash += StateHash::treaty(p.getId(), (*other)->getId(),
+                p.getTreaty(*other));
+    }
+    // Tile groups and their units
+    TileMap::const_iterator group;
+    for (group = mMap->begin(); group != mMap->end(); ++group) {
+        Hash::Value name = Hash::string((*group)->getName());
+        hash += StateHash::owner(name,
+            ((const TileGroup *) *group)->getOwner());
+        const SelectiveCollection<const TileGroupUnit *> & units =
+            ((const TileGroup *) *group)->getUnits();
+        SelectiveCollection<const TileGroupUnit *>::const_iterator unit;
+        for (unit = units.begin(); unit != units.end(); ++unit)
+            hash += StateHash::unit(name, **unit);
+    }
+    // Tiles
+    unsigned row, column;
+    for (row = 0; row < mMap->rows(); ++row) {
+        for (column = 0; column < mMap->columns(); ++column) {
+            const Tile & tile = (*mMap)(row, column);
+            unsigned index = row * mMap->columns() + column;
+            hash += StateHash::terrain(index, tile.getTerrain(),
+                tile.getYield());
+            Tile::const_iterator resource;
+            for (resource = tile.begin(); resource != tile.end(); ++resource)
+                hash += StateHash::resource(index, *resource);
+            hash += StateHash::tileUnit(index, tile.getTileUnit());
+        }
+    }
+    return hash;
+}
+
+unsigned Game::getBorders() const {
+    return mState.getBorders();
+}
+
 // Begins a player's turn
 void Game::beginTurn(Player & player) {
-    // TODO
+    player.getTransport().route(player);
 }
 
 // Ends a player's turn
 void Game::endTurn(Player & player) {
-    // TODO
+    player.getUpgrades().advance();
 }
 
 // Begins a game turn
 void Game::beginTurn() {
-    // TODO
+    mTimeline->advance();
+    mCombat->resolve();
+    mMarket->match(*this);
+    mPrices->update(*this);
+    mDistances->update();
 }
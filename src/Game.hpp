@@ -20,11 +20,24 @@
 #ifndef GAME_HPP_INCLUDED
 #define GAME_HPP_INCLUDED
 
+#include <vector>
+
 #include "Collection.hpp"
+#include "Hash.hpp"
+#include "StateHash.hpp"
 
-namespace Aftermath { class Mod;
+namespace Aftermath { class AdjacencyGraph;
+                      class BattlePredictor;
+                      class CombatResolver;
+                      class Diplomacy;
+                      class DistanceField;
+                      class Market;
+                      class Mod;
+                      class Pathfinder;
                       class Player;
-                      class TileMap; }
+                      class PriceSolver;
+                      class TileMap;
+                      class Timeline; }
 
 /**
  * @file Game.hpp
@@ -40,13 +53,21 @@ namespace Aftermath {
      * A class to represent an ongoing game's state. Use nextTurn() to advance
      * to the next player's turn.
      *
-     * add() and remove() add and remove players from the game.
+     * add() and remove() add and remove players from the game. Players take
+     * their turns in the order that they were added, so every peer of a
+     * networked game must add its players in the same order.
+     *
+     * Games can also be played in simultaneous turns. Instead of waiting
+     * for each other, all players queue their moves at the same time with
+     * Player::pushMove(), and resolveTurn() plays everyone's moves at once.
      */
     class Game : public Collection<Player *> {
         public:
             /**
              * Constructs a zero-player Game with the given map. Add players
-             * to the Game with the addPlayer() function.
+             * to the Game with the addPlayer() function. The Tiles and
+             * TileGroups of the map start being tracked by hash() here, so
+             * the map should be complete.
              *
              * @param map - The TileMap to start the game with.
              * @param mod - The Mod for this game to run.
@@ -58,6 +79,39 @@ namespace Aftermath {
              */
             ~Game();
 
+            /**
+             * Adds a player to this Game. A player without an id is given
+             * the next player id; a player that already has one keeps it.
+             *
+             * @param player - The player to add.
+             */
+            void add(Player * const & player);
+
+            /**
+             * Removes a player from this Game. The ids of the remaining
+             * players do not change.
+             *
+             * @param player - The player to remove.
+             */
+            void remove(Player * const & player);
+
+            /**
+             * Gets the player with the given id.
+             *
+             * @param id - The id of the player, as given by Player::getId().
+             *
+             * @return The player with the given id, or NULL if there is no
+             * such player in this Game.
+             */
+            Player * getPlayer(int id);
+
+            /**
+             * Gets the const player with the given id.
+             *
+             * @see getPlayer(int)
+             */
+            const Player * getPlayer(int id) const;
+
             /**
              * Starts or resumes this game.
              *
@@ -71,6 +125,25 @@ namespace Aftermath {
              */
             void nextTurn();
 
+            /**
+             * Plays one simultaneous turn. Every player's queued moves are
+             * taken from Player::popMove() and played in three phases:
+             * economy, then movement, then combat (see Move::getPhase()).
+             *
+             * Within a phase, moves are checked and applied in player
+             * order, and in the order that each player queued them. A move
+             * that an earlier move in the same phase made illegal, like two
+             * players spending the same resource, is dropped, so conflicts
+             * always go to the player who was added first. Every move is
+             * freed.
+             *
+             * This ends every player's turn and begins the next game turn.
+             * Don't mix it with start() and nextTurn().
+             *
+             * @return The number of moves that were applied.
+             */
+            int resolveTurn();
+
             /**
              * @return The player whose turn it currently is.
              */
@@ -94,11 +167,147 @@ namespace Aftermath {
              */
             const Mod & getMod() const;
 
+            /**
+             * @return The world market of this game. Its orders are matched
+             * at the end of every game turn.
+             */
+            Market & getMarket();
+
+            /**
+             * @see getMarket()
+             */
+            const Market & getMarket() const;
+
+            /**
+             * @return The estimated prices of resources, updated at the start
+             * of every game turn.
+             */
+            const PriceSolver & getPrices() const;
+
+            /**
+             * @return The graph of which TileGroups of the map border each
+             * other. It is built with the game, and TileGroup::add() and
+             * TileGroup::remove() keep it up to date, so reading it never
+             * changes it.
+             */
+            AdjacencyGraph & getAdjacency();
+
+            /**
+             * @see getAdjacency()
+             */
+            const AdjacencyGraph & getAdjacency() const;
+
+            /**
+             * @return Every player's distances from their capital and
+             * harbor. These are updated at the start of every game turn;
+             * call DistanceField::update() to see changes made since.
+             */
+            DistanceField & getDistances();
+
+            /**
+             * @see getDistances()
+             */
+            const DistanceField & getDistances() const;
+
+            /**
+             * @return The Pathfinder that finds routes for units on this
+             * game's map.
+             */
+            Pathfinder & getPathfinder();
+
+            /**
+             * @return The CombatResolver that fights this game's battles at
+             * the start of every game turn.
+             */
+            const CombatResolver & getCombat() const;
+
+            /**
+             * @return The BattlePredictor that estimates the odds of an
+             * attack in this game.
+             */
+            BattlePredictor & getPredictor();
+
+            /**
+             * @return The events waiting to happen in this game. Those that
+             * are due fire at the start of every game turn.
+             */
+            Timeline & getTimeline();
+
+            /**
+             * @see getTimeline()
+             */
+            const Timeline & getTimeline() const;
+
+            /**
+             * @return The treaties between the players of this game.
+             */
+            Diplomacy & getDiplomacy();
+
+            /**
+             * @see getDiplomacy()
+             */
+            const Diplomacy & getDiplomacy() const;
+
+            /**
+             * @return The TileMap that this game is played on.
+             */
+            TileMap & getMap();
+
+            /**
+             * @see getMap()
+             */
+            const TileMap & getMap() const;
+
+            /**
+             * Gets a 64-bit fingerprint of the game state. This covers the
+             * map, the ownership of every TileGroup, the units in them, and
+             * every player's money, stockpile, technology, and treaties.
+             * Two games that agree on all of these have the same hash, no
+             * matter where their objects live in memory, so peers of a
+             * networked game can compare hashes to detect desyncs.
+             *
+             * The fingerprint is kept up to date by the objects themselves
+             * as they change (see StateHash), so this takes constant time.
+             * Debug builds check it against rehash() on every call.
+             *
+             * @return The fingerprint of the current state.
+             */
+            Hash::Value hash() const;
+
+            /**
+             * Computes the fingerprint of the game state from scratch. This
+             * visits every player, group, and tile, and should always agree
+             * with hash().
+             *
+             * @return The fingerprint of the current state.
+             */
+            Hash::Value rehash() const;
+
+            /**
+             * @return The number of times that borders have changed, that is,
+             * the owner of a province or a treaty between two players in
+             * this game. Caches that depend on borders can compare this to
+             * the count they were built at.
+             */
+            unsigned getBorders() const;
+
         private:
             TileMap * mMap;
             const Mod & mMod;
             int mTurn;
-            iterator mPlayer;
+            int mNextId;
+            std::vector<Player *> mOrder;
+            unsigned mPlayer;
+            StateHash mState;
+            Diplomacy * mDiplomacy;
+            Market * mMarket;
+            PriceSolver * mPrices;
+            Pathfinder * mPathfinder;
+            AdjacencyGraph * mAdjacency;
+            DistanceField * mDistances;
+            CombatResolver * mCombat;
+            BattlePredictor * mPredictor;
+            Timeline * mTimeline;
 
             void beginTurn(Player & player);
             void endTurn(Player & player);
@@ -0,0 +1,87 @@
+//      Hash.hpp -- Functions for fingerprinting game state.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef HASH_HPP_INCLUDED
+#define HASH_HPP_INCLUDED
+
+#include <string>
+
+#include <SFML/Config.hpp>
+
+/**
+ * @file Hash.hpp
+ *
+ * Functions for fingerprinting game state.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath { namespace Hash {
+
+    /** A 64-bit hash value. */
+    typedef sf::Uint64 Value;
+
+    /**
+     * Builds a 64-bit value out of two 32-bit halves. This keeps 64-bit
+     * literals out of the code, since C++98 does not have them.
+     */
+    inline Value make(sf::Uint32 high, sf::Uint32 low) {
+        return (static_cast<Value>(high) << 32) | low;
+    }
+
+    /** @return The bits of value, thoroughly mixed (splitmix64 finalizer). */
+    inline Value mix(Value value) {
+        value ^= value >> 30;
+        value *= make(0xbf58476dUL, 0x1ce4e5b9UL);
+        value ^= value >> 27;
+        value *= make(0x94d049bbUL, 0x133111ebUL);
+        value ^= value >> 31;
+        return value;
+    }
+
+    /** @return A hash of seed combined with value. Order matters. */
+    inline Value combine(Value seed, Value value) {
+        return mix(seed + make(0x9e3779b9UL, 0x7f4a7c15UL) + value);
+    }
+
+    /** @return The FNV-1a hash of the given string. */
+    inline Value string(const std::string & str) {
+        Value hash = make(0xcbf29ce4UL, 0x84222325UL);
+        std::string::const_iterator itr;
+        for (itr = str.begin(); itr != str.end(); ++itr) {
+            hash ^= static_cast<unsigned char>(*itr);
+            hash *= make(0x00000100UL, 0x000001b3UL);
+        }
+        return hash;
+    }
+
+    /**
+     * Builds the key of a single fact about the game state. A fact is a kind
+     * (like "a player's money") and up to four values (like the player's id
+     * and the amount). Summing the keys of every fact gives an order
+     * independent fingerprint of the whole state.
+     */
+    inline Value key(int kind, Value a, Value b = 0, Value c = 0,
+            Value d = 0) {
+        return combine(combine(combine(combine(mix(kind + 1), a), b), c), d);
+    }
+
+} }
+
+#endif // HASH_HPP_INCLUDED
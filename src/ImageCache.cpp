@@ -0,0 +1,181 @@
+//      ImageCache.cpp -- Keeps loaded images within a memory budget.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "ImageCache.hpp"
+
+using namespace Aftermath;
+
+#define BYTES_PER_PIXEL 4
+
+ImageCache::ImageCache(AssetLoader & loader, std::size_t budget) :
+    mLoader(loader), mBudget(budget), mBytes(0), mReserved(0), mHits(0),
+    mMisses(0), mEvictions(0) {}
+
+sf::Image * ImageCache::acquire(const std::string & path) {
+    std::map<std::string, Entry>::iterator found = mEntries.find(path);
+    Entry * entry;
+    if (found != mEntries.end()) {
+        ++mHits;
+        entry = &found->second;
+    } else {
+        ++mMisses;
+        entry = &add(path);
+    }
+    publish(path, *entry);
+    ++entry->references;
+    mRecent.splice(mRecent.begin(), mRecent, entry->recent);
+    evict();
+    return entry->image;
+}
+
+void ImageCache::preload(const std::string & path) {
+    if (contains(path)) return;
+    add(path);
+    mPending.push_back(path);
+}
+
+void ImageCache::update() {
+    unsigned i, kept = 0;
+    for (i = 0; i < mPending.size(); ++i) {
+        std::map<std::string, Entry>::iterator found;
+        found = mEntries.find(mPending[i]);
+        // Acquired images have been counted already
+        if (found == mEntries.end() || found->second.image != NULL)
+            continue;
+        if (mLoader.get(found->second.handle) != NULL)
+            publish(found->first, found->second);
+        else mPending[kept++] = mPending[i];
+    }
+    mPending.resize(kept);
+    evict();
+}
+
+bool ImageCache::release(const sf::Image * image) {
+    std::map<const sf::Image *, std::string>::const_iterator found;
+    found = mPaths.find(image);
+    if (found == mPaths.end()) return false;
+    Entry & entry = mEntries[found->second];
+    if (entry.references > 0 && --entry.references == 0) evict();
+    return true;
+}
+
+bool ImageCache::reload(const std::string & path) {
+    std::map<std::string, Entry>::iterator found = mEntries.find(path);
+    if (found == mEntries.end()) return false;
+    Entry & entry = found->second;
+    publish(path, entry);
+    if (!entry.image->LoadFromFile(path)) return false;
+    mBytes -= entry.bytes;
+    entry.bytes = BYTES_PER_PIXEL * entry.image->GetWidth() *
+        entry.image->GetHeight();
+    mBytes += entry.bytes;
+    evict();
+    return true;
+}
+
+bool ImageCache::contains(const std::string & path) const {
+    return mEntries.find(path) != mEntries.end();
+}
+
+bool ImageCache::isFailed(const std::string & path) const {
+    std::map<std::string, Entry>::const_iterator found;
+    found = mEntries.find(path);
+    return found != mEntries.end() && mLoader.isFailed(found->second.handle);
+}
+
+void ImageCache::setBudget(std::size_t budget) {
+    mBudget = budget;
+    evict();
+}
+
+std::size_t ImageCache::getBudget() const {
+    return mBudget;
+}
+
+void ImageCache::setReserved(std::size_t bytes) {
+    mReserved = bytes;
+    evict();
+}
+
+std::size_t ImageCache::getReserved() const {
+    return mReserved;
+}
+
+std::size_t ImageCache::getBytes() const {
+    return mBytes;
+}
+
+unsigned ImageCache::size() const {
+    return mEntries.size();
+}
+
+unsigned long ImageCache::getHits() const {
+    return mHits;
+}
+
+unsigned long ImageCache::getMisses() const {
+    return mMisses;
+}
+
+unsigned long ImageCache::getEvictions() const {
+    return mEvictions;
+}
+
+// Requests an image from the loader and adds it, not yet decoded, as the
+// least recently acquired image
+ImageCache::Entry & ImageCache::add(const std::string & path) {
+    Entry entry;
+    entry.handle = mLoader.request(path);
+    entry.image = NULL;
+    entry.bytes = 0;
+    entry.references = 0;
+    entry.recent = mRecent.insert(mRecent.end(), path);
+    return mEntries.insert(std::make_pair(path, entry)).first->second;
+}
+
+// Counts an image once it has been decoded, waiting for it if need be
+void ImageCache::publish(const std::string & path, Entry & entry) {
+    if (entry.image != NULL) return;
+    entry.image = mLoader.wait(entry.handle);
+    entry.bytes = BYTES_PER_PIXEL * entry.image->GetWidth() *
+        entry.image->GetHeight();
+    mPaths[entry.image] = path;
+    mBytes += entry.bytes;
+}
+
+// Frees the least recently acquired unreferenced images until the cache
+// fits in what is left of its budget. Images still being decoded are kept.
+void ImageCache::evict() {
+    if (mBudget == 0) return;
+    std::list<std::string>::iterator itr = mRecent.end();
+    while (mBytes + mReserved > mBudget && itr != mRecent.begin()) {
+        --itr;
+        std::map<std::string, Entry>::iterator found = mEntries.find(*itr);
+        Entry & entry = found->second;
+        if (entry.references > 0 || entry.image == NULL) continue;
+        mBytes -= entry.bytes;
+        mPaths.erase(entry.image);
+        mLoader.release(entry.handle);
+        mEntries.erase(found);
+        itr = mRecent.erase(itr);
+        ++mEvictions;
+    }
+}
@@ -0,0 +1,211 @@
+//      ImageCache.hpp -- Keeps loaded images within a memory budget.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef IMAGECACHE_HPP_INCLUDED
+#define IMAGECACHE_HPP_INCLUDED
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "AssetLoader.hpp"
+
+namespace sf { class Image; }
+
+/**
+ * @file ImageCache.hpp
+ *
+ * Keeps loaded images within a memory budget.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * An ImageCache hands out images from an AssetLoader and counts the
+     * references to each of them. When the images take more memory than the
+     * budget allows, the least recently acquired ones that nobody refers to
+     * are freed, until the cache fits again or only referenced images are
+     * left. An image is counted as four bytes per pixel.
+     *
+     * Images can be preloaded before anything asks for them; they count
+     * towards the budget once they have been decoded, and are the first to
+     * be freed. Part of the budget can be reserved for images kept outside
+     * of the cache, like the pages of an atlas.
+     */
+    class ImageCache {
+        public:
+            /**
+             * Constructs a new, empty cache.
+             *
+             * @param loader - The loader to get images from.
+             * @param budget - The number of bytes that images may take up,
+             * or 0 for no limit.
+             */
+            ImageCache(AssetLoader & loader, std::size_t budget = 0);
+
+            /**
+             * Gets an image and adds a reference to it. If the image is not
+             * in the cache, this waits for the loader to decode it.
+             *
+             * @param path - The path of the image file.
+             *
+             * @return The image, which stays loaded until release() is
+             * called for it.
+             */
+            sf::Image * acquire(const std::string & path);
+
+            /**
+             * Starts loading an image without taking a reference to it.
+             * Nothing happens if the image is already in the cache.
+             *
+             * @param path - The path of the image file.
+             */
+            void preload(const std::string & path);
+
+            /**
+             * Counts the preloaded images that have been decoded since the
+             * last call, freeing images if the cache no longer fits.
+             */
+            void update();
+
+            /**
+             * Drops a reference to an image. The image may be freed once
+             * nothing refers to it.
+             *
+             * @param image - An image returned by acquire().
+             *
+             * @return true if the image belongs to this cache; false
+             * otherwise.
+             */
+            bool release(const sf::Image * image);
+
+            /**
+             * Decodes a cached image again, as when its file has changed.
+             * The image is changed in place, so the sprites that show it
+             * show the new version.
+             *
+             * @param path - The path of the image file.
+             *
+             * @return true if the image was reloaded; false if it is not in
+             * the cache or could not be loaded.
+             */
+            bool reload(const std::string & path);
+
+            /**
+             * @param path - The path of an image file.
+             *
+             * @return true if the image is in the cache; false otherwise.
+             */
+            bool contains(const std::string & path) const;
+
+            /**
+             * @param path - The path of an image in the cache.
+             *
+             * @return true if the image could not be loaded; false
+             * otherwise.
+             */
+            bool isFailed(const std::string & path) const;
+
+            /**
+             * Changes the budget, freeing images if the cache no longer
+             * fits.
+             *
+             * @param budget - The number of bytes that images may take up,
+             * or 0 for no limit.
+             */
+            void setBudget(std::size_t budget);
+
+            /**
+             * @return The number of bytes that images may take up, or 0 if
+             * there is no limit.
+             */
+            std::size_t getBudget() const;
+
+            /**
+             * Sets aside part of the budget for images kept outside of the
+             * cache, freeing images if the cache no longer fits in the rest.
+             *
+             * @param bytes - The number of bytes taken by those images.
+             */
+            void setReserved(std::size_t bytes);
+
+            /**
+             * @return The number of bytes set aside for images kept outside
+             * of the cache.
+             */
+            std::size_t getReserved() const;
+
+            /**
+             * @return The number of bytes that the cached images take up.
+             */
+            std::size_t getBytes() const;
+
+            /**
+             * @return The number of images in the cache.
+             */
+            unsigned size() const;
+
+            /**
+             * @return The number of times acquire() found its image in the
+             * cache.
+             */
+            unsigned long getHits() const;
+
+            /**
+             * @return The number of times acquire() had to load its image.
+             */
+            unsigned long getMisses() const;
+
+            /**
+             * @return The number of images freed to stay within the budget.
+             */
+            unsigned long getEvictions() const;
+
+        private:
+            // One cached image, whose image is NULL until it is decoded
+            struct Entry {
+                sf::Image * image;
+                AssetLoader::Handle handle;
+                std::size_t bytes;
+                unsigned references;
+                std::list<std::string>::iterator recent;
+            };
+
+            AssetLoader & mLoader;
+            std::size_t mBudget, mBytes, mReserved;
+            std::map<std::string, Entry> mEntries;
+            std::map<const sf::Image *, std::string> mPaths;
+            // Most recently acquired first
+            std::list<std::string> mRecent;
+            // Preloaded images that may still be decoding
+            std::vector<std::string> mPending;
+            unsigned long mHits, mMisses, mEvictions;
+
+            Entry & add(const std::string & path);
+            void publish(const std::string & path, Entry & entry);
+            void evict();
+    };
+
+}
+
+#endif // IMAGECACHE_HPP_INCLUDED
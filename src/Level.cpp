@@ -21,7 +21,8 @@
 
 using namespace Aftermath;
 
-Level::Level(const Count<const Transferable *> * cost) : mCost(cost) {}
+Level::Level(const Count<const Transferable *> * cost, int duration) :
+    mCost(cost), mDuration(duration < 1 ? 1 : duration) {}
 
 Level::~Level() {
     delete mCost;
@@ -30,3 +31,7 @@ Level::~Level() {
 const Count<const Transferable *> & Level::getCost() const {
     return *mCost;
 }
+
+int Level::getDuration() const {
+    return mDuration;
+}
@@ -46,8 +46,10 @@ namespace Aftermath {
              * research cost.
              *
              * @param cost - The monetary, resource, and technology cost.
+             * @param duration - The number of turns that upgrading to this
+             * level takes. This is at least 1.
              */
-            Level(const Count<const Transferable *> * cost);
+            Level(const Count<const Transferable *> * cost, int duration = 1);
 
             /**
              * Virtual destructor for Level; this frees this level's cost.
@@ -61,8 +63,14 @@ namespace Aftermath {
              */
             const Count<const Transferable *> & getCost() const;
 
+            /**
+             * @return The number of turns that upgrading to this level takes.
+             */
+            int getDuration() const;
+
         private:
             const Count<const Transferable *> * mCost;
+            int mDuration;
     };
 
 }
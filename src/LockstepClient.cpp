@@ -0,0 +1,104 @@
+//      LockstepClient.cpp -- One peer of a lockstep game.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Game.hpp"
+#include "LockstepClient.hpp"
+
+using namespace Aftermath;
+
+LockstepClient::LockstepClient(Game & game) : mGame(game), mId(-1),
+    mPlayers(0), mTurn(0), mDesynced(false) {}
+
+LockstepClient::~LockstepClient() {
+    mSocket.Disconnect();
+}
+
+bool LockstepClient::connect(const sf::IpAddress & address,
+        unsigned short port) {
+    if (mSocket.Connect(address, port) != sf::Socket::Done) return false;
+    sf::Packet packet;
+    sf::Uint8 message;
+    sf::Int32 id;
+    sf::Uint32 players;
+    if (mSocket.Receive(packet) != sf::Socket::Done ||
+        !(packet >> message >> id >> players) ||
+        message != LOCKSTEP_WELCOME) {
+        mSocket.Disconnect();
+        return false;
+    }
+    mId = id;
+    mPlayers = players;
+    mOrders = TurnOrders(mId, mTurn);
+    return true;
+}
+
+int LockstepClient::getId() const {
+    return mId;
+}
+
+unsigned LockstepClient::getPlayerCount() const {
+    return mPlayers;
+}
+
+void LockstepClient::submit(const Move & move) {
+    mOrders.add(move);
+}
+
+bool LockstepClient::endTurn() {
+    if (mId < 0 || mDesynced) return false;
+    // Send our orders, along with our view of the state
+    mOrders.setHash(mGame.hash());
+    sf::Packet packet;
+    packet << (sf::Uint8) LOCKSTEP_ORDERS << mOrders;
+    if (mSocket.Send(packet) != sf::Socket::Done) return false;
+    // Wait for everyone's orders
+    packet.Clear();
+    sf::Uint8 message;
+    sf::Int32 turn;
+    if (mSocket.Receive(packet) != sf::Socket::Done ||
+        !(packet >> message >> turn) || turn != mTurn)
+        return false;
+    if (message == LOCKSTEP_DESYNC) {
+        mDesynced = true;
+        return false;
+    }
+    sf::Uint32 count;
+    if (message != LOCKSTEP_TURN || !(packet >> count)) return false;
+    std::vector<TurnOrders> orders(count);
+    for (unsigned i = 0; i < count; ++i)
+        if (!(packet >> orders[i])) return false;
+    // Play the turn; the server sends the orders in player order
+    std::vector<TurnOrders>::const_iterator itr;
+    for (itr = orders.begin(); itr != orders.end(); ++itr) {
+        itr->apply(mGame);
+        mGame.nextTurn();
+    }
+    mOrders = TurnOrders(mId, ++mTurn);
+    return true;
+}
+
+bool LockstepClient::isDesynced() const {
+    return mDesynced;
+}
+
+int LockstepClient::getTurn() const {
+    return mTurn;
+}
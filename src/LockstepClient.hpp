@@ -0,0 +1,127 @@
+//      LockstepClient.hpp -- One peer of a lockstep game.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef LOCKSTEPCLIENT_HPP_INCLUDED
+#define LOCKSTEPCLIENT_HPP_INCLUDED
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+#include "TurnOrders.hpp"
+
+namespace Aftermath { class Game;
+                      class Move; }
+
+/**
+ * @file LockstepClient.hpp
+ *
+ * One peer of a lockstep game.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A LockstepClient keeps a local Game in step with the other clients of
+     * a LockstepServer. The local player's moves are collected with submit()
+     * during the turn. endTurn() sends them to the server, waits for the
+     * moves of every player, and applies them in player id order, calling
+     * Game::nextTurn() after each player's moves.
+     *
+     * The Game must hold one Player per client, added in the same order on
+     * every peer, and must have been started with its first player.
+     */
+    class LockstepClient {
+        public:
+            /**
+             * Constructs a new client for the given game.
+             *
+             * @param game - The local copy of the game.
+             */
+            LockstepClient(Game & game);
+
+            /**
+             * Disconnects from the server.
+             */
+            ~LockstepClient();
+
+            /**
+             * Connects to a LockstepServer and waits to be given a player id.
+             *
+             * @param address - The address of the server.
+             * @param port - The port that the server listens on.
+             *
+             * @return true if the connection was made; false otherwise.
+             */
+            bool connect(const sf::IpAddress & address, unsigned short port);
+
+            /**
+             * @return The id of the player that this client controls, or -1
+             * if the client is not connected.
+             */
+            int getId() const;
+
+            /**
+             * @return The number of players in the game, as sent by the
+             * server.
+             */
+            unsigned getPlayerCount() const;
+
+            /**
+             * Adds a move by the local player to this turn's orders. The
+             * move is not applied until endTurn() is called.
+             *
+             * @param move - The move to make.
+             */
+            void submit(const Move & move);
+
+            /**
+             * Sends this turn's orders and applies the orders of every
+             * player once they arrive. This blocks until the server answers.
+             *
+             * @return true if the turn was played; false if the game desynced
+             * or the connection was lost.
+             */
+            bool endTurn();
+
+            /**
+             * @return true if the server reported that the clients disagree
+             * on the state of the game; false otherwise.
+             */
+            bool isDesynced() const;
+
+            /**
+             * @return The number of turns that have been played.
+             */
+            int getTurn() const;
+
+        private:
+            Game & mGame;
+            sf::TcpSocket mSocket;
+            int mId;
+            unsigned mPlayers;
+            int mTurn;
+            bool mDesynced;
+            TurnOrders mOrders;
+    };
+
+}
+
+#endif // LOCKSTEPCLIENT_HPP_INCLUDED
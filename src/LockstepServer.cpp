@@ -0,0 +1,112 @@
+//      LockstepServer.cpp -- Relays moves between lockstep clients.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "LockstepServer.hpp"
+#include "TurnOrders.hpp"
+
+using namespace Aftermath;
+
+LockstepServer::LockstepServer(unsigned players) : mPlayers(players),
+    mTurn(0), mDesynced(false), mBytes(0) {}
+
+LockstepServer::~LockstepServer() {
+    close();
+}
+
+bool LockstepServer::listen(unsigned short port) {
+    return mListener.Listen(port) == sf::Socket::Done;
+}
+
+bool LockstepServer::acceptPlayers() {
+    while (mClients.size() < mPlayers) {
+        sf::TcpSocket * client = new sf::TcpSocket();
+        if (mListener.Accept(*client) != sf::Socket::Done) {
+            delete client;
+            return false;
+        }
+        mClients.push_back(client);
+    }
+    for (unsigned i = 0; i < mClients.size(); ++i) {
+        sf::Packet packet;
+        packet << (sf::Uint8) LOCKSTEP_WELCOME << (sf::Int32) i
+               << (sf::Uint32) mPlayers;
+        if (mClients[i]->Send(packet) != sf::Socket::Done) return false;
+    }
+    return true;
+}
+
+bool LockstepServer::relayTurn() {
+    if (mDesynced) return false;
+    std::vector<TurnOrders> orders(mClients.size());
+    // Gather the orders of every client
+    for (unsigned i = 0; i < mClients.size(); ++i) {
+        sf::Packet packet;
+        sf::Uint8 message;
+        if (mClients[i]->Receive(packet) != sf::Socket::Done ||
+            !(packet >> message) || message != LOCKSTEP_ORDERS ||
+            !(packet >> orders[i]) || orders[i].getTurn() != mTurn ||
+            orders[i].getPlayer() != (int) i)
+            return false;
+        mBytes += packet.GetDataSize();
+    }
+    // Every client must agree on the state before this turn
+    for (unsigned i = 1; i < orders.size(); ++i) {
+        if (orders[i].getHash() != orders[0].getHash()) {
+            mDesynced = true;
+            sf::Packet packet;
+            packet << (sf::Uint8) LOCKSTEP_DESYNC << (sf::Int32) mTurn;
+            for (unsigned j = 0; j < mClients.size(); ++j)
+                mClients[j]->Send(packet);
+            return false;
+        }
+    }
+    // Relay everyone's orders in player order
+    sf::Packet packet;
+    packet << (sf::Uint8) LOCKSTEP_TURN << (sf::Int32) mTurn
+           << (sf::Uint32) orders.size();
+    for (unsigned i = 0; i < orders.size(); ++i) packet << orders[i];
+    for (unsigned i = 0; i < mClients.size(); ++i)
+        if (mClients[i]->Send(packet) != sf::Socket::Done) return false;
+    ++mTurn;
+    return true;
+}
+
+void LockstepServer::close() {
+    std::vector<sf::TcpSocket *>::iterator itr;
+    for (itr = mClients.begin(); itr != mClients.end(); ++itr) {
+        (*itr)->Disconnect();
+        delete *itr;
+    }
+    mClients.clear();
+    mListener.Close();
+}
+
+int LockstepServer::getTurn() const {
+    return mTurn;
+}
+
+bool LockstepServer::isDesynced() const {
+    return mDesynced;
+}
+
+unsigned long LockstepServer::getBytesRelayed() const {
+    return mBytes;
+}
@@ -0,0 +1,121 @@
+//      LockstepServer.hpp -- Relays moves between lockstep clients.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef LOCKSTEPSERVER_HPP_INCLUDED
+#define LOCKSTEPSERVER_HPP_INCLUDED
+
+#include <vector>
+
+#include <SFML/Network/TcpListener.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+/**
+ * @file LockstepServer.hpp
+ *
+ * Relays moves between lockstep clients.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A LockstepServer runs the network side of a lockstep game. It does not
+     * hold a Game of its own. Every turn, it waits for the TurnOrders of each
+     * client, checks that all of the clients agree on the state hash, and
+     * sends every client the orders of every player in player id order. Each
+     * client then applies the same moves in the same order.
+     *
+     * A client's id is the order in which it connected, starting at 0.
+     */
+    class LockstepServer {
+        public:
+            /**
+             * Constructs a new server for the given number of players.
+             *
+             * @param players - The number of clients to wait for.
+             */
+            LockstepServer(unsigned players);
+
+            /**
+             * Disconnects all clients and stops listening.
+             */
+            ~LockstepServer();
+
+            /**
+             * Starts listening for clients on the given port.
+             *
+             * @param port - The TCP port to listen on.
+             *
+             * @return true if the server is listening; false otherwise.
+             */
+            bool listen(unsigned short port);
+
+            /**
+             * Waits until all players have connected and sends each of them
+             * its player id.
+             *
+             * @return true if all players connected; false otherwise.
+             */
+            bool acceptPlayers();
+
+            /**
+             * Waits for one turn of orders from every client and relays
+             * them. If the clients' state hashes differ, every client is told
+             * of the desync instead.
+             *
+             * @return true if the turn was relayed; false if the game
+             * desynced or a client disconnected.
+             */
+            bool relayTurn();
+
+            /**
+             * Disconnects all clients and stops listening.
+             */
+            void close();
+
+            /**
+             * @return The number of turns that have been relayed.
+             */
+            int getTurn() const;
+
+            /**
+             * @return true if the clients were found to disagree on the state
+             * of the game; false otherwise.
+             */
+            bool isDesynced() const;
+
+            /**
+             * @return The number of bytes of orders relayed so far. This grows
+             * with the number of moves made, not with the size of the game.
+             */
+            unsigned long getBytesRelayed() const;
+
+        private:
+            unsigned mPlayers;
+            int mTurn;
+            bool mDesynced;
+            unsigned long mBytes;
+            sf::TcpListener mListener;
+            std::vector<sf::TcpSocket *> mClients;
+    };
+
+}
+
+#endif // LOCKSTEPSERVER_HPP_INCLUDED
@@ -0,0 +1,131 @@
+//      MapClient.cpp -- A replica of a MapServer's map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <new>
+#include <string>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Game.hpp"
+#include "MapClient.hpp"
+#include "MapIndex.hpp"
+#include "MapServer.hpp"
+#include "MapView.hpp"
+#include "Player.hpp"
+#include "Province.hpp"
+#include "Sea.hpp"
+#include "Tile.hpp"
+#include "TileMap.hpp"
+
+using namespace Aftermath;
+
+MapClient::MapClient(const Mod & mod) : mMod(mod), mGame(NULL),
+    mIndex(NULL), mView(NULL), mTurn(0), mBytes(0) {}
+
+MapClient::~MapClient() {
+    mSocket.Disconnect();
+    delete mView;
+    delete mGame;
+    delete mIndex;
+}
+
+bool MapClient::connect(const sf::IpAddress & address, unsigned short port,
+        int player) {
+    if (mGame != NULL) return false;
+    if (mSocket.Connect(address, port) != sf::Socket::Done) return false;
+    sf::Packet packet;
+    packet << (sf::Uint8) MAP_JOIN << (sf::Int32) player;
+    if (mSocket.Send(packet) != sf::Socket::Done) return false;
+
+    packet.Clear();
+    sf::Uint8 message;
+    sf::Int32 turn;
+    std::string name;
+    sf::Uint32 rows, columns, groups, players;
+    if (mSocket.Receive(packet) != sf::Socket::Done ||
+        !(packet >> message >> turn >> name >> rows >> columns >> groups) ||
+        message != MAP_SNAPSHOT)
+        return false;
+    mBytes += packet.GetDataSize();
+    mTurn = turn;
+
+    // Client tiles start out unknown and never generate resources
+    TileMap * map = new TileMap(name, rows, columns);
+    unsigned row, column;
+    for (row = 0; row < rows; ++row)
+        for (column = 0; column < columns; ++column)
+            new (&(*map)(row, column)) Tile(NULL, false);
+    mIndex = new MapIndex(mMod);
+    mGame = new Game(map, mMod);
+    unsigned i;
+    for (i = 0; i < groups; ++i) {
+        sf::Uint8 land = 0;
+        packet >> name >> land;
+        TileGroup * group;
+        if (land) group = new Province(name);
+        else group = new Sea(name);
+        map->add(group);
+        mIndex->add(group);
+    }
+    packet >> players;
+    for (i = 0; packet && i < players; ++i) {
+        sf::Int32 id;
+        packet >> id >> name;
+        Player * p = new Player(name, *mGame);
+        // Keep the server's ids
+        p->setId(id);
+        mGame->add(p);
+    }
+    if (!packet) return false;
+
+    mView = new MapView(*mIndex, rows * columns);
+    std::vector<unsigned> tiles, changed;
+    if (!mView->read(packet, tiles, changed)) return false;
+    mView->patch(*mGame, tiles, changed);
+    return true;
+}
+
+bool MapClient::receive() {
+    if (mView == NULL) return false;
+    sf::Packet packet;
+    sf::Uint8 message;
+    sf::Int32 turn;
+    if (mSocket.Receive(packet) != sf::Socket::Done ||
+        !(packet >> message >> turn) || message != MAP_DELTA)
+        return false;
+    mBytes += packet.GetDataSize();
+    std::vector<unsigned> tiles, groups;
+    if (!mView->read(packet, tiles, groups)) return false;
+    mView->patch(*mGame, tiles, groups);
+    mTurn = turn;
+    return true;
+}
+
+Game & MapClient::getGame() {
+    return *mGame;
+}
+
+int MapClient::getTurn() const {
+    return mTurn;
+}
+
+unsigned long MapClient::getBytesReceived() const {
+    return mBytes;
+}
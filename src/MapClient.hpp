@@ -0,0 +1,117 @@
+//      MapClient.hpp -- A replica of a MapServer's map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MAPCLIENT_HPP_INCLUDED
+#define MAPCLIENT_HPP_INCLUDED
+
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+
+namespace Aftermath { class Game;
+                      class MapIndex;
+                      class MapView;
+                      class Mod; }
+
+/**
+ * @file MapClient.hpp
+ *
+ * A replica of a MapServer's map.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A MapClient builds a client-side Game out of what a MapServer sends.
+     * When it connects, it creates a TileMap with the server's layout,
+     * whose Tiles do not generate their own resources, and the server's
+     * players. Each call to receive() then applies the next delta from the
+     * server to that game.
+     *
+     * The client's Game is only a picture of the server's game. Tiles that
+     * the player has never seen have no Terrain.
+     */
+    class MapClient {
+        public:
+            /**
+             * Constructs a new client.
+             *
+             * @param mod - The Mod that the server is running.
+             */
+            MapClient(const Mod & mod);
+
+            /**
+             * Disconnects from the server and frees the client's Game.
+             */
+            ~MapClient();
+
+            /**
+             * Connects to a MapServer as the given player and builds the
+             * client's Game from the server's snapshot.
+             *
+             * @param address - The address of the server.
+             * @param port - The port that the server listens on.
+             * @param player - The id of the player to play as.
+             *
+             * @return true if the snapshot was received; false otherwise.
+             */
+            bool connect(const sf::IpAddress & address, unsigned short port,
+                int player);
+
+            /**
+             * Waits for the next delta from the server and applies it to the
+             * client's Game.
+             *
+             * @return true if a delta was applied; false if the connection
+             * was lost or the delta was malformed.
+             */
+            bool receive();
+
+            /**
+             * Gets the client's copy of the game. This is only valid after
+             * connect() returns true.
+             *
+             * @return The client's Game.
+             */
+            Game & getGame();
+
+            /**
+             * @return The server's turn as of the last snapshot or delta.
+             */
+            int getTurn() const;
+
+            /**
+             * @return The number of bytes received from the server so far.
+             */
+            unsigned long getBytesReceived() const;
+
+        private:
+            const Mod & mMod;
+            sf::TcpSocket mSocket;
+            Game * mGame;
+            MapIndex * mIndex;
+            MapView * mView;
+            int mTurn;
+            unsigned long mBytes;
+    };
+
+}
+
+#endif // MAPCLIENT_HPP_INCLUDED
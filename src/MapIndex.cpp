@@ -0,0 +1,78 @@
+//      MapIndex.cpp -- Numbers the shared types of a replicated map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include "MapIndex.hpp"
+#include "Mod.hpp"
+
+using namespace Aftermath;
+
+MapIndex::MapIndex(const Mod & mod) {
+    mTerrain.addAll(mod.getTerrain());
+    mResources.addAll(mod.getResources());
+    mSpecialistTypes.addAll(mod.getSpecialistTypes());
+    mUnitTypes.addAll(mod.getUnitTypes());
+}
+
+void MapIndex::add(TileGroup * group) {
+    mGroups.add(group);
+}
+
+unsigned MapIndex::getGroupCount() const {
+    return mGroups.size();
+}
+
+int MapIndex::getTerrain(const Terrain * terrain) const {
+    return mTerrain.find(terrain);
+}
+
+const Terrain * MapIndex::getTerrain(int index) const {
+    return mTerrain.get(index);
+}
+
+int MapIndex::getResource(const Resource * resource) const {
+    return mResources.find(resource);
+}
+
+const Resource * MapIndex::getResource(int index) const {
+    return mResources.get(index);
+}
+
+int MapIndex::getSpecialistType(const SpecialistType * type) const {
+    return mSpecialistTypes.find(type);
+}
+
+const SpecialistType * MapIndex::getSpecialistType(int index) const {
+    return mSpecialistTypes.get(index);
+}
+
+int MapIndex::getUnitType(const UnitType * type) const {
+    return mUnitTypes.find(type);
+}
+
+const UnitType * MapIndex::getUnitType(int index) const {
+    return mUnitTypes.get(index);
+}
+
+int MapIndex::getGroup(const TileGroup * group) const {
+    return mGroups.find(group);
+}
+
+TileGroup * MapIndex::getGroup(int index) const {
+    return mGroups.get(index);
+}
@@ -0,0 +1,174 @@
+//      MapIndex.hpp -- Numbers the shared types of a replicated map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MAPINDEX_HPP_INCLUDED
+#define MAPINDEX_HPP_INCLUDED
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+namespace Aftermath { class Mod;
+                      class Resource;
+                      class SpecialistType;
+                      class Terrain;
+                      class TileGroup;
+                      class UnitType; }
+
+/**
+ * @file MapIndex.hpp
+ *
+ * Numbers the shared types of a replicated map.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A MapIndex gives every Terrain, Resource, SpecialistType, UnitType,
+     * and TileGroup a small number, so that a MapServer can send numbers
+     * instead of names or pointers. Mod types are numbered in name order,
+     * which is the same on every machine that loaded the same Mod.
+     * TileGroups are numbered in the order they are added.
+     *
+     * Lookups of a number that is out of range return NULL, and lookups of
+     * an unknown object return -1.
+     */
+    class MapIndex {
+        public:
+            /**
+             * Numbers the types of the given Mod.
+             *
+             * @param mod - The Mod shared by the server and its clients.
+             */
+            MapIndex(const Mod & mod);
+
+            /**
+             * Gives the next number to the given TileGroup.
+             *
+             * @param group - The group to number.
+             */
+            void add(TileGroup * group);
+
+            /**
+             * @return The number of TileGroups that have been added.
+             */
+            unsigned getGroupCount() const;
+
+            /**
+             * @return The number of the given Terrain, or -1.
+             */
+            int getTerrain(const Terrain * terrain) const;
+
+            /**
+             * @return The Terrain with the given number, or NULL.
+             */
+            const Terrain * getTerrain(int index) const;
+
+            /**
+             * @return The number of the given Resource, or -1.
+             */
+            int getResource(const Resource * resource) const;
+
+            /**
+             * @return The Resource with the given number, or NULL.
+             */
+            const Resource * getResource(int index) const;
+
+            /**
+             * @return The number of the given SpecialistType, or -1.
+             */
+            int getSpecialistType(const SpecialistType * type) const;
+
+            /**
+             * @return The SpecialistType with the given number, or NULL.
+             */
+            const SpecialistType * getSpecialistType(int index) const;
+
+            /**
+             * @return The number of the given UnitType, or -1.
+             */
+            int getUnitType(const UnitType * type) const;
+
+            /**
+             * @return The UnitType with the given number, or NULL.
+             */
+            const UnitType * getUnitType(int index) const;
+
+            /**
+             * @return The number of the given TileGroup, or -1.
+             */
+            int getGroup(const TileGroup * group) const;
+
+            /**
+             * @return The TileGroup with the given number, or NULL.
+             */
+            TileGroup * getGroup(int index) const;
+
+        private:
+            /**
+             * A two-way table between objects and their numbers.
+             */
+            template <typename T>
+            class Table {
+                public:
+                    void add(T * element) {
+                        mNumbers[element] = mElements.size();
+                        mElements.push_back(element);
+                    }
+
+                    template <typename Map>
+                    void addAll(const Map & map) {
+                        typename Map::const_iterator itr;
+                        for (itr = map.begin(); itr != map.end(); ++itr)
+                            add(itr->second);
+                    }
+
+                    int find(const T * element) const {
+                        typename std::map<const T *, int>::const_iterator
+                            itr = mNumbers.find(element);
+                        return itr == mNumbers.end() ? -1 : itr->second;
+                    }
+
+                    T * get(int index) const {
+                        if (index < 0 || index >= (int) mElements.size())
+                            return NULL;
+                        return mElements[index];
+                    }
+
+                    unsigned size() const {
+                        return mElements.size();
+                    }
+
+                private:
+                    std::vector<T *> mElements;
+                    std::map<const T *, int> mNumbers;
+            };
+
+            Table<const Terrain> mTerrain;
+            Table<const Resource> mResources;
+            Table<const SpecialistType> mSpecialistTypes;
+            Table<const UnitType> mUnitTypes;
+            Table<TileGroup> mGroups;
+    };
+
+}
+
+#endif // MAPINDEX_HPP_INCLUDED
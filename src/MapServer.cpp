@@ -0,0 +1,190 @@
+//      MapServer.cpp -- Sends each client its view of an authoritative map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Game.hpp"
+#include "MapServer.hpp"
+#include "MapView.hpp"
+#include "Player.hpp"
+#include "TileGroup.hpp"
+#include "TileMap.hpp"
+
+using namespace Aftermath;
+
+// How long a connected client has to ask to join, in seconds
+#define JOIN_TIMEOUT 5.0f
+
+// Orders groups by name
+static bool byName(const TileGroup * a, const TileGroup * b) {
+    return a->getName() < b->getName();
+}
+
+// Orders players by id
+static bool byId(const Player * a, const Player * b) {
+    return a->getId() < b->getId();
+}
+
+MapServer::MapServer(Game & game) : mGame(game), mIndex(game.getMod()),
+        mBytes(0) {
+    std::vector<TileGroup *> groups(game.getMap().begin(),
+        game.getMap().end());
+    std::sort(groups.begin(), groups.end(), byName);
+    std::vector<TileGroup *>::iterator itr;
+    for (itr = groups.begin(); itr != groups.end(); ++itr) mIndex.add(*itr);
+}
+
+MapServer::~MapServer() {
+    close();
+}
+
+bool MapServer::listen(unsigned short port) {
+    if (mListener.Listen(port) != sf::Socket::Done) return false;
+    mListener.SetBlocking(false);
+    return true;
+}
+
+unsigned MapServer::acceptClients() {
+    // Take in new connections without waiting for anything from them
+    sf::TcpSocket * client = new sf::TcpSocket();
+    while (mListener.Accept(*client) == sf::Socket::Done) {
+        client->SetBlocking(false);
+        mPending.push_back(std::make_pair(client,
+            mClock.GetElapsedTime() + JOIN_TIMEOUT));
+        client = new sf::TcpSocket();
+    }
+    delete client;
+
+    // Serve the clients that have asked to join
+    unsigned joined = 0, i = 0;
+    while (i < mPending.size()) {
+        client = mPending[i].first;
+        sf::Packet packet;
+        sf::Socket::Status status = client->Receive(packet);
+        if (status == sf::Socket::NotReady &&
+            mClock.GetElapsedTime() < mPending[i].second) {
+            ++i;
+            continue;
+        }
+        mPending.erase(mPending.begin() + i);
+        if (status == sf::Socket::Done && join(client, packet)) {
+            ++joined;
+        } else {
+            client->Disconnect();
+            delete client;
+        }
+    }
+    return joined;
+}
+
+unsigned MapServer::update() {
+    unsigned sent = 0, i = 0;
+    while (i < mClients.size()) {
+        const Player * player = mGame.getPlayer(mPlayers[i]);
+        if (player == NULL) {
+            drop(i);
+            continue;
+        }
+        sf::Packet packet;
+        packet << (sf::Uint8) MAP_DELTA << (sf::Int32) mGame.getTurn();
+        unsigned changes = mViews[i]->update(mGame, *player, packet);
+        if (mClients[i]->Send(packet) != sf::Socket::Done) {
+            drop(i);
+            continue;
+        }
+        mBytes += packet.GetDataSize();
+        sent += changes;
+        ++i;
+    }
+    return sent;
+}
+
+void MapServer::close() {
+    while (!mClients.empty()) drop(mClients.size() - 1);
+    std::vector<std::pair<sf::TcpSocket *, float> >::iterator pending;
+    for (pending = mPending.begin(); pending != mPending.end(); ++pending) {
+        pending->first->Disconnect();
+        delete pending->first;
+    }
+    mPending.clear();
+    mListener.Close();
+}
+
+unsigned MapServer::getClientCount() const {
+    return mClients.size();
+}
+
+unsigned long MapServer::getBytesSent() const {
+    return mBytes;
+}
+
+// Sends a snapshot to a client that has asked to join, and starts keeping
+// its view up to date
+bool MapServer::join(sf::TcpSocket * client, sf::Packet & packet) {
+    sf::Uint8 message;
+    sf::Int32 id;
+    if (!(packet >> message >> id) || message != MAP_JOIN) return false;
+    const Player * player = mGame.getPlayer(id);
+    if (player == NULL) return false;
+
+    // The layout of the map
+    const TileMap & map = mGame.getMap();
+    packet.Clear();
+    packet << (sf::Uint8) MAP_SNAPSHOT << (sf::Int32) mGame.getTurn()
+           << map.getName() << (sf::Uint32) map.rows()
+           << (sf::Uint32) map.columns()
+           << (sf::Uint32) mIndex.getGroupCount();
+    unsigned i;
+    for (i = 0; i < mIndex.getGroupCount(); ++i)
+        packet << mIndex.getGroup(i)->getName()
+               << (sf::Uint8) mIndex.getGroup(i)->isLand();
+    std::vector<const Player *> players(mGame.begin(), mGame.end());
+    std::sort(players.begin(), players.end(), byId);
+    packet << (sf::Uint32) players.size();
+    for (i = 0; i < players.size(); ++i)
+        packet << (sf::Int32) players[i]->getId()
+               << players[i]->getName();
+
+    // Everything the player can see, as a delta from nothing. From here on
+    // the client is sent whole packets, like every other client.
+    MapView * view = new MapView(mIndex, map.rows() * map.columns());
+    view->update(mGame, *player, packet);
+    client->SetBlocking(true);
+    if (client->Send(packet) != sf::Socket::Done) {
+        delete view;
+        return false;
+    }
+    mBytes += packet.GetDataSize();
+    mClients.push_back(client);
+    mPlayers.push_back(id);
+    mViews.push_back(view);
+    return true;
+}
+
+// Disconnects and forgets a client
+void MapServer::drop(unsigned client) {
+    mClients[client]->Disconnect();
+    delete mClients[client];
+    delete mViews[client];
+    mClients.erase(mClients.begin() + client);
+    mPlayers.erase(mPlayers.begin() + client);
+    mViews.erase(mViews.begin() + client);
+}
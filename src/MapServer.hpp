@@ -0,0 +1,150 @@
+//      MapServer.hpp -- Sends each client its view of an authoritative map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MAPSERVER_HPP_INCLUDED
+#define MAPSERVER_HPP_INCLUDED
+
+#include <utility>
+#include <vector>
+
+#include <SFML/Network/TcpListener.hpp>
+#include <SFML/Network/TcpSocket.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include "MapIndex.hpp"
+
+namespace sf { class Packet; }
+
+namespace Aftermath { class Game;
+                      class MapView; }
+
+/**
+ * @file MapServer.hpp
+ *
+ * Sends each client its view of an authoritative map.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * The types of messages sent between a MapServer and its clients. Each
+     * packet starts with one of these as an sf::Uint8.
+     */
+    enum MapMessage {
+        MAP_JOIN,     /**< Client to server: the id of the client's player. */
+        MAP_SNAPSHOT, /**< Server to client: the map layout and a full view. */
+        MAP_DELTA     /**< Server to client: the changes since last turn.    */
+    };
+
+    /**
+     * A MapServer owns the authoritative copy of a game and replicates its
+     * map to MapClients. The clients never generate their own resources or
+     * run their own simulation; they only see what the server sends them.
+     *
+     * Each client plays one Player and only receives what that player can
+     * see (see MapView::update()). A client that joins receives the layout
+     * of the map and a snapshot of its view in one packet. After that, each
+     * call to update() sends every client a single packet holding only the
+     * fields that changed in its view. Clients can join at any time.
+     *
+     * TileGroups are numbered in name order when the server is created, so
+     * groups must not be added to the map afterward.
+     */
+    class MapServer {
+        public:
+            /**
+             * Constructs a server for the given game.
+             *
+             * @param game - The authoritative game.
+             */
+            MapServer(Game & game);
+
+            /**
+             * Disconnects all clients and stops listening.
+             */
+            ~MapServer();
+
+            /**
+             * Starts listening for clients on the given port. The listener
+             * does not block, so acceptClients() can be called every turn.
+             *
+             * @param port - The TCP port to listen on.
+             *
+             * @return true if the server is listening; false otherwise.
+             */
+            bool listen(unsigned short port);
+
+            /**
+             * Accepts every client that is waiting to connect, and sends
+             * each client that has asked to join a snapshot of its player's
+             * view. This never blocks: a client that has connected but not
+             * yet asked is checked again on the next call, and is dropped if
+             * it has not asked within a few seconds. Clients that ask for a
+             * player that is not in the game are turned away.
+             *
+             * @return The number of clients that joined.
+             */
+            unsigned acceptClients();
+
+            /**
+             * Sends every client the changes to its view since its last
+             * update or snapshot. Clients that have disconnected are
+             * dropped.
+             *
+             * @return The number of tiles and groups sent, over all clients.
+             */
+            unsigned update();
+
+            /**
+             * Disconnects all clients and stops listening.
+             */
+            void close();
+
+            /**
+             * @return The number of connected clients.
+             */
+            unsigned getClientCount() const;
+
+            /**
+             * @return The number of bytes sent to clients so far.
+             */
+            unsigned long getBytesSent() const;
+
+        private:
+            Game & mGame;
+            MapIndex mIndex;
+            sf::TcpListener mListener;
+            std::vector<sf::TcpSocket *> mClients;
+            std::vector<int> mPlayers;
+            std::vector<MapView *> mViews;
+            // Connected clients that have not asked to join yet, with the
+            // time by which they must
+            std::vector<std::pair<sf::TcpSocket *, float> > mPending;
+            sf::Clock mClock;
+            unsigned long mBytes;
+
+            bool join(sf::TcpSocket * client, sf::Packet & packet);
+            void drop(unsigned client);
+    };
+
+}
+
+#endif // MAPSERVER_HPP_INCLUDED
@@ -0,0 +1,349 @@
+//      MapView.cpp -- What one player can see of a map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include "AdjacencyGraph.hpp"
+#include "Game.hpp"
+#include "MapIndex.hpp"
+#include "MapView.hpp"
+#include "Player.hpp"
+#include "Terrain.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
+#include "TileGroupUnit.hpp"
+#include "TileMap.hpp"
+#include "TileUnit.hpp"
+#include "UnitLevel.hpp"
+#include "UnitType.hpp"
+
+using namespace Aftermath;
+
+// The fields of a tile record
+#define TILE_TERRAIN    0x01
+#define TILE_GROUP      0x02
+#define TILE_YIELD      0x04
+#define TILE_RESOURCES  0x08
+#define TILE_UNIT       0x10
+
+// The fields of a group record
+#define GROUP_OWNER     0x01
+#define GROUP_UNITS     0x02
+
+// The numbers that describe one TileGroupUnit
+#define UNIT_FIELDS     4
+
+// Writes a number as a zigzag varint: small magnitudes take one byte
+static void writeNumber(std::vector<sf::Uint8> & out, int number) {
+    sf::Uint32 value = ((sf::Uint32) number << 1) ^
+        (sf::Uint32) (number >> 31);
+    while (value >= 0x80) {
+        out.push_back((sf::Uint8) (value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((sf::Uint8) value);
+}
+
+// Writes a list of numbers, prefixed by its length
+static void writeNumbers(std::vector<sf::Uint8> & out,
+        const std::vector<int> & numbers) {
+    writeNumber(out, numbers.size());
+    std::vector<int>::const_iterator itr;
+    for (itr = numbers.begin(); itr != numbers.end(); ++itr)
+        writeNumber(out, *itr);
+}
+
+// Reads a number written by writeNumber()
+static bool readNumber(const std::vector<sf::Uint8> & in, unsigned & pos,
+        int & number) {
+    sf::Uint32 value = 0;
+    unsigned shift;
+    for (shift = 0; pos < in.size() && shift < 35; shift += 7) {
+        sf::Uint8 byte = in[pos++];
+        value |= (sf::Uint32) (byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            number = (int) (value >> 1) ^ -(int) (value & 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Reads a list of numbers written by writeNumbers()
+static bool readNumbers(const std::vector<sf::Uint8> & in,
+        unsigned & pos, std::vector<int> & numbers) {
+    int size;
+    if (!readNumber(in, pos, size) || size < 0 || (unsigned) size > in.size())
+        return false;
+    numbers.resize(size);
+    for (int i = 0; i < size; ++i)
+        if (!readNumber(in, pos, numbers[i])) return false;
+    return true;
+}
+
+MapView::MapView(const MapIndex & index, unsigned tiles) : mIndex(index),
+    mTerrain(tiles, -1), mGroup(tiles, -1), mYield(tiles, 0),
+    mUnitOwner(tiles, -1), mUnitType(tiles, -1), mResources(tiles),
+    mOwner(index.getGroupCount(), -1), mUnits(index.getGroupCount()) {}
+
+unsigned MapView::update(const Game & game, const Player & player,
+        sf::Packet & packet) {
+    const TileMap & map = game.getMap();
+    unsigned rows = map.rows(), columns = map.columns();
+
+    // Find the tiles in sight
+    std::vector<bool> visible(rows * columns, false);
+    unsigned row, column;
+    for (row = 0; row < rows; ++row) {
+        for (column = 0; column < columns; ++column) {
+            const Tile & tile = map(row, column);
+            const TileGroup * group = tile.getTileGroup();
+            const TileUnit * unit = tile.getTileUnit();
+            if (!(group != NULL && group->getOwner() == &player) &&
+                !(unit != NULL && &unit->getOwner() == &player))
+                continue;
+            unsigned r, c;
+            for (r = row > 0 ? row - 1 : 0; r <= row + 1 && r < rows; ++r)
+                for (c = column > 0 ? column - 1 : 0;
+                        c <= column + 1 && c < columns; ++c)
+                    visible[r * columns + c] = true;
+        }
+    }
+
+    // Write the changed tiles
+    std::vector<sf::Uint8> bytes;
+    std::vector<bool> seen(mOwner.size(), false);
+    unsigned tiles = 0, next = 0, index;
+    for (index = 0; index < visible.size(); ++index) {
+        if (!visible[index]) continue;
+        const Tile & tile = map(index / columns, index % columns);
+        int terrain = mIndex.getTerrain(tile.getTerrain());
+        int group = mIndex.getGroup(tile.getTileGroup());
+        const TileUnit * unit = tile.getTileUnit();
+        int unitOwner = unit != NULL ? unit->getOwner().getId() : -1;
+        int unitType = unit != NULL ?
+            mIndex.getSpecialistType(unit->getType()) : -1;
+        std::vector<int> resources;
+        if (tile.getTerrain() == NULL || tile.getTerrain()->isRevealed() ||
+            player.getRevealed().contains(&tile)) {
+            Tile::const_iterator itr;
+            for (itr = tile.begin(); itr != tile.end(); ++itr)
+                resources.push_back(mIndex.getResource(*itr));
+            std::sort(resources.begin(), resources.end());
+        }
+        if (group >= 0 && (unsigned) group < seen.size()) seen[group] = true;
+
+        sf::Uint8 mask = 0;
+        if (terrain != mTerrain[index]) mask |= TILE_TERRAIN;
+        if (group != mGroup[index]) mask |= TILE_GROUP;
+        if (tile.getYield() != mYield[index]) mask |= TILE_YIELD;
+        if (resources != mResources[index]) mask |= TILE_RESOURCES;
+        if (unitOwner != mUnitOwner[index] || unitType != mUnitType[index])
+            mask |= TILE_UNIT;
+        if (mask == 0) continue;
+
+        writeNumber(bytes, index - next);
+        bytes.push_back(mask);
+        if (mask & TILE_TERRAIN) writeNumber(bytes, mTerrain[index] = terrain);
+        if (mask & TILE_GROUP) writeNumber(bytes, mGroup[index] = group);
+        if (mask & TILE_YIELD)
+            writeNumber(bytes, mYield[index] = tile.getYield());
+        if (mask & TILE_RESOURCES) {
+            mResources[index].swap(resources);
+            writeNumbers(bytes, mResources[index]);
+        }
+        if (mask & TILE_UNIT) {
+            writeNumber(bytes, mUnitOwner[index] = unitOwner);
+            writeNumber(bytes, mUnitType[index] = unitType);
+        }
+        next = index + 1;
+        ++tiles;
+    }
+
+    // Write the changed groups
+    unsigned groups = 0;
+    next = 0;
+    for (index = 0; index < seen.size(); ++index) {
+        if (!seen[index]) continue;
+        const TileGroup * group = mIndex.getGroup(index);
+        const Player * owner = group->getOwner();
+        int ownerId = owner != NULL ? owner->getId() : -1;
+        std::vector<std::vector<int> > sorted;
+        const SelectiveCollection<const TileGroupUnit *> & units =
+            group->getUnits();
+        SelectiveCollection<const TileGroupUnit *>::const_iterator itr;
+        for (itr = units.begin(); itr != units.end(); ++itr) {
+            const std::vector<const UnitLevel *> & levels =
+                (*itr)->getType().getLevels();
+            std::vector<int> fields(UNIT_FIELDS);
+            fields[0] = (*itr)->getOwner().getId();
+            fields[1] = mIndex.getUnitType(&(*itr)->getType());
+            fields[2] = std::find(levels.begin(), levels.end(),
+                &(*itr)->getLevel()) - levels.begin();
+            fields[3] = (*itr)->getToughness();
+            sorted.push_back(fields);
+        }
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<int> flat;
+        std::vector<std::vector<int> >::const_iterator unit;
+        for (unit = sorted.begin(); unit != sorted.end(); ++unit)
+            flat.insert(flat.end(), unit->begin(), unit->end());
+
+        sf::Uint8 mask = 0;
+        if (ownerId != mOwner[index]) mask |= GROUP_OWNER;
+        if (flat != mUnits[index]) mask |= GROUP_UNITS;
+        if (mask == 0) continue;
+
+        writeNumber(bytes, index - next);
+        bytes.push_back(mask);
+        if (mask & GROUP_OWNER) writeNumber(bytes, mOwner[index] = ownerId);
+        if (mask & GROUP_UNITS) {
+            mUnits[index].swap(flat);
+            writeNumbers(bytes, mUnits[index]);
+        }
+        next = index + 1;
+        ++groups;
+    }
+
+    // Batch everything into one packet
+    packet << (sf::Uint32) tiles << (sf::Uint32) groups
+           << (sf::Uint32) bytes.size();
+    if (!bytes.empty()) packet.Append(&bytes[0], bytes.size());
+    return tiles + groups;
+}
+
+bool MapView::read(sf::Packet & packet, std::vector<unsigned> & tiles,
+        std::vector<unsigned> & groups) {
+    tiles.clear();
+    groups.clear();
+    sf::Uint32 tileCount, groupCount, size;
+    if (!(packet >> tileCount >> groupCount >> size)) return false;
+    std::vector<sf::Uint8> bytes(size);
+    unsigned i;
+    for (i = 0; i < size; ++i)
+        if (!(packet >> bytes[i])) return false;
+
+    unsigned pos = 0, next = 0;
+    int gap, mask;
+    for (i = 0; i < tileCount; ++i) {
+        if (!readNumber(bytes, pos, gap) || gap < 0 || pos >= bytes.size())
+            return false;
+        unsigned index = next + gap;
+        mask = bytes[pos++];
+        if (index >= mTerrain.size()) return false;
+        if ((mask & TILE_TERRAIN) && !readNumber(bytes, pos, mTerrain[index]))
+            return false;
+        if ((mask & TILE_GROUP) && !readNumber(bytes, pos, mGroup[index]))
+            return false;
+        if ((mask & TILE_YIELD) && !readNumber(bytes, pos, mYield[index]))
+            return false;
+        if ((mask & TILE_RESOURCES) &&
+            !readNumbers(bytes, pos, mResources[index]))
+            return false;
+        if ((mask & TILE_UNIT) &&
+            (!readNumber(bytes, pos, mUnitOwner[index]) ||
+             !readNumber(bytes, pos, mUnitType[index])))
+            return false;
+        tiles.push_back(index);
+        next = index + 1;
+    }
+
+    next = 0;
+    for (i = 0; i < groupCount; ++i) {
+        if (!readNumber(bytes, pos, gap) || gap < 0 || pos >= bytes.size())
+            return false;
+        unsigned index = next + gap;
+        mask = bytes[pos++];
+        if (index >= mOwner.size()) return false;
+        if ((mask & GROUP_OWNER) && !readNumber(bytes, pos, mOwner[index]))
+            return false;
+        if ((mask & GROUP_UNITS) && (!readNumbers(bytes, pos, mUnits[index]) ||
+            mUnits[index].size() % UNIT_FIELDS != 0))
+            return false;
+        groups.push_back(index);
+        next = index + 1;
+    }
+    return pos == bytes.size();
+}
+
+void MapView::patch(Game & game, const std::vector<unsigned> & tiles,
+        const std::vector<unsigned> & groups) const {
+    TileMap & map = game.getMap();
+    std::vector<unsigned>::const_iterator itr;
+    for (itr = tiles.begin(); itr != tiles.end(); ++itr) {
+        unsigned index = *itr;
+        Tile & tile = map(index / map.columns(), index % map.columns());
+        // Terrain first, since it decides which resources and groups fit
+        tile.setTerrain(mIndex.getTerrain(mTerrain[index]), false);
+        tile.setYield(mYield[index]);
+        tile.clear();
+        if (tile.getTerrain() != NULL) {
+            std::vector<int>::const_iterator resource;
+            for (resource = mResources[index].begin();
+                    resource != mResources[index].end(); ++resource) {
+                const Resource * r = mIndex.getResource(*resource);
+                if (r != NULL) tile.add(r);
+            }
+        }
+        TileGroup * group = mIndex.getGroup(mGroup[index]);
+        if (tile.getTileGroup() != group) {
+            // The groups keep the game's adjacency graph up to date
+            if (tile.getTileGroup() != NULL)
+                tile.getTileGroup()->remove(&tile);
+            if (group != NULL && tile.getTerrain() != NULL) group->add(&tile);
+        }
+        delete tile.getTileUnit();
+        tile.setTileUnit(NULL);
+        Player * unitOwner = game.getPlayer(mUnitOwner[index]);
+        const SpecialistType * unitType =
+            mIndex.getSpecialistType(mUnitType[index]);
+        if (unitOwner != NULL && unitType != NULL)
+            tile.setTileUnit(new TileUnit(*unitOwner, unitType));
+    }
+
+    for (itr = groups.begin(); itr != groups.end(); ++itr) {
+        unsigned index = *itr;
+        TileGroup * group = mIndex.getGroup(index);
+        Player * owner = game.getPlayer(mOwner[index]);
+        if (group->getOwner() != owner) {
+            if (group->getOwner() != NULL) group->getOwner()->remove(group);
+            if (owner != NULL) owner->add(group);
+            group->setOwner(owner);
+        }
+        SelectiveCollection<TileGroupUnit *> & units = group->getUnits();
+        SelectiveCollection<TileGroupUnit *>::iterator unit;
+        for (unit = units.begin(); unit != units.end(); ++unit) delete *unit;
+        units.clear();
+        const std::vector<int> & fields = mUnits[index];
+        unsigned i;
+        for (i = 0; i + UNIT_FIELDS <= fields.size(); i += UNIT_FIELDS) {
+            Player * unitOwner = game.getPlayer(fields[i]);
+            const UnitType * type = mIndex.getUnitType(fields[i + 1]);
+            if (unitOwner == NULL || type == NULL || fields[i + 2] < 0 ||
+                (unsigned) fields[i + 2] >= type->getLevels().size())
+                continue;
+            TileGroupUnit * u = new TileGroupUnit(type, *unitOwner);
+            int level;
+            for (level = 0; level < fields[i + 2]; ++level)
+                u->finishUpgrade();
+            u->setToughness(fields[i + 3]);
+            units.add(u);
+        }
+    }
+}
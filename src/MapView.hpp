@@ -0,0 +1,134 @@
+//      MapView.hpp -- What one player can see of a map.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MAPVIEW_HPP_INCLUDED
+#define MAPVIEW_HPP_INCLUDED
+
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+namespace Aftermath { class Game;
+                      class MapIndex;
+                      class Player; }
+
+/**
+ * @file MapView.hpp
+ *
+ * What one player can see of a map.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A MapView is one player's last known picture of a TileMap: the
+     * terrain, yield, revealed resources, group, and TileUnit of each Tile,
+     * and the owner and units of each TileGroup. Everything is stored as
+     * numbers from a MapIndex, one array per field.
+     *
+     * A MapServer keeps one MapView per client, holding what it last sent.
+     * update() brings the view up to date with the parts of the real map
+     * that the player can see, and writes only the fields that changed. The
+     * client keeps a matching MapView, reads the changes with read(), and
+     * copies them into its own Game with patch(). Tiles that fall out of
+     * sight keep their last known state, like a fog of war.
+     *
+     * A delta starts with the number of changed tiles and groups, followed
+     * by a byte stream. Each changed record is the gap from the previous
+     * changed index, a mask of the changed fields, and then just those
+     * fields. Every number is written as a variable-length integer, so
+     * most fields take a single byte. A snapshot for a new client is simply
+     * the delta from an empty view.
+     */
+    class MapView {
+        public:
+            /**
+             * Constructs a view in which nothing is known. Every TileGroup
+             * must already have been added to the index.
+             *
+             * @param index - The numbering shared with the other side.
+             * @param tiles - The number of tiles in the map.
+             */
+            MapView(const MapIndex & index, unsigned tiles);
+
+            /**
+             * Looks at the given game through the eyes of the given player
+             * and writes a delta of everything that changed since the last
+             * update.
+             *
+             * A player can see every Tile in or next to a Province that the
+             * player owns or a Tile with one of the player's TileUnits, and
+             * every TileGroup with a Tile in sight. The Resources of a Tile
+             * are only shown if its Terrain is revealed or the player has
+             * revealed the Tile.
+             *
+             * @param game - The authoritative game.
+             * @param player - The player looking at the map.
+             * @param packet - The packet to write the delta to.
+             *
+             * @return The number of tiles and groups that changed.
+             */
+            unsigned update(const Game & game, const Player & player,
+                sf::Packet & packet);
+
+            /**
+             * Reads a delta written by update() into this view.
+             *
+             * @param packet - The packet to read from.
+             * @param tiles - Filled with the indices of the changed tiles.
+             * @param groups - Filled with the numbers of the changed groups.
+             *
+             * @return true if the delta was read; false if it was malformed.
+             */
+            bool read(sf::Packet & packet, std::vector<unsigned> & tiles,
+                std::vector<unsigned> & groups);
+
+            /**
+             * Copies the given tiles and groups of this view into a game.
+             * The game's map must have been built from the same MapIndex.
+             * Objects that refer to unknown players are left out.
+             *
+             * @param game - The client's copy of the game.
+             * @param tiles - The indices of the tiles to copy.
+             * @param groups - The numbers of the groups to copy.
+             */
+            void patch(Game & game, const std::vector<unsigned> & tiles,
+                const std::vector<unsigned> & groups) const;
+
+        private:
+            const MapIndex & mIndex;
+
+            // Tiles, indexed by row * columns + column
+            std::vector<int> mTerrain;
+            std::vector<int> mGroup;
+            std::vector<int> mYield;
+            std::vector<int> mUnitOwner;
+            std::vector<int> mUnitType;
+            std::vector<std::vector<int> > mResources;
+
+            // TileGroups, indexed by their MapIndex number
+            std::vector<int> mOwner;
+            std::vector<std::vector<int> > mUnits;
+    };
+
+}
+
+#endif // MAPVIEW_HPP_INCLUDED
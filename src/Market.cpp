@@ -0,0 +1,211 @@
+//      Market -- The world market for resources.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include "Game.hpp"
+#include "Market.hpp"
+#include "Mod.hpp"
+#include "Player.hpp"
+#include "Resource.hpp"
+#include "TransportNetwork.hpp"
+#include "Treaty.hpp"
+
+using namespace Aftermath;
+
+// Orders are posted in time order, so a stable sort by price alone keeps the
+// older of two equal orders first
+bool Market::higherPrice(const Order & a, const Order & b) {
+    return a.mPrice > b.mPrice;
+}
+
+bool Market::lowerPrice(const Order & a, const Order & b) {
+    return a.mPrice < b.mPrice;
+}
+
+bool Market::isFilled(const Order & order) {
+    return order.mAmount <= 0;
+}
+
+Market::Market(const Mod & mod) : mMod(mod), mTime(0) {}
+
+bool Market::bid(Player & player, const Resource * resource, int amount,
+        int price) {
+    Book * book = find(resource);
+    // Dividing keeps amount * price from overflowing; every later product of
+    // an amount and a price in this book is bounded by it
+    if (book == NULL || amount <= 0 || price < 0 ||
+        mOrders[player.getId()] >= mMod.getMaxBids() ||
+        (price > 0 && amount > player.getMoney() / price))
+        return false;
+    player.takeMoney(amount * price);
+    player.getTransport().startBidding(resource);
+    post(book->mBids, player, amount, price);
+    return true;
+}
+
+bool Market::ask(Player & player, const Resource * resource, int amount,
+        int price) {
+    Book * book = find(resource);
+    TransportNetwork & transport = player.getTransport();
+    if (book == NULL || amount <= 0 || price < 0 ||
+        mOrders[player.getId()] >= mMod.getMaxBids() ||
+        !player.canTake((const Transferable *) resource, amount) ||
+        transport.getTrading(resource) + amount >
+            transport.getMerchantMarine())
+        return false;
+    transport.startTrading(player, resource, amount);
+    post(book->mAsks, player, amount, price);
+    return true;
+}
+
+void Market::cancel(Player & player, const Resource * resource) {
+    Book * book = find(resource);
+    if (book == NULL) return;
+    int & orders = mOrders[player.getId()];
+    std::vector<Order>::iterator itr;
+    for (itr = book->mBids.begin(); itr != book->mBids.end(); ++itr) {
+        if (itr->mPlayer != player.getId()) continue;
+        player.giveMoney(itr->mAmount * itr->mPrice);
+        itr->mAmount = 0;
+        --orders;
+    }
+    for (itr = book->mAsks.begin(); itr != book->mAsks.end(); ++itr) {
+        if (itr->mPlayer != player.getId()) continue;
+        player.getTransport().stopTrading(player, resource, itr->mAmount);
+        itr->mAmount = 0;
+        --orders;
+    }
+    book->mBids.erase(std::remove_if(book->mBids.begin(), book->mBids.end(),
+        isFilled), book->mBids.end());
+    book->mAsks.erase(std::remove_if(book->mAsks.begin(), book->mAsks.end(),
+        isFilled), book->mAsks.end());
+    player.getTransport().cancelBidding(resource);
+}
+
+void Market::cancel(Player & player) {
+    find(NULL);
+    std::vector<const Resource *>::const_iterator itr;
+    for (itr = mResources.begin(); itr != mResources.end(); ++itr)
+        cancel(player, *itr);
+    mOrders.erase(player.getId());
+}
+
+int Market::getOrders(const Player & player) const {
+    std::map<int, int>::const_iterator itr = mOrders.find(player.getId());
+    return itr == mOrders.end() ? 0 : itr->second;
+}
+
+int Market::getPrice(const Resource * resource) const {
+    std::map<const Resource *, unsigned>::const_iterator itr =
+        mIndex.find(resource);
+    return itr == mIndex.end() ? -1 : mBooks[itr->second].mPrice;
+}
+
+int Market::match(Game & game) {
+    // Look players up by id without searching the game
+    std::vector<Player *> players;
+    Game::iterator player;
+    for (player = game.begin(); player != game.end(); ++player) {
+        unsigned id = (*player)->getId();
+        if (id >= players.size()) players.resize(id + 1, NULL);
+        players[id] = *player;
+    }
+
+    int traded = 0;
+    unsigned index;
+    for (index = 0; index < mBooks.size(); ++index) {
+        const Resource * resource = mResources[index];
+        Book & book = mBooks[index];
+        if (book.mBids.empty() || book.mAsks.empty()) continue;
+        std::stable_sort(book.mBids.begin(), book.mBids.end(), higherPrice);
+        std::stable_sort(book.mAsks.begin(), book.mAsks.end(), lowerPrice);
+
+        std::vector<Order>::iterator bid, ask;
+        for (bid = book.mBids.begin(); bid != book.mBids.end(); ++bid) {
+            Player * buyer = players[bid->mPlayer];
+            for (ask = book.mAsks.begin(); ask != book.mAsks.end() &&
+                    ask->mPrice <= bid->mPrice && bid->mAmount > 0; ++ask) {
+                if (ask->mAmount <= 0 || ask->mPlayer == bid->mPlayer)
+                    continue;
+                Player * seller = players[ask->mPlayer];
+                if (buyer->getTreaty(seller).getBoycott() ||
+                    seller->getTreaty(buyer).getBoycott())
+                    continue;
+                int amount = std::min(bid->mAmount, ask->mAmount);
+                int price = ask->mTime < bid->mTime ? ask->mPrice :
+                    bid->mPrice;
+                seller->getTransport().finishTrade(*buyer, resource, amount);
+                seller->giveMoney(amount * price);
+                buyer->giveMoney(amount * (bid->mPrice - price));
+                bid->mAmount -= amount;
+                ask->mAmount -= amount;
+                book.mPrice = price;
+                traded += amount;
+            }
+            if (bid->mAmount <= 0) --mOrders[bid->mPlayer];
+        }
+        for (ask = book.mAsks.begin(); ask != book.mAsks.end(); ++ask)
+            if (ask->mAmount <= 0) --mOrders[ask->mPlayer];
+
+        book.mBids.erase(std::remove_if(book.mBids.begin(), book.mBids.end(),
+            isFilled), book.mBids.end());
+        book.mAsks.erase(std::remove_if(book.mAsks.begin(), book.mAsks.end(),
+            isFilled), book.mAsks.end());
+
+        // Players whose bids were all filled are no longer bidding
+        std::vector<bool> bidding(players.size(), false);
+        for (bid = book.mBids.begin(); bid != book.mBids.end(); ++bid)
+            bidding[bid->mPlayer] = true;
+        for (player = game.begin(); player != game.end(); ++player)
+            if (!bidding[(*player)->getId()])
+                (*player)->getTransport().cancelBidding(resource);
+    }
+    return traded;
+}
+
+// Finds the book of a resource, setting up the books the first time
+Market::Book * Market::find(const Resource * resource) {
+    if (mBooks.empty()) {
+        const std::map<std::string, const Resource *> & resources =
+            mMod.getResources();
+        std::map<std::string, const Resource *>::const_iterator itr;
+        for (itr = resources.begin(); itr != resources.end(); ++itr) {
+            mIndex[itr->second] = mResources.size();
+            mResources.push_back(itr->second);
+        }
+        Book book;
+        book.mPrice = -1;
+        mBooks.assign(mResources.size(), book);
+    }
+    std::map<const Resource *, unsigned>::const_iterator itr =
+        mIndex.find(resource);
+    return itr == mIndex.end() ? NULL : &mBooks[itr->second];
+}
+
+void Market::post(std::vector<Order> & orders, const Player & player,
+        int amount, int price) {
+    Order order;
+    order.mPlayer = player.getId();
+    order.mAmount = amount;
+    order.mPrice = price;
+    order.mTime = mTime++;
+    orders.push_back(order);
+    ++mOrders[player.getId()];
+}
@@ -0,0 +1,174 @@
+//      Market -- The world market for resources.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MARKET_HPP_INCLUDED
+#define MARKET_HPP_INCLUDED
+
+#include <map>
+#include <vector>
+
+namespace Aftermath { class Game;
+                      class Mod;
+                      class Player;
+                      class Resource; }
+
+/**
+ * @file Market.hpp
+ *
+ * The world market for resources.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A Market is the order book that players trade resources through. Each
+     * player can post bids to buy and asks to sell, up to Mod::getMaxBids()
+     * orders at once. Orders stay on the book until they are filled or
+     * cancelled.
+     *
+     * Posting an order sets its goods aside: the full price of a bid is taken
+     * from the buyer, and the resources of an ask are moved onto the
+     * seller's TransportNetwork with TransportNetwork::startTrading(). The
+     * amount of each resource a player can have for sale is limited by their
+     * merchant marine.
+     *
+     * match() is run once at the end of every game turn. Each resource is
+     * matched with price-time priority: the highest bid meets the lowest
+     * ask, and the older of two orders at the same price goes first. A trade
+     * happens at the price of whichever of the two orders was posted first.
+     * Players never trade with themselves, or with a player that either of
+     * them is boycotting.
+     */
+    class Market {
+        public:
+            /**
+             * Constructs an empty Market for the resources of the given Mod.
+             *
+             * @param mod - The Mod that holds the resource types.
+             */
+            Market(const Mod & mod);
+
+            /**
+             * Posts an order to buy a resource. The full price is taken from
+             * the player now, and whatever is not spent is given back.
+             *
+             * @param player - The player that is buying.
+             * @param resource - The resource to buy.
+             * @param amount - The most units to buy.
+             * @param price - The most to pay for each unit.
+             *
+             * @return true if the order was posted; false if the player can
+             * not afford it or already has too many orders.
+             */
+            bool bid(Player & player, const Resource * resource, int amount,
+                int price);
+
+            /**
+             * Posts an order to sell a resource. The resources are taken from
+             * the player now, and given back if the order is cancelled.
+             *
+             * @param player - The player that is selling.
+             * @param resource - The resource to sell.
+             * @param amount - The most units to sell.
+             * @param price - The least to be paid for each unit.
+             *
+             * @return true if the order was posted; false if the player does
+             * not have the resources, lacks the merchant marine to ship them,
+             * or already has too many orders.
+             */
+            bool ask(Player & player, const Resource * resource, int amount,
+                int price);
+
+            /**
+             * Cancels all of a player's orders for a resource, and gives back
+             * what they had set aside.
+             *
+             * @param player - The player whose orders to cancel.
+             * @param resource - The resource to cancel the orders for.
+             */
+            void cancel(Player & player, const Resource * resource);
+
+            /**
+             * Cancels all of a player's orders. This should be done before
+             * the player leaves the game.
+             *
+             * @param player - The player whose orders to cancel.
+             */
+            void cancel(Player & player);
+
+            /**
+             * @param player - The player to check.
+             *
+             * @return The number of orders that the player has on the book.
+             */
+            int getOrders(const Player & player) const;
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The price of the last trade of the resource, or -1 if
+             * it has never been traded.
+             */
+            int getPrice(const Resource * resource) const;
+
+            /**
+             * Matches the bids and asks of every resource, and settles the
+             * trades between the players.
+             *
+             * @param game - The game that the players are in.
+             *
+             * @return The total units of resources traded.
+             */
+            int match(Game & game);
+
+        private:
+            struct Order {
+                int mPlayer;
+                int mAmount;
+                int mPrice;
+                unsigned mTime;
+            };
+
+            struct Book {
+                std::vector<Order> mBids;
+                std::vector<Order> mAsks;
+                int mPrice;
+            };
+
+            static bool higherPrice(const Order & a, const Order & b);
+            static bool lowerPrice(const Order & a, const Order & b);
+            static bool isFilled(const Order & order);
+
+            Book * find(const Resource * resource);
+            void post(std::vector<Order> & orders, const Player & player,
+                int amount, int price);
+
+            const Mod & mMod;
+            std::vector<const Resource *> mResources;
+            std::vector<Book> mBooks;
+            std::map<const Resource *, unsigned> mIndex;
+            std::map<int, int> mOrders;
+            unsigned mTime;
+    };
+
+}
+
+#endif // MARKET_HPP_INCLUDED
@@ -17,11 +17,29 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <libconfig.h++>
+
+#include <SFML/System/Thread.hpp>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
 #include "engine/App.hpp"
+#include "AssetLoader.hpp"
+#include "Atlas.hpp"
 #include "Date.hpp"
+#include "Hash.hpp"
+#include "ImageCache.hpp"
 #include "Labor.hpp"
 #include "MerchantMarine.hpp"
 #include "Mod.hpp"
+#include "ModBundle.hpp"
 #include "Money.hpp"
 #include "Nation.hpp"
 #include "ProductionCenterType.hpp"
@@ -36,12 +54,200 @@
 
 using namespace Aftermath;
 
+#define ATLAS_FILE "atlas"
+#define DATA_DIR "/data/"
 #define FONT_DIR "/fonts/"
 #define IMAGE_DIR "/images/"
 #define MOD_IMAGE "icon.png"
+#define BUNDLE_FILE "mod.bundle"
+#define MOD_FILE "mod.cfg"
+#define RESOURCE_FILE "resources.cfg"
+#define TECHNOLOGY_FILE "technology.cfg"
+#define TERRAIN_FILE "terrains.cfg"
+
+// One data file of a mod. Each is parsed on its own thread into plain
+// definitions; the types are built from them afterwards, in one pass, so
+// that files can name each other's types in any order.
+class Mod::Source {
+    public:
+        // What a file defines
+        enum Kind { MOD, RESOURCES, TECHNOLOGY, TERRAIN };
+
+        // One entry of the file
+        struct Definition {
+            std::string name;
+            std::string description;
+            std::string image;
+            unsigned line;
+            // The names of other types, with an amount for each
+            std::vector<std::string> references;
+            std::vector<int> amounts;
+            // Terrain only
+            bool land, sea, revealed;
+            int moveCost;
+        };
+
+        Source(enum Kind kind, const std::string & directory,
+            const char * file, const char * list) : mKind(kind),
+            mPath(directory + DATA_DIR + file), mList(list), mStartDate(0),
+            mDatePerTurn(1), mMaxBids(0) {}
+
+        // Parses the file
+        void run() {
+            libconfig::Config config;
+            try {
+                config.readFile(mPath.c_str());
+                libconfig::Setting & list = config.lookup(mList);
+                if (mKind == MOD) {
+                    readMod(list);
+                    return;
+                }
+                int i;
+                for (i = 0; i < list.getLength(); ++i) read(list[i]);
+            } catch (libconfig::FileIOException & e) {
+                error(0, "could not read file");
+            } catch (libconfig::ParseException & e) {
+                error(e.getLine(), e.getError());
+            } catch (libconfig::SettingException & e) {
+                error(0, std::string("bad setting: ") + e.getPath());
+            }
+        }
+
+        // Records an error at the given line of the file, or 0 if unknown
+        void error(unsigned line, const std::string & message) {
+            std::ostringstream out;
+            out << mPath << ":";
+            if (line > 0) out << line << ":";
+            out << " " << message;
+            mErrors.push_back(out.str());
+        }
+
+        enum Kind mKind;
+        std::string mPath;
+        std::string mList;
+        std::vector<Definition> mDefinitions;
+        std::vector<std::string> mErrors;
+        // mod.cfg only
+        int mStartDate;
+        int mDatePerTurn;
+        int mMaxBids;
+
+    private:
+        void readMod(const libconfig::Setting & mod) {
+            Definition definition;
+            definition.line = mod.getSourceLine();
+            mod.lookupValue("name", definition.name);
+            mod.lookupValue("description", definition.description);
+            mod.lookupValue("image", definition.image);
+            if (mod.exists("date")) {
+                mod["date"].lookupValue("start", mStartDate);
+                mod["date"].lookupValue("per_turn", mDatePerTurn);
+            }
+            mod.lookupValue("max_bids", mMaxBids);
+            mDefinitions.push_back(definition);
+        }
+
+        void read(const libconfig::Setting & entry) {
+            Definition definition;
+            definition.line = entry.getSourceLine();
+            definition.land = true;
+            definition.sea = false;
+            definition.revealed = true;
+            definition.moveCost = 1;
+            if (!entry.isGroup() || !entry.lookupValue("name",
+                    definition.name)) {
+                error(definition.line, "definition has no name");
+                return;
+            }
+            entry.lookupValue("description", definition.description);
+            entry.lookupValue("image", definition.image);
+            int i;
+            if (mKind == TECHNOLOGY && entry.exists("requires")) {
+                libconfig::Setting & requires = entry["requires"];
+                for (i = 0; i < requires.getLength(); ++i) {
+                    definition.references.push_back(
+                        (const char *) requires[i]);
+                    definition.amounts.push_back(1);
+                }
+            } else if (mKind == TERRAIN) {
+                entry.lookupValue("land", definition.land);
+                entry.lookupValue("sea", definition.sea);
+                entry.lookupValue("revealed", definition.revealed);
+                entry.lookupValue("move_cost", definition.moveCost);
+                if (entry.exists("resources")) {
+                    libconfig::Setting & resources = entry["resources"];
+                    for (i = 0; i < resources.getLength(); ++i) {
+                        std::string name;
+                        int percentage = 0;
+                        if (!resources[i].lookupValue("name", name)) {
+                            error(resources[i].getSourceLine(),
+                                "resource has no name");
+                            continue;
+                        }
+                        resources[i].lookupValue("percentage", percentage);
+                        definition.references.push_back(name);
+                        definition.amounts.push_back(percentage);
+                    }
+                }
+            }
+            mDefinitions.push_back(definition);
+        }
+};
+
+// Gets the paths of the data files, in the order that they are loaded
+static std::vector<std::string> findDataFiles(const std::string & directory) {
+    std::vector<std::string> paths;
+    paths.push_back(directory + DATA_DIR + MOD_FILE);
+    paths.push_back(directory + DATA_DIR + RESOURCE_FILE);
+    paths.push_back(directory + DATA_DIR + TECHNOLOGY_FILE);
+    paths.push_back(directory + DATA_DIR + TERRAIN_FILE);
+    return paths;
+}
+
+// Finds the types that a reloaded file no longer defines
+template <typename T>
+static void findRemoved(const std::map<std::string, const T *> & types,
+        const std::set<std::string> & defined,
+        std::vector<std::string> & removed) {
+    typename std::map<std::string, const T *>::const_iterator itr;
+    for (itr = types.begin(); itr != types.end(); ++itr)
+        if (defined.count(itr->first) == 0) removed.push_back(itr->first);
+}
+
+// Loaded types, sorted by the hashes of their names, for resolving the
+// names that one file uses for the types of another
+template <typename T>
+class NameIndex {
+    public:
+        NameIndex(const std::map<std::string, const T *> & types) {
+            typename std::map<std::string, const T *>::const_iterator itr;
+            for (itr = types.begin(); itr != types.end(); ++itr)
+                mTypes.push_back(std::make_pair(Hash::string(itr->first),
+                    itr->second));
+            std::sort(mTypes.begin(), mTypes.end());
+        }
+
+        const T * find(const std::string & name) const {
+            typename std::vector<std::pair<Hash::Value, const T *> >::
+                const_iterator itr;
+            Hash::Value hash = Hash::string(name);
+            itr = std::lower_bound(mTypes.begin(), mTypes.end(),
+                std::make_pair(hash, (const T *) NULL));
+            for (; itr != mTypes.end() && itr->first == hash; ++itr)
+                if (itr->second->getName() == name) return itr->second;
+            return NULL;
+        }
+
+    private:
+        std::vector<std::pair<Hash::Value, const T *> > mTypes;
+};
 
 Mod::Mod(Engine::App & app) : NamedType("", "", ""), mApp(app),
-        mLoaded(false) {
+        mLoaded(false), mContent(0), mDate(NULL), mLabor(NULL),
+        mMerchantMarine(NULL), mMoney(NULL), mTransportCapacity(NULL),
+        mAssets(new AssetLoader()), mAtlas(new Atlas()), mImageKey(0),
+        mImages(new ImageCache(*mAssets)), mMaxBids(0), mStartDate(0),
+        mDatePerTurn(1), mTerrainVersion(0) {
     mApp.getLogger() << "Mod constructed" << std::endl;
 }
 
@@ -67,17 +273,125 @@ Mod::~Mod() {
     DELETE_EACH(const TileAction, mTileActions);
     DELETE_EACH(const UnitType, mUnitTypes);
     DELETE_EACH(const WorkerType, mWorkerTypes);
-    DELETE_EACH(sf::Image, mImages);
     DELETE_EACH(sf::Font, mFonts);
 
     #undef DELETE_EACH
+
+    mApp.getLogger() << "Image cache: " << mImages->getHits() << " hits, "
+                     << mImages->getMisses() << " misses, "
+                     << mImages->getEvictions() << " evictions" << std::endl;
+    delete mImages;
+    delete mAtlas;
+    delete mAssets;
 }
 
 bool Mod::load(const std::string & path) {
     mApp.getLogger() << "Loading mod: '" << path << "'" << std::endl;
     mDirectory = path;
-    // TODO
-    return false;
+    std::vector<Source *> sources;
+    sources.push_back(new Source(Source::MOD, path, MOD_FILE, "mod"));
+    sources.push_back(new Source(Source::RESOURCES, path, RESOURCE_FILE,
+        "resources"));
+    sources.push_back(new Source(Source::TECHNOLOGY, path, TECHNOLOGY_FILE,
+        "technology"));
+    sources.push_back(new Source(Source::TERRAIN, path, TERRAIN_FILE,
+        "terrains"));
+    unsigned i;
+
+    // Use the compiled bundle, if it was made from these files
+    mContent = ModBundle::hashFiles(findDataFiles(path));
+    ModBundle bundle;
+    if (bundle.open(path + DATA_DIR + BUNDLE_FILE, mContent)) {
+        for (i = 0; i < sources.size(); ++i) delete sources[i];
+        loadBundle(bundle);
+        mApp.getLogger() << "Mod loaded from bundle" << std::endl;
+        mLoaded = true;
+        return true;
+    }
+
+    // Parse every file at once
+    std::vector<sf::Thread *> threads;
+    for (i = 0; i < sources.size(); ++i) {
+        threads.push_back(new sf::Thread(&runSource, sources[i]));
+        threads.back()->Launch();
+    }
+    for (i = 0; i < threads.size(); ++i) {
+        threads[i]->Wait();
+        delete threads[i];
+    }
+
+    // Build the types, with the ones that others refer to first
+    loadMod(*sources[0]);
+    loadResources(*sources[1]);
+    loadTechnology(*sources[2]);
+    loadTerrain(*sources[3]);
+
+    bool loaded = true;
+    for (i = 0; i < sources.size(); ++i) {
+        std::vector<std::string>::const_iterator error;
+        for (error = sources[i]->mErrors.begin();
+                error != sources[i]->mErrors.end(); ++error) {
+            mApp.getLogger() << "Error: " << *error << std::endl;
+            loaded = false;
+        }
+        delete sources[i];
+    }
+    if (loaded)
+        mApp.getLogger() << "Mod loaded: " << mResources.size()
+                         << " resources, " << mTechTree.size()
+                         << " technologies, " << mTerrain.size()
+                         << " terrains" << std::endl;
+    mLoaded = loaded;
+    return loaded;
+}
+
+bool Mod::compile() const {
+    if (!mLoaded) return false;
+    std::string path = mDirectory + DATA_DIR + BUNDLE_FILE;
+    bool written = ModBundle::write(path, mContent, *this);
+    if (written)
+        mApp.getLogger() << "Mod compiled: '" << path << "'" << std::endl;
+    else mApp.getLogger() << "Error compiling mod: '" << path << "'"
+                          << std::endl;
+    return written;
+}
+
+bool Mod::reload(const std::string & path) {
+    std::string images = mDirectory + IMAGE_DIR;
+    if (path.compare(0, images.size(), images) == 0)
+        return reloadImage(path.substr(images.size()));
+    Source * source = NULL;
+    if (path == mDirectory + DATA_DIR + MOD_FILE)
+        source = new Source(Source::MOD, mDirectory, MOD_FILE, "mod");
+    else if (path == mDirectory + DATA_DIR + RESOURCE_FILE)
+        source = new Source(Source::RESOURCES, mDirectory, RESOURCE_FILE,
+            "resources");
+    else if (path == mDirectory + DATA_DIR + TECHNOLOGY_FILE)
+        source = new Source(Source::TECHNOLOGY, mDirectory, TECHNOLOGY_FILE,
+            "technology");
+    else if (path == mDirectory + DATA_DIR + TERRAIN_FILE)
+        source = new Source(Source::TERRAIN, mDirectory, TERRAIN_FILE,
+            "terrains");
+    else return false;
+
+    // Leave the types alone if the file does not parse
+    source->run();
+    bool parsed = source->mErrors.empty();
+    if (parsed) reloadData(*source);
+    std::vector<std::string>::const_iterator error;
+    for (error = source->mErrors.begin(); error != source->mErrors.end();
+            ++error)
+        mApp.getLogger() << "Error: " << *error << std::endl;
+    bool reloaded = source->mErrors.empty();
+    delete source;
+    if (parsed) mContent = ModBundle::hashFiles(findDataFiles(mDirectory));
+    mApp.getLogger() << (reloaded ? "Reloaded: '" : "Error reloading: '")
+                     << path << "'" << std::endl;
+    return reloaded;
+}
+
+unsigned Mod::getTerrainVersion() const {
+    return mTerrainVersion;
 }
 
 const Date * Mod::getDate() const {
@@ -122,6 +436,10 @@ const std::map<std::string, const Technology *> & Mod::getTechnology() const {
     return mTechnology;
 }
 
+const TechTree & Mod::getTechTree() const {
+    return mTechTree;
+}
+
 const std::map<std::string, const Terrain *> & Mod::getTerrain() const {
     return mTerrain;
 }
@@ -156,22 +474,142 @@ int Mod::getDatePerTurn() const {
     return mDatePerTurn;
 }
 
+// A sprite that keeps its image in the graphics cache until it is deleted
+class CachedSprite : public sf::Sprite {
+    public:
+        CachedSprite(ImageCache & cache, sf::Image & image) :
+            sf::Sprite(image), mCache(cache), mImage(&image) {}
+
+        ~CachedSprite() {
+            mCache.release(mImage);
+        }
+
+    private:
+        ImageCache & mCache;
+        const sf::Image * mImage;
+};
+
 sf::Image * Mod::getImage(const std::string & imagePath) {
-    sf::Image * img = mImages[imagePath];
-    if (img == NULL) {
-        img = new sf::Image();
-        if(img->LoadFromFile(mDirectory + IMAGE_DIR + imagePath))
+    std::string path = mDirectory + IMAGE_DIR + imagePath;
+    bool cached = mImages->contains(path);
+    sf::Image * img = mImages->acquire(path);
+    if (!cached) {
+        if (!mImages->isFailed(path))
              mApp.getLogger() << "Image loaded: '" << imagePath << "'"
                               << std::endl;
         else mApp.getLogger() << "Error loading image: '" << imagePath << "'"
                               << std::endl;
-        mImages[imagePath] = img;
     }
     return img;
 }
 
+void Mod::releaseImage(const sf::Image * image) {
+    mImages->release(image);
+}
+
 sf::Sprite * Mod::newSprite(const std::string & imagePath) {
-    return new sf::Sprite(*getImage(imagePath));
+    sf::Sprite * sprite = mAtlas->newSprite(imagePath);
+    if (sprite != NULL) return sprite;
+    return new CachedSprite(*mImages, *getImage(imagePath));
+}
+
+// Adds the paths of the files under a directory, and its subdirectories. The
+// directory's path ends with a slash.
+static void findFiles(const std::string & directory,
+        std::vector<std::string> & paths) {
+    DIR * dir = opendir(directory.c_str());
+    if (dir == NULL) return;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        std::string path = directory + name;
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0) continue;
+        if (S_ISDIR(status.st_mode)) findFiles(path + "/", paths);
+        else paths.push_back(path);
+    }
+    closedir(dir);
+}
+
+// Identifies a set of image files by their paths, sizes and modification
+// times, which is enough to tell when an atlas is out of date
+static Hash::Value hashImages(const std::vector<std::string> & paths) {
+    Hash::Value hash = Hash::string("");
+    std::vector<std::string>::const_iterator path;
+    for (path = paths.begin(); path != paths.end(); ++path) {
+        struct stat status;
+        if (stat(path->c_str(), &status) != 0) continue;
+        hash = Hash::combine(hash, Hash::string(*path));
+        hash = Hash::combine(hash, status.st_size);
+        hash = Hash::combine(hash, status.st_mtime);
+    }
+    return hash;
+}
+
+unsigned Mod::preloadImages() {
+    std::string root = mDirectory + IMAGE_DIR;
+    std::vector<std::string> paths;
+    findFiles(root, paths);
+    std::sort(paths.begin(), paths.end());
+    mImageKey = hashImages(paths);
+    mUnpacked.clear();
+    bool cached = mAtlas->load(mDirectory + DATA_DIR + ATLAS_FILE,
+        mImageKey);
+    mImages->setReserved(mAtlas->getBytes());
+    if (cached)
+        mApp.getLogger() << "Image atlas loaded: " << mAtlas->getPageCount()
+                         << " pages" << std::endl;
+    std::vector<std::string>::const_iterator path;
+    for (path = paths.begin(); path != paths.end(); ++path) {
+        std::string imagePath = path->substr(root.size());
+        if (cached && mAtlas->find(imagePath) != NULL) continue;
+        mImages->preload(*path);
+        if (!cached) mUnpacked.push_back(imagePath);
+    }
+    mApp.getLogger() << "Preloading images: " << paths.size() << std::endl;
+    return paths.size();
+}
+
+void Mod::packImages() {
+    // Decoded images count towards the budget, even if nothing wants them
+    mImages->update();
+    if (mUnpacked.empty()) return;
+    std::vector<const sf::Image *> images;
+    std::vector<std::string>::const_iterator imagePath;
+    for (imagePath = mUnpacked.begin(); imagePath != mUnpacked.end();
+            ++imagePath) {
+        images.push_back(getImage(*imagePath));
+        if (images.back()->GetWidth() > 0)
+            mAtlas->add(*imagePath, *images.back());
+    }
+    mUnpacked.clear();
+    mAtlas->pack();
+    mImages->setReserved(mAtlas->getBytes());
+    // The atlas has its own copies now
+    std::vector<const sf::Image *>::const_iterator image;
+    for (image = images.begin(); image != images.end(); ++image)
+        releaseImage(*image);
+    if (mAtlas->save(mDirectory + DATA_DIR + ATLAS_FILE, mImageKey))
+         mApp.getLogger() << "Image atlas packed: " << mAtlas->getPageCount()
+                          << " pages" << std::endl;
+    else mApp.getLogger() << "Error saving image atlas" << std::endl;
+}
+
+const AssetLoader & Mod::getAssets() const {
+    return *mAssets;
+}
+
+const Atlas & Mod::getAtlas() const {
+    return *mAtlas;
+}
+
+const ImageCache & Mod::getImageCache() const {
+    return *mImages;
+}
+
+void Mod::setImageBudget(std::size_t bytes) {
+    mImages->setBudget(bytes);
 }
 
 sf::Text * Mod::newText(const std::string & string, const std::string &
@@ -190,3 +628,295 @@ sf::Text * Mod::newText(const std::string & string, const std::string &
     text->SetColor(color);
     return text;
 }
+
+// Entry point of the loading threads
+void Mod::runSource(Source * source) {
+    source->run();
+}
+
+// Reads the mod's own name and settings
+void Mod::loadMod(Source & source) {
+    if (source.mDefinitions.empty()) return;
+    const Source::Definition & mod = source.mDefinitions.front();
+    setName(mod.name);
+    setDescription(mod.description);
+    setImage(mod.image);
+    mStartDate = source.mStartDate;
+    mDatePerTurn = source.mDatePerTurn;
+    mMaxBids = source.mMaxBids;
+}
+
+void Mod::loadResources(Source & source) {
+    std::vector<Source::Definition>::const_iterator itr;
+    for (itr = source.mDefinitions.begin();
+            itr != source.mDefinitions.end(); ++itr) {
+        if (mResources.count(itr->name) > 0) {
+            source.error(itr->line, "duplicate resource '" + itr->name +
+                "'");
+            continue;
+        }
+        mResources[itr->name] = new Resource(itr->name, itr->description,
+            itr->image);
+    }
+}
+
+// Adds every technology to the tech tree after its prerequisites
+void Mod::loadTechnology(Source & source) {
+    std::vector<Technology *> pending;
+    std::vector<const Source::Definition *> definitions;
+    std::vector<Source::Definition>::const_iterator itr;
+    for (itr = source.mDefinitions.begin();
+            itr != source.mDefinitions.end(); ++itr) {
+        if (mTechnology.count(itr->name) > 0) {
+            source.error(itr->line, "duplicate technology '" + itr->name +
+                "'");
+            continue;
+        }
+        Technology * technology = new Technology(itr->name,
+            itr->description, itr->image);
+        mTechnology[itr->name] = technology;
+        pending.push_back(technology);
+        definitions.push_back(&*itr);
+    }
+
+    NameIndex<Technology> index(mTechnology);
+    std::vector<std::vector<const Technology *> >
+        prerequisites(pending.size());
+    unsigned i, j;
+    for (i = 0; i < pending.size(); ++i) {
+        const Source::Definition & definition = *definitions[i];
+        for (j = 0; j < definition.references.size(); ++j) {
+            const Technology * required =
+                index.find(definition.references[j]);
+            if (required == NULL)
+                source.error(definition.line, "unknown technology '" +
+                    definition.references[j] + "'");
+            else prerequisites[i].push_back(required);
+        }
+    }
+
+    // Keep adding whatever is ready until nothing is left
+    bool added = true;
+    while (!pending.empty() && added) {
+        added = false;
+        unsigned kept = 0;
+        for (i = 0; i < pending.size(); ++i) {
+            if (mTechTree.add(pending[i], prerequisites[i])) {
+                added = true;
+            } else {
+                pending[kept] = pending[i];
+                prerequisites[kept] = prerequisites[i];
+                definitions[kept] = definitions[i];
+                ++kept;
+            }
+        }
+        pending.resize(kept);
+        prerequisites.resize(kept);
+        definitions.resize(kept);
+    }
+    for (i = 0; i < pending.size(); ++i)
+        source.error(definitions[i]->line, "technology '" +
+            pending[i]->getName() + "' depends on a prerequisite cycle");
+}
+
+void Mod::loadTerrain(Source & source) {
+    NameIndex<Resource> index(mResources);
+    std::vector<Source::Definition>::const_iterator itr;
+    for (itr = source.mDefinitions.begin();
+            itr != source.mDefinitions.end(); ++itr) {
+        if (mTerrain.count(itr->name) > 0) {
+            source.error(itr->line, "duplicate terrain '" + itr->name + "'");
+            continue;
+        }
+        std::map<const Resource *, float> * probabilities =
+            new std::map<const Resource *, float>();
+        unsigned i;
+        for (i = 0; i < itr->references.size(); ++i) {
+            const Resource * resource = index.find(itr->references[i]);
+            if (resource == NULL)
+                source.error(itr->line, "unknown resource '" +
+                    itr->references[i] + "'");
+            else (*probabilities)[resource] = itr->amounts[i] / 100.0f;
+        }
+        mTerrain[itr->name] = new Terrain(itr->name, itr->description,
+            itr->land, itr->sea, itr->image, probabilities, itr->revealed,
+            itr->moveCost);
+    }
+}
+
+// Patches the types of a data file that has changed. The types are updated
+// in place, since the game holds pointers to them.
+void Mod::reloadData(Source & source) {
+    if (source.mKind == Source::MOD) {
+        loadMod(source);
+        return;
+    }
+    std::set<std::string> defined;
+    std::vector<std::string> removed;
+    std::vector<Source::Definition>::const_iterator itr;
+    for (itr = source.mDefinitions.begin();
+            itr != source.mDefinitions.end(); ++itr) {
+        if (!defined.insert(itr->name).second) {
+            source.error(itr->line, "duplicate '" + itr->name + "'");
+            continue;
+        }
+        if (source.mKind == Source::RESOURCES) {
+            Resource * resource = new Resource(itr->name, itr->description,
+                itr->image);
+            std::map<std::string, const Resource *>::iterator found;
+            found = mResources.find(itr->name);
+            if (found == mResources.end()) {
+                mResources[itr->name] = resource;
+                continue;
+            }
+            const_cast<Resource *>(found->second)->update(*resource);
+            delete resource;
+        } else if (source.mKind == Source::TECHNOLOGY) {
+            std::map<std::string, const Technology *>::iterator found;
+            found = mTechnology.find(itr->name);
+            if (found == mTechnology.end()) {
+                source.error(itr->line, "adding technology '" + itr->name +
+                    "' takes a restart");
+                continue;
+            }
+            // Players' masks are built on the tree as it was loaded
+            TechTree::Mask required;
+            unsigned i;
+            for (i = 0; i < itr->references.size(); ++i) {
+                std::map<std::string, const Technology *>::const_iterator
+                    prerequisite = mTechnology.find(itr->references[i]);
+                if (prerequisite == mTechnology.end())
+                    source.error(itr->line, "unknown technology '" +
+                        itr->references[i] + "'");
+                else TechTree::set(required, prerequisite->second->getId());
+            }
+            const TechTree::Mask & current =
+                mTechTree.getPrerequisites(found->second);
+            if (!TechTree::contains(current, required) ||
+                !TechTree::contains(required, current))
+                source.error(itr->line, "changing the prerequisites of '" +
+                    itr->name + "' takes a restart");
+            Technology technology(itr->name, itr->description, itr->image);
+            const_cast<Technology *>(found->second)->update(technology);
+        } else if (source.mKind == Source::TERRAIN) {
+            std::map<const Resource *, float> * probabilities =
+                new std::map<const Resource *, float>();
+            bool known = true;
+            unsigned i;
+            for (i = 0; i < itr->references.size(); ++i) {
+                std::map<std::string, const Resource *>::const_iterator
+                    resource = mResources.find(itr->references[i]);
+                if (resource == mResources.end()) {
+                    source.error(itr->line, "unknown resource '" +
+                        itr->references[i] + "'");
+                    known = false;
+                } else (*probabilities)[resource->second] =
+                    itr->amounts[i] / 100.0f;
+            }
+            // Leave the terrain alone rather than drop some of its resources
+            if (!known) {
+                delete probabilities;
+                continue;
+            }
+            Terrain * terrain = new Terrain(itr->name, itr->description,
+                itr->land, itr->sea, itr->image, probabilities,
+                itr->revealed, itr->moveCost);
+            std::map<std::string, const Terrain *>::iterator found;
+            found = mTerrain.find(itr->name);
+            if (found == mTerrain.end()) {
+                mTerrain[itr->name] = terrain;
+                continue;
+            }
+            const_cast<Terrain *>(found->second)->update(*terrain);
+            delete terrain;
+        }
+    }
+    // Move costs may have changed
+    if (source.mKind == Source::TERRAIN) ++mTerrainVersion;
+    if (source.mKind == Source::RESOURCES)
+        findRemoved(mResources, defined, removed);
+    else if (source.mKind == Source::TECHNOLOGY)
+        findRemoved(mTechnology, defined, removed);
+    else findRemoved(mTerrain, defined, removed);
+    std::vector<std::string>::const_iterator name;
+    for (name = removed.begin(); name != removed.end(); ++name)
+        source.error(0, "removing '" + *name + "' takes a restart");
+}
+
+// Decodes a changed image again, wherever it is loaded
+bool Mod::reloadImage(const std::string & imagePath) {
+    std::string path = mDirectory + IMAGE_DIR + imagePath;
+    bool reloaded = mImages->reload(path);
+    if (mAtlas->find(imagePath) != NULL) {
+        sf::Image image;
+        if (!image.LoadFromFile(path))
+            mApp.getLogger() << "Error loading image: '" << imagePath << "'"
+                             << std::endl;
+        else if (!mAtlas->update(imagePath, image))
+            mApp.getLogger() << "Error: '" << imagePath << "' changed size;"
+                             << " repacking the atlas takes a restart"
+                             << std::endl;
+        else reloaded = true;
+    }
+    if (reloaded)
+        mApp.getLogger() << "Image reloaded: '" << imagePath << "'"
+                         << std::endl;
+    return reloaded;
+}
+
+// Builds every type from a compiled bundle, whose ids are already resolved
+void Mod::loadBundle(const ModBundle & bundle) {
+    const ModBundle::Header & header = bundle.getHeader();
+    setName(bundle.getString(header.name));
+    setDescription(bundle.getString(header.description));
+    setImage(bundle.getString(header.image));
+    mStartDate = header.startDate;
+    mDatePerTurn = header.datePerTurn;
+    mMaxBids = header.maxBids;
+
+    unsigned i, j;
+    std::vector<const Resource *> resources;
+    for (i = 0; i < bundle.size(ModBundle::RESOURCES); ++i) {
+        const ModBundle::Type & type = bundle.get(ModBundle::RESOURCES, i);
+        Resource * resource = new Resource(bundle.getString(type.name),
+            bundle.getString(type.description),
+            bundle.getString(type.image));
+        mResources[resource->getName()] = resource;
+        resources.push_back(resource);
+    }
+
+    std::vector<const Technology *> technology;
+    for (i = 0; i < bundle.size(ModBundle::TECHNOLOGY); ++i) {
+        const ModBundle::Type & type = bundle.get(ModBundle::TECHNOLOGY, i);
+        Technology * tech = new Technology(bundle.getString(type.name),
+            bundle.getString(type.description),
+            bundle.getString(type.image));
+        std::vector<const Technology *> prerequisites;
+        for (j = 0; j < type.references; ++j) {
+            sf::Uint32 id = bundle.getReference(type, j).id;
+            if (id < technology.size())
+                prerequisites.push_back(technology[id]);
+        }
+        mTechnology[tech->getName()] = tech;
+        mTechTree.add(tech, prerequisites);
+        technology.push_back(tech);
+    }
+
+    for (i = 0; i < bundle.size(ModBundle::TERRAIN); ++i) {
+        const ModBundle::Type & type = bundle.get(ModBundle::TERRAIN, i);
+        std::map<const Resource *, float> * probabilities =
+            new std::map<const Resource *, float>();
+        for (j = 0; j < type.references; ++j) {
+            const ModBundle::Reference & reference =
+                bundle.getReference(type, j);
+            if (reference.id < resources.size())
+                (*probabilities)[resources[reference.id]] = reference.amount;
+        }
+        Terrain * terrain = new Terrain(bundle.getString(type.name),
+            bundle.getString(type.description),
+            type.flags & ModBundle::LAND, type.flags & ModBundle::SEA,
+            bundle.getString(type.image), probabilities,
+            type.flags & ModBundle::REVEALED, type.moveCost);
+        mTerrain[terrain->getName()] = terrain;
+    }
+}
@@ -20,8 +20,10 @@
 #ifndef MOD_HPP_INCLUDED
 #define MOD_HPP_INCLUDED
 
+#include <cstddef>
 #include <map>
 #include <string>
+#include <vector>
 
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Font.hpp>
@@ -30,10 +32,16 @@
 #include <SFML/Graphics/Text.hpp>
 
 #include "Count.hpp"
+#include "Hash.hpp"
 #include "NamedType.hpp"
+#include "TechTree.hpp"
 
-namespace Aftermath { class Date;
+namespace Aftermath { class AssetLoader;
+                      class Atlas;
+                      class ImageCache;
+                      class Date;
                       class Labor;
+                      class ModBundle;
                       class MerchantMarine;
                       class Money;
                       class Nation;
@@ -78,7 +86,13 @@ namespace Aftermath {
             ~Mod();
 
             /**
-             * Loads all assets from the given mod folder.
+             * Loads all assets from the given mod folder. The files in its
+             * "data" directory are parsed in parallel, then the types are
+             * built and the names they use for each other are resolved.
+             * Every error is logged with its file and line.
+             *
+             * If the folder holds a ModBundle compiled from the same data
+             * files, the types are built from it instead, with no parsing.
              *
              * @param path - The path to the root folder of the mod.
              *
@@ -86,6 +100,38 @@ namespace Aftermath {
              */
             bool load(const std::string & path);
 
+            /**
+             * Compiles this loaded mod into a ModBundle in its "data"
+             * directory, so that later loads can skip parsing.
+             *
+             * @return true if the bundle was written; false otherwise.
+             */
+            bool compile() const;
+
+            /**
+             * Reloads one file of this Mod that has changed. A data file is
+             * parsed again and its types are patched in place, since the
+             * game holds pointers to them. New resources and terrains are
+             * added, but removing a type, adding a technology or changing
+             * prerequisites takes a restart. A terrain that names an
+             * unknown resource is left as it was. An image is decoded again
+             * wherever it is loaded: in the graphics cache and in the atlas.
+             *
+             * @param path - The path of the file, starting with the path
+             * that the Mod was loaded from.
+             *
+             * @return true if the file was reloaded; false if it is not one
+             * of this Mod's files or could not be reloaded.
+             */
+            bool reload(const std::string & path);
+
+            /**
+             * @return A count of the times that terrains have been reloaded.
+             * Anything worked out from terrain move costs is out of date
+             * once this changes.
+             */
+            unsigned getTerrainVersion() const;
+
             /**
              * @return The single Date type of this Mod.
              */
@@ -146,6 +192,12 @@ namespace Aftermath {
             const std::map<std::string, const Technology *> &
                 getTechnology() const;
 
+            /**
+             * @return The prerequisites between the Technology types of this
+             * Mod.
+             */
+            const TechTree & getTechTree() const;
+
             /**
              * @return A map of all Terrain types in this Mod (indexed by
              * their names).
@@ -199,16 +251,29 @@ namespace Aftermath {
              * Searches for the image in this Mod's graphics cache. If the
              * image is not already in the cache, it is loaded from the given
              * path. The image is loaded from "<MOD_ROOT>/images/<imagePath>".
+             * If the image is still being preloaded, this waits for it.
              *
              * @param imagePath - The path of the image to load, relative to
              * the Mod's "images" directory.
              *
-             * @return A pointer to a new image from the given image path.
+             * @return A pointer to the image, which stays loaded until it is
+             * given to releaseImage().
              */
             sf::Image * getImage(const std::string & imagePath);
 
             /**
-             * Gets the image with getImage() and creates a new sprite.
+             * Lets the graphics cache free an image from getImage() once
+             * nothing else refers to it.
+             *
+             * @param image - The image.
+             */
+            void releaseImage(const sf::Image * image);
+
+            /**
+             * Creates a new sprite. If the image has been packed into the
+             * atlas, the sprite shows its part of an atlas page; otherwise,
+             * the image is gotten with getImage(), and released when the
+             * sprite is deleted.
              *
              * @param imagePath - The path of the image to load, relative to
              * the Mod's "images" directory.
@@ -217,6 +282,50 @@ namespace Aftermath {
              */
             sf::Sprite * newSprite(const std::string & imagePath);
 
+            /**
+             * Starts loading every image in the Mod's "images" directory in
+             * the background. getAssets() tells how far along it is. If the
+             * atlas saved by a previous run is up to date, it is loaded
+             * instead of the images that it holds. The images go into the
+             * graphics cache, and count towards its budget once decoded.
+             *
+             * @return The number of images found.
+             */
+            unsigned preloadImages();
+
+            /**
+             * Packs the preloaded images into the atlas and saves it to
+             * "<MOD_ROOT>/data/", waiting for any that are still loading.
+             * If the atlas was loaded from disk, this only counts the
+             * decoded images in the graphics cache.
+             */
+            void packImages();
+
+            /**
+             * @return The atlas of this Mod's small images.
+             */
+            const Atlas & getAtlas() const;
+
+            /**
+             * @return The graphics cache, which counts its hits, misses and
+             * evictions.
+             */
+            const ImageCache & getImageCache() const;
+
+            /**
+             * Limits the memory taken by images, counting the pages of the
+             * atlas.
+             *
+             * @param bytes - The budget of the graphics cache, or 0 for no
+             * limit.
+             */
+            void setImageBudget(std::size_t bytes);
+
+            /**
+             * @return The loader that decodes this Mod's images.
+             */
+            const AssetLoader & getAssets() const;
+
             /**
              * Searches for the font in this Mod's font cache. If the font is
              * not already in the cache, it is loaded from the given path. The
@@ -239,6 +348,7 @@ namespace Aftermath {
             Engine::App & mApp;
             bool mLoaded;
             std::string mDirectory;
+            Hash::Value mContent;
 
             const Date * mDate;
             const Labor * mLabor;
@@ -251,12 +361,17 @@ namespace Aftermath {
             std::map<std::string, const Resource *> mResources;
             std::map<std::string, const SpecialistType *> mSpecialistTypes;
             std::map<std::string, const Technology *> mTechnology;
+            TechTree mTechTree;
             std::map<std::string, const Terrain *> mTerrain;
             std::map<std::string, const TileAction *> mTileActions;
             std::map<std::string, const UnitType *> mUnitTypes;
             std::map<std::string, const WorkerType *> mWorkerTypes;
 
-            std::map<std::string, sf::Image *> mImages;
+            AssetLoader * mAssets;
+            Atlas * mAtlas;
+            Hash::Value mImageKey;
+            std::vector<std::string> mUnpacked;
+            ImageCache * mImages;
             std::map<std::string, sf::Font *> mFonts;
 
             Count<const Transferable *> mStartingTypes;
@@ -264,6 +379,18 @@ namespace Aftermath {
             int mMaxBids;
             int mStartDate;
             int mDatePerTurn;
+            unsigned mTerrainVersion;
+
+            class Source;
+
+            static void runSource(Source * source);
+            void loadBundle(const ModBundle & bundle);
+            void loadMod(Source & source);
+            void loadResources(Source & source);
+            void loadTechnology(Source & source);
+            void loadTerrain(Source & source);
+            void reloadData(Source & source);
+            bool reloadImage(const std::string & imagePath);
     };
 
 }
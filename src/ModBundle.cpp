@@ -0,0 +1,254 @@
+//      ModBundle.cpp -- A precompiled, memory mapped copy of a mod's data.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <fstream>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Mod.hpp"
+#include "ModBundle.hpp"
+#include "Resource.hpp"
+#include "Technology.hpp"
+#include "TechTree.hpp"
+#include "Terrain.hpp"
+
+using namespace Aftermath;
+
+#define MAGIC 0x424d4641UL // "AFMB", read in the native byte order
+#define VERSION 1
+
+ModBundle::ModBundle() : mData(NULL), mSize(0) {}
+
+ModBundle::~ModBundle() {
+    close();
+}
+
+bool ModBundle::open(const std::string & path, Hash::Value content) {
+    close();
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size < (off_t) sizeof(Header)) {
+        ::close(file);
+        return false;
+    }
+    void * data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED) return false;
+    mData = (const char *) data;
+    mSize = status.st_size;
+
+    // Check that every table lies inside the file
+    const Header & header = getHeader();
+    bool valid = header.magic == MAGIC && header.version == VERSION &&
+        header.content == content && header.size == mSize &&
+        header.strings <= mSize && header.stringSize > 0 &&
+        header.stringSize <= mSize - header.strings &&
+        mData[header.strings + header.stringSize - 1] == '\0' &&
+        header.references <= mSize && header.referenceCount <=
+            (mSize - header.references) / sizeof(Reference);
+    unsigned table, i;
+    for (table = 0; valid && table < TABLES; ++table) {
+        valid = header.tables[table] <= mSize && header.counts[table] <=
+            (mSize - header.tables[table]) / sizeof(Type);
+        for (i = 0; valid && i < header.counts[table]; ++i) {
+            const Type & type = get((enum Table) table, i);
+            valid = type.name < header.stringSize &&
+                type.description < header.stringSize &&
+                type.image < header.stringSize &&
+                type.firstReference <= header.referenceCount &&
+                type.references <= header.referenceCount -
+                    type.firstReference;
+        }
+    }
+    valid = valid && header.name < header.stringSize &&
+        header.description < header.stringSize &&
+        header.image < header.stringSize;
+    if (!valid) close();
+    return valid;
+}
+
+void ModBundle::close() {
+    if (mData != NULL) munmap((void *) mData, mSize);
+    mData = NULL;
+    mSize = 0;
+}
+
+const ModBundle::Header & ModBundle::getHeader() const {
+    return *(const Header *) mData;
+}
+
+unsigned ModBundle::size(enum Table table) const {
+    return getHeader().counts[table];
+}
+
+const ModBundle::Type & ModBundle::get(enum Table table, unsigned index)
+        const {
+    return ((const Type *) (mData + getHeader().tables[table]))[index];
+}
+
+const ModBundle::Reference & ModBundle::getReference(const Type & type,
+        unsigned index) const {
+    return ((const Reference *) (mData + getHeader().references))
+        [type.firstReference + index];
+}
+
+const char * ModBundle::getString(sf::Uint32 offset) const {
+    return mData + getHeader().strings + offset;
+}
+
+Hash::Value ModBundle::hashFiles(const std::vector<std::string> & paths) {
+    Hash::Value hash = Hash::string("");
+    std::vector<std::string>::const_iterator path;
+    for (path = paths.begin(); path != paths.end(); ++path) {
+        std::ifstream file(path->c_str(), std::ios::in | std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+        hash = Hash::combine(hash, Hash::string(*path));
+        hash = Hash::combine(hash, Hash::string(content));
+    }
+    return hash;
+}
+
+// Stores each distinct string once
+static sf::Uint32 intern(const std::string & string, std::string & strings,
+        std::map<std::string, sf::Uint32> & offsets) {
+    std::map<std::string, sf::Uint32>::iterator itr = offsets.find(string);
+    if (itr != offsets.end()) return itr->second;
+    sf::Uint32 offset = strings.size();
+    strings.append(string.c_str(), string.size() + 1);
+    offsets[string] = offset;
+    return offset;
+}
+
+// Fills in the names of a type
+static ModBundle::Type makeType(const NamedType & named, std::string &
+        strings, std::map<std::string, sf::Uint32> & offsets, sf::Uint32
+        firstReference) {
+    ModBundle::Type type;
+    type.name = intern(named.getName(), strings, offsets);
+    type.description = intern(named.getDescription(), strings, offsets);
+    type.image = intern(named.getImage(), strings, offsets);
+    type.firstReference = firstReference;
+    type.references = 0;
+    type.flags = 0;
+    type.moveCost = 0;
+    return type;
+}
+
+bool ModBundle::write(const std::string & path, Hash::Value content,
+        const Mod & mod) {
+    std::string strings;
+    std::map<std::string, sf::Uint32> offsets;
+    std::vector<Type> types[TABLES];
+    std::vector<Reference> references;
+    Reference reference;
+    intern("", strings, offsets);
+
+    // Resources, numbered in name order
+    std::map<const Resource *, sf::Uint32> resourceIds;
+    std::map<std::string, const Resource *>::const_iterator resource;
+    for (resource = mod.getResources().begin();
+            resource != mod.getResources().end(); ++resource) {
+        resourceIds[resource->second] = types[RESOURCES].size();
+        types[RESOURCES].push_back(makeType(*resource->second, strings,
+            offsets, references.size()));
+    }
+
+    // Technology, by id, so that prerequisites come first
+    const TechTree & tree = mod.getTechTree();
+    unsigned id, other;
+    for (id = 0; id < tree.size(); ++id) {
+        const Technology * technology = tree.get(id);
+        Type type = makeType(*technology, strings, offsets,
+            references.size());
+        for (other = 0; other < id; ++other) {
+            if (TechTree::test(tree.getPrerequisites(technology), other)) {
+                reference.id = other;
+                reference.amount = 1;
+                references.push_back(reference);
+                ++type.references;
+            }
+        }
+        types[TECHNOLOGY].push_back(type);
+    }
+
+    // Terrain, with ids of their resources
+    std::map<std::string, const Terrain *>::const_iterator terrain;
+    for (terrain = mod.getTerrain().begin();
+            terrain != mod.getTerrain().end(); ++terrain) {
+        const Terrain & t = *terrain->second;
+        Type type = makeType(t, strings, offsets, references.size());
+        type.flags = (t.isLandTerrain() ? LAND : 0) |
+                     (t.isSeaTerrain() ? SEA : 0) |
+                     (t.isRevealed() ? REVEALED : 0);
+        type.moveCost = t.getMoveCost();
+        Terrain::iterator chance;
+        for (chance = t.begin(); chance != t.end(); ++chance) {
+            reference.id = resourceIds[chance->first];
+            reference.amount = chance->second;
+            references.push_back(reference);
+            ++type.references;
+        }
+        types[TERRAIN].push_back(type);
+    }
+
+    // Lay out the file: header, tables, references, strings
+    Header header = Header();
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.content = content;
+    header.name = intern(mod.getName(), strings, offsets);
+    header.description = intern(mod.getDescription(), strings, offsets);
+    header.image = intern(((const NamedType &) mod).getImage(), strings,
+        offsets);
+    header.startDate = mod.getStartDate();
+    header.datePerTurn = mod.getDatePerTurn();
+    header.maxBids = mod.getMaxBids();
+    sf::Uint32 offset = sizeof(Header);
+    unsigned table;
+    for (table = 0; table < TABLES; ++table) {
+        header.tables[table] = offset;
+        header.counts[table] = types[table].size();
+        offset += types[table].size() * sizeof(Type);
+    }
+    header.references = offset;
+    header.referenceCount = references.size();
+    offset += references.size() * sizeof(Reference);
+    header.strings = offset;
+    header.stringSize = strings.size();
+    header.size = offset + strings.size();
+
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::binary |
+        std::ios::trunc);
+    file.write((const char *) &header, sizeof(Header));
+    for (table = 0; table < TABLES; ++table)
+        if (!types[table].empty())
+            file.write((const char *) &types[table][0],
+                types[table].size() * sizeof(Type));
+    if (!references.empty())
+        file.write((const char *) &references[0],
+            references.size() * sizeof(Reference));
+    file.write(strings.data(), strings.size());
+    return file.good();
+}
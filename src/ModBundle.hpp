@@ -0,0 +1,213 @@
+//      ModBundle.hpp -- A precompiled, memory mapped copy of a mod's data.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MODBUNDLE_HPP_INCLUDED
+#define MODBUNDLE_HPP_INCLUDED
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <SFML/Config.hpp>
+
+#include "Hash.hpp"
+
+namespace Aftermath { class Mod; }
+
+/**
+ * @file ModBundle.hpp
+ *
+ * A precompiled, memory mapped copy of a mod's data.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A ModBundle is the data of a Mod compiled into a single binary file.
+     * The file has flat tables of types, references between them given as
+     * ids, and one table of strings that each distinct string is stored in
+     * once. Opening a bundle maps the file into memory and checks it, so a
+     * Mod can be built from it without parsing any text.
+     *
+     * A bundle records the content hash of the data files it was compiled
+     * from. Mod::load() only uses a bundle whose hash matches the files on
+     * disk, and parses the text otherwise.
+     */
+    class ModBundle {
+        public:
+            /**
+             * The tables of types in a bundle.
+             */
+            enum Table {
+                RESOURCES,  /**< Resource types.                       */
+                TECHNOLOGY, /**< Technology, in TechTree id order.     */
+                TERRAIN,    /**< Terrain types.                        */
+                TABLES      /**< The number of tables.                 */
+            };
+
+            /**
+             * The flags of a Type.
+             */
+            enum Flag {
+                LAND     = 1, /**< The terrain is land.                */
+                SEA      = 2, /**< The terrain is sea.                 */
+                REVEALED = 4  /**< The terrain is revealed.            */
+            };
+
+            /**
+             * One type in a table. Strings are offsets into the string
+             * table. A technology's references are the ids of its
+             * prerequisites, and a terrain's are its resources.
+             */
+            struct Type {
+                sf::Uint32 name;
+                sf::Uint32 description;
+                sf::Uint32 image;
+                sf::Uint32 firstReference;
+                sf::Uint32 references;
+                sf::Uint32 flags;
+                sf::Int32 moveCost;
+            };
+
+            /**
+             * A reference from one type to another, by its index in the
+             * other's table.
+             */
+            struct Reference {
+                sf::Uint32 id;
+                float amount;
+            };
+
+            /**
+             * The start of a bundle file.
+             */
+            struct Header {
+                sf::Uint32 magic;
+                sf::Uint32 version;
+                Hash::Value content;
+                sf::Uint32 size;
+                sf::Uint32 name;
+                sf::Uint32 description;
+                sf::Uint32 image;
+                sf::Int32 startDate;
+                sf::Int32 datePerTurn;
+                sf::Int32 maxBids;
+                sf::Uint32 tables[TABLES];
+                sf::Uint32 counts[TABLES];
+                sf::Uint32 references;
+                sf::Uint32 referenceCount;
+                sf::Uint32 strings;
+                sf::Uint32 stringSize;
+            };
+
+            /**
+             * Constructs a bundle that is not open.
+             */
+            ModBundle();
+
+            /**
+             * Unmaps the bundle, if it is open.
+             */
+            ~ModBundle();
+
+            /**
+             * Maps a bundle file into memory and checks it.
+             *
+             * @param path - The path of the bundle file.
+             * @param content - The content hash of the data files that the
+             * bundle should have been compiled from.
+             *
+             * @return true if the bundle is open; false if the file is
+             * missing, damaged, or was compiled from other data.
+             */
+            bool open(const std::string & path, Hash::Value content);
+
+            /**
+             * Unmaps the bundle.
+             */
+            void close();
+
+            /**
+             * @return The header of the open bundle.
+             */
+            const Header & getHeader() const;
+
+            /**
+             * @param table - A table of types.
+             *
+             * @return The number of types in the table.
+             */
+            unsigned size(enum Table table) const;
+
+            /**
+             * @param table - A table of types.
+             * @param index - The index of a type in the table.
+             *
+             * @return The type.
+             */
+            const Type & get(enum Table table, unsigned index) const;
+
+            /**
+             * @param type - A type of this bundle.
+             * @param index - The index of one of the type's references.
+             *
+             * @return The reference.
+             */
+            const Reference & getReference(const Type & type,
+                unsigned index) const;
+
+            /**
+             * @param offset - An offset into the string table.
+             *
+             * @return The string at the offset.
+             */
+            const char * getString(sf::Uint32 offset) const;
+
+            /**
+             * Computes the content hash of a mod's data files.
+             *
+             * @param paths - The paths of the files, in a fixed order.
+             *
+             * @return The hash of the files' names and contents.
+             */
+            static Hash::Value hashFiles(const std::vector<std::string> &
+                paths);
+
+            /**
+             * Compiles a loaded Mod into a bundle file.
+             *
+             * @param path - The path of the bundle file to write.
+             * @param content - The content hash of the mod's data files.
+             * @param mod - The mod to compile.
+             *
+             * @return true if the file was written; false otherwise.
+             */
+            static bool write(const std::string & path, Hash::Value content,
+                const Mod & mod);
+
+        private:
+            const char * mData;
+            std::size_t mSize;
+    };
+
+}
+
+#endif // MODBUNDLE_HPP_INCLUDED
@@ -0,0 +1,111 @@
+//      ModWatcher.cpp -- Watches a mod's files for changes.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ModWatcher.hpp"
+
+using namespace Aftermath;
+
+// Enough for a few dozen events per read
+#define BUFFER_SIZE 4096
+
+ModWatcher::ModWatcher() : mDescriptor(-1) {}
+
+ModWatcher::~ModWatcher() {
+#ifdef __linux__
+    if (mDescriptor >= 0) close(mDescriptor);
+#endif
+}
+
+bool ModWatcher::watch(const std::string & directory) {
+#ifdef __linux__
+    if (mDescriptor < 0) mDescriptor = inotify_init1(IN_NONBLOCK);
+    if (mDescriptor < 0) return false;
+    add(directory);
+    return !mDirectories.empty();
+#else
+    return false;
+#endif
+}
+
+bool ModWatcher::isWatching() const {
+    return mDescriptor >= 0 && !mDirectories.empty();
+}
+
+void ModWatcher::poll(std::vector<std::string> & changed) {
+#ifdef __linux__
+    if (mDescriptor < 0) return;
+    char buffer[BUFFER_SIZE];
+    ssize_t length;
+    while ((length = read(mDescriptor, buffer, sizeof(buffer))) > 0) {
+        ssize_t offset = 0;
+        while (offset + (ssize_t) sizeof(inotify_event) <= length) {
+            // The buffer is not aligned for events, so copy each header out
+            inotify_event event;
+            memcpy(&event, buffer + offset, sizeof(event));
+            const char * name = buffer + offset + sizeof(event);
+            offset += sizeof(event) + event.len;
+            std::map<int, std::string>::const_iterator directory;
+            directory = mDirectories.find(event.wd);
+            if (directory == mDirectories.end() || event.len == 0)
+                continue;
+            std::string path = directory->second + name;
+            if (event.mask & IN_ISDIR) {
+                if (event.mask & (IN_CREATE | IN_MOVED_TO)) add(path);
+            } else if ((event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) &&
+                    std::find(changed.begin(), changed.end(), path) ==
+                    changed.end())
+                changed.push_back(path);
+        }
+    }
+#endif
+}
+
+// Watches a directory and everything under it
+void ModWatcher::add(const std::string & directory) {
+#ifdef __linux__
+    std::string path = directory;
+    if (path.empty() || path[path.size() - 1] != '/') path += "/";
+    int watch = inotify_add_watch(mDescriptor, path.c_str(), IN_CLOSE_WRITE |
+        IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+    if (watch < 0) return;
+    mDirectories[watch] = path;
+    DIR * dir = opendir(path.c_str());
+    if (dir == NULL) return;
+    struct dirent * entry;
+    while ((entry = readdir(dir)) != NULL) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        struct stat status;
+        if (stat((path + name).c_str(), &status) == 0 &&
+            S_ISDIR(status.st_mode))
+            add(path + name);
+    }
+    closedir(dir);
+#endif
+}
@@ -0,0 +1,92 @@
+//      ModWatcher.hpp -- Watches a mod's files for changes.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef MODWATCHER_HPP_INCLUDED
+#define MODWATCHER_HPP_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file ModWatcher.hpp
+ *
+ * Watches a mod's files for changes.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A ModWatcher notices when the files of a mod are written, so that a
+     * mod author can see a change without restarting. It watches a
+     * directory and every directory under it, including ones created
+     * later, and never blocks.
+     *
+     * Watching uses inotify, so it is only available on Linux; elsewhere,
+     * watch() fails and nothing is ever reported.
+     */
+    class ModWatcher {
+        public:
+            /**
+             * Constructs a new watcher that is not watching anything.
+             */
+            ModWatcher();
+
+            /**
+             * Stops watching.
+             */
+            ~ModWatcher();
+
+            /**
+             * Starts watching a directory and its subdirectories.
+             *
+             * @param directory - The path of the directory.
+             *
+             * @return true if the directory is being watched; false
+             * otherwise.
+             */
+            bool watch(const std::string & directory);
+
+            /**
+             * @return true if a directory is being watched; false
+             * otherwise.
+             */
+            bool isWatching() const;
+
+            /**
+             * Collects the files that have been written since the last
+             * poll. Each file is only reported once per poll.
+             *
+             * @param changed - Filled with the paths of the files.
+             */
+            void poll(std::vector<std::string> & changed);
+
+        private:
+            int mDescriptor;
+            // The watched directories by watch descriptor, ending in "/"
+            std::map<int, std::string> mDirectories;
+
+            void add(const std::string & directory);
+    };
+
+}
+
+#endif // MODWATCHER_HPP_INCLUDED
@@ -17,11 +17,35 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <map>
+#include <sstream>
+
 #include "Move.hpp"
 
 using namespace Aftermath;
 
+// The parsers of every registered type of move, indexed by name
+static std::map<std::string, Move::Parser> & getParsers() {
+    static std::map<std::string, Move::Parser> parsers;
+    return parsers;
+}
+
+Move::~Move() {}
+
+enum Phase Move::getPhase() const {
+    return ECONOMY_PHASE;
+}
+
 Move * Move::parse(const std::string & str) {
-    // TODO
-    return NULL;
+    std::istringstream in(str);
+    std::string name;
+    if (!(in >> name)) return NULL;
+    std::map<std::string, Parser>::const_iterator itr;
+    itr = getParsers().find(name);
+    if (itr == getParsers().end()) return NULL;
+    return itr->second(in);
+}
+
+void Move::registerType(const std::string & name, Parser parser) {
+    getParsers()[name] = parser;
 }
@@ -20,6 +20,7 @@
 #ifndef MOVE_HPP_INCLUDED
 #define MOVE_HPP_INCLUDED
 
+#include <istream>
 #include <string>
 
 namespace Aftermath { class Game; }
@@ -34,12 +35,33 @@ namespace Aftermath { class Game; }
 
 namespace Aftermath {
 
+    /**
+     * The phases of a simultaneous turn, in the order that they are played.
+     * See Game::resolveTurn().
+     */
+    enum Phase {
+        ECONOMY_PHASE,  /**< Production, trade, and upgrades. */
+        MOVEMENT_PHASE, /**< Units moving between TileGroups. */
+        COMBAT_PHASE    /**< Battles between units.           */
+    };
+
     /**
      * Move is an entirely abstract interface for defining a type of move that
      * can be applied to a Game.
+     *
+     * A serialized move is a single line of text that starts with the name
+     * of its type, followed by whatever the type needs to rebuild the move.
+     * Each type of move registers a parser for its name with registerType()
+     * so that parse() can turn the text back into a Move.
      */
     class Move {
         public:
+            /**
+             * A function that rebuilds a move from its serialized form. The
+             * stream is positioned just past the name of the move type.
+             */
+            typedef Move * (*Parser)(std::istream & in);
+
             /**
              * Virtual destructor for Move.
              */
@@ -63,6 +85,14 @@ namespace Aftermath {
              */
             virtual void apply(Game & game) const = 0;
 
+            /**
+             * Gets the phase of a simultaneous turn that this move is played
+             * in. Moves are economic unless they say otherwise.
+             *
+             * @return The phase of this move.
+             */
+            virtual enum Phase getPhase() const;
+
             /**
              * Serializes this move into a string representation suitable for
              * network transmission.
@@ -76,9 +106,20 @@ namespace Aftermath {
              *
              * @param str - The string to parse.
              *
-             * @return The newly parsed move.
+             * @return The newly parsed move, or NULL if the string does not
+             * name a registered type of move or could not be parsed.
              */
             static Move * parse(const std::string & str);
+
+            /**
+             * Registers a parser for a type of move. Every peer of a
+             * networked game must register the same types.
+             *
+             * @param name - The name that serialized moves of the type start
+             * with. This must not contain whitespace.
+             * @param parser - The function to rebuild moves of the type.
+             */
+            static void registerType(const std::string & name, Parser parser);
     };
 
 }
@@ -39,6 +39,11 @@ const std::string & NamedType::getImage() const {
     return mImage;
 }
 
+void NamedType::update(const NamedType & other) {
+    mDescription = other.mDescription;
+    mImage = other.mImage;
+}
+
 void NamedType::setName(const std::string & name) {
     mName = name;
 }
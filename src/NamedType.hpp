@@ -75,6 +75,15 @@ namespace Aftermath {
              */
             const std::string & getImage() const;
 
+            /**
+             * Takes the description and image of another type, as when the
+             * file that defines this type is reloaded. The name is kept,
+             * since it identifies the type.
+             *
+             * @param other - The new definition of this type.
+             */
+            void update(const NamedType & other);
+
         protected:
             /**
              * Sets the name of this type.
@@ -28,6 +28,6 @@ Navy::~Navy() {
     for (itr = begin(); itr != end(); ++itr) delete *itr;
 }
 
-bool Navy::canAdd(const TileGroupUnit *& unit) const {
+bool Navy::canAdd(TileGroupUnit * const & unit) const {
     return unit->getType().isSeaUnit();
 }
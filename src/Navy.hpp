@@ -20,7 +20,7 @@
 #ifndef NAVY_HPP_INCLUDED
 #define NAVY_HPP_INCLUDED
 
-#include "SelectiveCollection.hpp"
+#include "UnitCollection.hpp"
 
 namespace Aftermath { class TileGroupUnit; }
 
@@ -37,7 +37,7 @@ namespace Aftermath {
     /**
      * A Navy is a number of TileGroupUnits that travel on water.
      */
-    class Navy : public SelectiveCollection<TileGroupUnit *> {
+    class Navy : public UnitCollection {
         public:
             /**
              * Destructor for Navy. Frees all units.
@@ -50,7 +50,7 @@ namespace Aftermath {
              * @return true if UnitType::isSeaUnit() returns true,
              * false otherwise.
              */
-            bool canAdd(const TileGroupUnit *& unit) const;
+            bool canAdd(TileGroupUnit * const & unit) const;
     };
 
 }
@@ -0,0 +1,329 @@
+//      Pathfinder -- Finds routes for armies and navies.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+
+#include "AdjacencyGraph.hpp"
+#include "Game.hpp"
+#include "Mod.hpp"
+#include "Pathfinder.hpp"
+#include "Player.hpp"
+#include "Terrain.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
+#include "TileMap.hpp"
+#include "Treaty.hpp"
+#include "UnitType.hpp"
+
+using namespace Aftermath;
+
+// A cost higher than any route
+#define UNREACHED 1e30f
+
+// Units that move on the same terrain share routes
+static int getMask(const UnitType & type) {
+    return (type.isLandUnit() ? 1 : 0) | (type.isSeaUnit() ? 2 : 0);
+}
+
+Pathfinder::Pathfinder(const Game & game) : mGame(game), mGraph(NULL),
+    mVersion(0), mBorders(0), mTerrain(0), mMinCost(1.0f), mSearch(0) {}
+
+int Pathfinder::findRoute(const Player & player, const UnitType & type,
+        const TileGroup * from, const TileGroup * to,
+        std::vector<const TileGroup *> & route) {
+    connect();
+    route.clear();
+    int start = mGraph->find(from), goal = mGraph->find(to);
+    if (start < 0 || goal < 0) return -1;
+    const Route & found = search(player, type, start, goal);
+    std::vector<int>::const_iterator itr;
+    for (itr = found.mGroups.begin(); itr != found.mGroups.end(); ++itr)
+        route.push_back(mGraph->getGroup(*itr));
+    return found.mCost;
+}
+
+int Pathfinder::findPath(const Player & player, const UnitType & type,
+        unsigned from, unsigned to, std::vector<unsigned> & path) {
+    connect();
+    path.clear();
+    int start = mGraph->getTileGroup(from), goal = mGraph->getTileGroup(to);
+    if (start < 0 || goal < 0) return -1;
+    const Route & route = search(player, type, start, goal);
+    if (route.mCost < 0) return -1;
+
+    // Search the corridor along the route first
+    std::vector<bool> groups(mGraph->getGroupCount(), false);
+    std::vector<int>::const_iterator itr;
+    for (itr = route.mGroups.begin(); itr != route.mGroups.end(); ++itr)
+        groups[*itr] = true;
+    int cost = search(type, from, to, groups, path);
+    if (cost >= 0) return cost;
+
+    // The groups connect, but not through those tiles
+    groups = getAccess(player, type);
+    groups[start] = true;
+    return search(type, from, to, groups, path);
+}
+
+void Pathfinder::clear() {
+    mRoutes.clear();
+    mAccess.clear();
+}
+
+unsigned Pathfinder::getCacheSize() const {
+    return mRoutes.size();
+}
+
+// Finds the center and average cost of each group whenever the groups or
+// the terrains change
+void Pathfinder::connect() {
+    mGraph = &mGame.getAdjacency();
+    if (mGraph->getVersion() == mVersion &&
+            mGame.getMod().getTerrainVersion() == mTerrain) {
+        if (mGame.getBorders() != mBorders) refresh();
+        return;
+    }
+    mVersion = mGraph->getVersion();
+    mBorders = mGame.getBorders();
+    mTerrain = mGame.getMod().getTerrainVersion();
+    clear();
+    const TileMap & map = mGame.getMap();
+    unsigned groups = mGraph->getGroupCount(), group;
+    mRow.assign(groups, 0.0f);
+    mColumn.assign(groups, 0.0f);
+    mCost.assign(groups, 0.0f);
+    std::vector<int> tiles(groups, 0);
+    unsigned row, column;
+    for (row = 0; row < map.rows(); ++row) {
+        for (column = 0; column < map.columns(); ++column) {
+            int here = mGraph->getTileGroup(row * map.columns() + column);
+            if (here < 0) continue;
+            const Terrain * terrain = map(row, column).getTerrain();
+            mRow[here] += row;
+            mColumn[here] += column;
+            mCost[here] += terrain == NULL ? 1 : terrain->getMoveCost();
+            ++tiles[here];
+        }
+    }
+    mMinCost = UNREACHED;
+    for (group = 0; group < groups; ++group) {
+        if (tiles[group] == 0) continue;
+        mRow[group] /= tiles[group];
+        mColumn[group] /= tiles[group];
+        mCost[group] /= tiles[group];
+        mMinCost = std::min(mMinCost, mCost[group]);
+    }
+    if (mMinCost == UNREACHED) mMinCost = 1.0f;
+}
+
+// Finds the groups that each cached player can enter now. A group that opened
+// up may shorten any route of that player, so they are all dropped, while a
+// group that closed only breaks the routes through it.
+void Pathfinder::refresh() {
+    mBorders = mGame.getBorders();
+    std::map<Mover, std::vector<bool> >::iterator access = mAccess.begin();
+    while (access != mAccess.end()) {
+        const Player * player = mGame.getPlayer(access->first.first);
+        std::vector<bool> & groups = access->second;
+        std::vector<bool> closed(groups.size(), false);
+        bool opened = player == NULL, changed = false;
+        unsigned group;
+        for (group = 0; group < groups.size(); ++group) {
+            bool enter = player != NULL &&
+                canEnter(*player, access->first.second, group);
+            if (enter == groups[group]) continue;
+            opened = opened || enter;
+            closed[group] = !enter;
+            changed = true;
+            groups[group] = enter;
+        }
+
+        // Keys sort by player and mask first, and groups are never negative
+        std::map<Key, Route>::iterator route = mRoutes.lower_bound(
+            Key(access->first, std::make_pair(-1, -1)));
+        while (changed && route != mRoutes.end() &&
+                route->first.first == access->first) {
+            bool broken = opened;
+            std::vector<int>::const_iterator itr;
+            for (itr = route->second.mGroups.begin();
+                    !broken && itr != route->second.mGroups.end(); ++itr)
+                broken = closed[*itr];
+            if (broken) mRoutes.erase(route++);
+            else ++route;
+        }
+        if (player == NULL) mAccess.erase(access++);
+        else ++access;
+    }
+}
+
+// Finds which groups a unit can enter the first time it is searched for
+const std::vector<bool> & Pathfinder::getAccess(const Player & player,
+        const UnitType & type) {
+    Mover mover(player.getId(), getMask(type));
+    std::map<Mover, std::vector<bool> >::iterator found =
+        mAccess.find(mover);
+    if (found != mAccess.end()) return found->second;
+    std::vector<bool> & groups = mAccess[mover];
+    groups.resize(mGraph->getGroupCount());
+    unsigned group;
+    for (group = 0; group < groups.size(); ++group)
+        groups[group] = canEnter(player, mover.second, group);
+    return groups;
+}
+
+bool Pathfinder::canEnter(const Player & player, int mask, int group) const {
+    const TileGroup * target = mGraph->getGroup(group);
+    if (target->isSea()) return (mask & 2) != 0;
+    if ((mask & 1) == 0) return false;
+    const Player * owner = target->getOwner();
+    if (owner == NULL || owner == &player) return true;
+    enum Mission mission = owner->getTreaty(&player).getMission();
+    return mission == WAR || mission == ALLIANCE || mission == EMPIRE ||
+           mission == COLONY;
+}
+
+bool Pathfinder::canEnter(const UnitType & type, unsigned tile) const {
+    const TileMap & map = mGame.getMap();
+    const Terrain * terrain =
+        map(tile / map.columns(), tile % map.columns()).getTerrain();
+    return terrain != NULL && ((type.isLandUnit() && terrain->isLandTerrain())
+        || (type.isSeaUnit() && terrain->isSeaTerrain()));
+}
+
+float Pathfinder::getDistance(int from, int to) const {
+    return std::abs(mRow[from] - mRow[to]) +
+           std::abs(mColumn[from] - mColumn[to]);
+}
+
+// A* over the group graph. A step costs the distance between the centers of
+// two groups times the average cost of the group entered, so the distance to
+// the goal times the cheapest group never overestimates.
+const Pathfinder::Route & Pathfinder::search(const Player & player,
+        const UnitType & type, int from, int to) {
+    Key key(Mover(player.getId(), getMask(type)), std::make_pair(from, to));
+    std::map<Key, Route>::iterator cached = mRoutes.find(key);
+    if (cached != mRoutes.end()) return cached->second;
+
+    const std::vector<bool> & access = getAccess(player, type);
+    Route & route = mRoutes[key];
+    route.mCost = -1;
+    if (from != to && !access[to]) return route;
+
+    typedef std::pair<float, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    std::vector<float> cost(mGraph->getGroupCount(), UNREACHED);
+    std::vector<int> through(mGraph->getGroupCount(), -1);
+    cost[from] = 0.0f;
+    open.push(Entry(getDistance(from, to) * mMinCost, from));
+    while (!open.empty()) {
+        Entry entry = open.top();
+        open.pop();
+        int group = entry.second;
+        if (group == to) break;
+        if (entry.first > cost[group] + getDistance(group, to) * mMinCost)
+            continue;
+        unsigned edge;
+        for (edge = mGraph->begin(group); edge != mGraph->end(group);
+                ++edge) {
+            int next = mGraph->getNeighbour(edge);
+            if (!access[next]) continue;
+            float step = std::max(getDistance(group, next), 1.0f) *
+                mCost[next];
+            if (cost[group] + step >= cost[next]) continue;
+            cost[next] = cost[group] + step;
+            through[next] = group;
+            open.push(Entry(cost[next] + getDistance(next, to) * mMinCost,
+                next));
+        }
+    }
+    if (cost[to] == UNREACHED) return route;
+
+    int group;
+    for (group = to; group != from; group = through[group])
+        route.mGroups.push_back(group);
+    route.mGroups.push_back(from);
+    std::reverse(route.mGroups.begin(), route.mGroups.end());
+    route.mCost = (int) (cost[to] + 0.5f);
+    return route;
+}
+
+// A* over the tiles of the given groups, with 4-way movement. The costs are
+// kept between searches, and a tile only counts as reached if it was visited
+// by this search, so nothing is cleared or allocated for the whole map.
+int Pathfinder::search(const UnitType & type, unsigned from, unsigned to,
+        const std::vector<bool> & groups, std::vector<unsigned> & path) {
+    const TileMap & map = mGame.getMap();
+    int columns = map.columns(), rows = map.rows();
+    path.clear();
+    if (!canEnter(type, from) || !canEnter(type, to)) return -1;
+
+    if (mVisited.size() != (unsigned) (rows * columns) || ++mSearch == 0) {
+        mTileCost.assign(rows * columns, 0);
+        mThrough.assign(rows * columns, 0);
+        mVisited.assign(rows * columns, 0);
+        mSearch = 1;
+    }
+    typedef std::pair<int, unsigned> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+    int goalRow = to / columns, goalColumn = to % columns;
+    mTileCost[from] = 0;
+    mVisited[from] = mSearch;
+    open.push(Entry(std::abs((int) from / columns - goalRow) +
+        std::abs((int) from % columns - goalColumn), from));
+    while (!open.empty()) {
+        Entry entry = open.top();
+        open.pop();
+        unsigned tile = entry.second;
+        if (tile == to) break;
+        int row = tile / columns, column = tile % columns;
+        if (entry.first > mTileCost[tile] + std::abs(row - goalRow) +
+            std::abs(column - goalColumn))
+            continue;
+        int direction;
+        for (direction = 0; direction < 4; ++direction) {
+            int r = row + (direction == 0) - (direction == 1);
+            int c = column + (direction == 2) - (direction == 3);
+            if (r < 0 || r >= rows || c < 0 || c >= columns) continue;
+            unsigned next = r * columns + c;
+            int group = mGraph->getTileGroup(next);
+            if (group < 0 || !groups[group] || !canEnter(type, next))
+                continue;
+            int step = map(r, c).getTerrain()->getMoveCost();
+            if (mVisited[next] == mSearch &&
+                mTileCost[tile] + step >= mTileCost[next])
+                continue;
+            mTileCost[next] = mTileCost[tile] + step;
+            mThrough[next] = tile;
+            mVisited[next] = mSearch;
+            open.push(Entry(mTileCost[next] + std::abs(r - goalRow) +
+                std::abs(c - goalColumn), next));
+        }
+    }
+    if (mVisited[to] != mSearch) return -1;
+
+    unsigned tile;
+    for (tile = to; tile != from; tile = mThrough[tile]) path.push_back(tile);
+    path.push_back(from);
+    std::reverse(path.begin(), path.end());
+    return mTileCost[to];
+}
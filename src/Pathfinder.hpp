@@ -0,0 +1,158 @@
+//      Pathfinder -- Finds routes for armies and navies.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef PATHFINDER_HPP_INCLUDED
+#define PATHFINDER_HPP_INCLUDED
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace Aftermath { class AdjacencyGraph;
+                      class Game;
+                      class Player;
+                      class TileGroup;
+                      class UnitType; }
+
+/**
+ * @file Pathfinder.hpp
+ *
+ * Finds routes for armies and navies.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A Pathfinder answers where a unit can go and what it costs to get
+     * there. Entering a tile costs the Terrain::getMoveCost() of its
+     * terrain. Land units stay on land and sea units stay at sea. A unit may
+     * enter seas, unowned provinces, and its own provinces, but only enters
+     * another player's province if that player is at war with, allied to,
+     * or in an empire with its owner.
+     *
+     * Routes are found in two steps. findRoute() searches the graph of
+     * Game::getAdjacency() with A*, treating each group as a single node
+     * with the average cost of its tiles. findPath() then searches the
+     * tiles, but only those in the groups along that route, and only falls
+     * back to the whole map if that corridor is blocked.
+     *
+     * Group routes are cached, so repeated queries during a turn are cheap.
+     * When borders change (see Game::getBorders()), the Pathfinder checks
+     * which groups each cached player can still enter. A player keeps its
+     * routes unless a group opened up to it, which might make any of them
+     * shorter; routes through a group that closed are dropped on their own.
+     * The cache is emptied when the groups themselves change shape, or
+     * when terrains are reloaded (see Mod::getTerrainVersion()).
+     */
+    class Pathfinder {
+        public:
+            /**
+             * Constructs a new Pathfinder for the given game.
+             *
+             * @param game - The game to find routes in.
+             */
+            Pathfinder(const Game & game);
+
+            /**
+             * Finds the cheapest route between two TileGroups.
+             *
+             * @param player - The player that owns the unit.
+             * @param type - The type of the unit.
+             * @param from - The group the unit starts in.
+             * @param to - The group the unit moves to.
+             * @param route - Set to the groups along the route, from first
+             * to last.
+             *
+             * @return The estimated cost of the route, or -1 if there is no
+             * route.
+             */
+            int findRoute(const Player & player, const UnitType & type,
+                const TileGroup * from, const TileGroup * to,
+                std::vector<const TileGroup *> & route);
+
+            /**
+             * Finds the cheapest path between two tiles. Tiles are numbered
+             * row * columns + column.
+             *
+             * @param player - The player that owns the unit.
+             * @param type - The type of the unit.
+             * @param from - The tile the unit starts on.
+             * @param to - The tile the unit moves to.
+             * @param path - Set to the tiles along the path, from first to
+             * last.
+             *
+             * @return The cost of the path, or -1 if there is no path.
+             */
+            int findPath(const Player & player, const UnitType & type,
+                unsigned from, unsigned to, std::vector<unsigned> & path);
+
+            /**
+             * Forgets all cached routes.
+             */
+            void clear();
+
+            /**
+             * @return The number of group routes in the cache.
+             */
+            unsigned getCacheSize() const;
+
+        private:
+            struct Route {
+                std::vector<int> mGroups;
+                int mCost;
+            };
+
+            typedef std::pair<int, int> Mover;
+            typedef std::pair<Mover, std::pair<int, int> > Key;
+
+            void connect();
+            void refresh();
+            const std::vector<bool> & getAccess(const Player & player,
+                const UnitType & type);
+            bool canEnter(const Player & player, int mask, int group) const;
+            bool canEnter(const UnitType & type, unsigned tile) const;
+            float getDistance(int from, int to) const;
+            const Route & search(const Player & player, const UnitType & type,
+                int from, int to);
+            int search(const UnitType & type, unsigned from, unsigned to,
+                const std::vector<bool> & groups,
+                std::vector<unsigned> & path);
+
+            const Game & mGame;
+            const AdjacencyGraph * mGraph;
+            unsigned mVersion;
+            unsigned mBorders;
+            unsigned mTerrain;
+            std::vector<float> mRow;
+            std::vector<float> mColumn;
+            std::vector<float> mCost;
+            float mMinCost;
+            std::map<Key, Route> mRoutes;
+            std::map<Mover, std::vector<bool> > mAccess;
+            std::vector<int> mTileCost;
+            std::vector<unsigned> mThrough;
+            std::vector<unsigned> mVisited;
+            unsigned mSearch;
+    };
+
+}
+
+#endif // PATHFINDER_HPP_INCLUDED
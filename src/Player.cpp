@@ -17,27 +17,33 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include "Diplomacy.hpp"
 #include "Game.hpp"
 #include "Industry.hpp"
 #include "Mod.hpp"
 #include "Move.hpp"
 #include "Player.hpp"
+#include "StateHash.hpp"
+#include "Technology.hpp"
 #include "TileGroup.hpp"
 #include "Transferable.hpp"
 #include "TransportNetwork.hpp"
 #include "Treaty.hpp"
+#include "UpgradeQueue.hpp"
 
 using namespace Aftermath;
 
 Player::Player(const std::string & name, Game & game, bool initFromSettings) :
-        mName(name), mNation(NULL), mGame(game), mCapital(NULL),
-        mHarbor(NULL),mMoney(0), mIndustry(new Industry()),
-        mTransport(new TransportNetwork()) {
+        mId(-1), mHash(NULL), mName(name), mNation(NULL), mGame(game),
+        mCapital(NULL), mHarbor(NULL),mMoney(0), mIndustry(new Industry()),
+        mTransport(new TransportNetwork()), mUpgrades(new UpgradeQueue()) {
+    game.getMod().getTechTree().findResearchable(mTechnology, mResearchable);
     give(game.getMod().getStartingTypes());
 }
 
 Player::~Player() {
     delete mIndustry;
+    delete mUpgrades;
     delete mTransport;
     while (!mMoves.empty()) {
         delete mMoves.front();
@@ -45,6 +51,14 @@ Player::~Player() {
     }
 }
 
+int Player::getId() const {
+    return mId;
+}
+
+void Player::setId(int id) {
+    mId = id;
+}
+
 const std::string & Player::getName() const {
     return mName;
 }
@@ -61,34 +75,80 @@ void Player::setNation(const Nation * nation) {
     mNation = nation;
 }
 
-Treaty & Player::getTreaty(const Player * player) {
-    return mTreaties[player];
+void Player::attach(StateHash * hash) {
+    if (mHash != NULL) mHash->remove(getFacts());
+    mHash = hash;
+    if (mHash != NULL) mHash->add(getFacts());
 }
 
-const Treaty & Player::getTreaty(const Player * player) const {
-    return ((Player *) this)->getTreaty(player);
+Treaty Player::getTreaty(const Player * player) const {
+    if (player == NULL) return Treaty();
+    return mGame.getDiplomacy().get(mId, player->getId());
 }
 
-bool Player::canAdd(const TileGroup *& group) const {
-    return group->isLand();
+void Player::setTreaty(const Player * player, const Treaty & treaty) {
+    if (player == NULL || mGame.getPlayer(mId) != this ||
+        mGame.getPlayer(player->getId()) != player)
+        return;
+    mGame.getDiplomacy().set(mId, player->getId(), treaty);
 }
 
-Count<const Resource *> & Player::getStockpile() {
-    return mStockpile;
+bool Player::canAdd(TileGroup * const & group) const {
+    return group->isLand();
 }
 
 const Count<const Resource *> & Player::getStockpile() const {
     return mStockpile;
 }
 
-Collection<const Technology *> & Player::getTechnology() {
-    return mTechnology;
+void Player::giveResource(const Resource * resource, int amount) {
+    int before = mStockpile.getCount(resource);
+    mStockpile[resource] = before + amount;
+    if (mHash != NULL)
+        mHash->replace(StateHash::stockpile(mId, resource, before),
+            StateHash::stockpile(mId, resource, before + amount));
+}
+
+void Player::takeResource(const Resource * resource, int amount) {
+    giveResource(resource, -amount);
 }
 
-const Collection<const Technology *> & Player::getTechnology() const {
+const TechTree::Mask & Player::getTechnology() const {
     return mTechnology;
 }
 
+const TechTree::Mask & Player::getResearchable() const {
+    return mResearchable;
+}
+
+bool Player::hasTechnology(const Technology * technology) const {
+    return TechTree::test(mTechnology, technology->getId());
+}
+
+bool Player::hasTechnology(const TechTree::Mask & technology) const {
+    return TechTree::contains(mTechnology, technology);
+}
+
+bool Player::canResearch(const Technology * technology) const {
+    return TechTree::test(mResearchable, technology->getId());
+}
+
+void Player::giveTechnology(const Technology * technology) {
+    const TechTree & tree = mGame.getMod().getTechTree();
+    if (tree.get(technology->getId()) != technology ||
+        hasTechnology(technology))
+        return;
+    tree.grant(technology, mTechnology, mResearchable);
+    if (mHash != NULL) mHash->add(StateHash::technology(mId, technology));
+}
+
+void Player::takeTechnology(const Technology * technology) {
+    if (!hasTechnology(technology)) return;
+    mGame.getMod().getTechTree().revoke(technology, mTechnology,
+        mResearchable);
+    if (mHash != NULL) mHash->remove(StateHash::technology(mId, technology));
+}
+
 Industry & Player::getIndustry() {
     return *mIndustry;
 }
@@ -105,6 +165,14 @@ const TransportNetwork & Player::getTransport() const {
     return *mTransport;
 }
 
+UpgradeQueue & Player::getUpgrades() {
+    return *mUpgrades;
+}
+
+const UpgradeQueue & Player::getUpgrades() const {
+    return *mUpgrades;
+}
+
 Collection<Tile *> & Player::getRevealed() {
     return mRevealed;
 }
@@ -142,11 +210,14 @@ int Player::getMoney() const {
 }
 
 void Player::giveMoney(int amount) {
+    if (mHash != NULL)
+        mHash->replace(StateHash::money(mId, mMoney),
+            StateHash::money(mId, mMoney + amount));
     mMoney += amount;
 }
 
 void Player::takeMoney(int amount) {
-    mMoney -= amount;
+    giveMoney(-amount);
 }
 
 Game & Player::getGame() {
@@ -214,3 +285,17 @@ Move * Player::popMove() {
     mMoves.pop();
     return move;
 }
+
+// The sum of the keys of this player's facts
+Hash::Value Player::getFacts() const {
+    Hash::Value facts = StateHash::money(mId, mMoney);
+    Count<const Resource *>::const_iterator stock;
+    for (stock = mStockpile.begin(); stock != mStockpile.end(); ++stock)
+        facts += StateHash::stockpile(mId, stock->first, stock->second);
+    const TechTree & tree = mGame.getMod().getTechTree();
+    unsigned tech;
+    for (tech = 0; tech < tree.size(); ++tech)
+        if (TechTree::test(mTechnology, tech))
+            facts += StateHash::technology(mId, tree.get(tech));
+    return facts;
+}
@@ -22,7 +22,9 @@
 
 #include "Collection.hpp"
 #include "Count.hpp"
+#include "Hash.hpp"
 #include "SelectiveCollection.hpp"
+#include "TechTree.hpp"
 
 #include <string>
 #include <queue>
@@ -33,13 +35,15 @@ namespace Aftermath { class Game;
                       class Nation;
                       class Move;
                       class Resource;
+                      class StateHash;
                       class Technology;
                       class Tile;
                       class TileGroup;
                       class TileUnit;
                       class Transferable;
                       class TransportNetwork;
-                      class Treaty; }
+                      class Treaty;
+                      class UpgradeQueue; }
 
 /**
  * @file Player.hpp
@@ -56,7 +60,7 @@ namespace Aftermath {
      * own Nation, name, and method of making moves. That means Players can
      * be controlled by both humans and AI. Players also have Treaties with
      * other players, a list of TileGroups that they control, a stockpile
-     * of Resources, a Collection of Technology, an Industry, and a
+     * of Resources, a mask of Technology, an Industry, and a
      * TransportNetwork. Players also keep track of which Tiles they have
      * surveyed.
      */
@@ -79,6 +83,24 @@ namespace Aftermath {
              */
             virtual ~Player();
 
+            /**
+             * Gets the id of this player. Ids are given out by Game::add()
+             * in the order that players join, and they decide turn order.
+             *
+             * @return The id of this player.
+             */
+            int getId() const;
+
+            /**
+             * Sets the id of this player. This must be done before the
+             * player is added to a Game, and is only needed to give the
+             * player a particular id, like a client's copy of a server's
+             * player. This does NOT add this player to a game.
+             *
+             * @param id - The new id of this player.
+             */
+            void setId(int id);
+
             /**
              * Gets the name of this player. Players have names other than the
              * names of their nations.
@@ -109,6 +131,16 @@ namespace Aftermath {
              */
             void setNation(const Nation * nation);
 
+            /**
+             * For use by Game::add() and Game::remove(). Adds this player's
+             * money, stockpile, technology, and treaties to the given state
+             * hash, and keeps them up to date from then on. The facts are
+             * removed from the previous hash, if any.
+             *
+             * @param hash - The hash of the game, or NULL.
+             */
+            void attach(StateHash * hash);
+
             /**
              * Gets the current diplomatic relationship that this player has
              * with the given player.
@@ -118,15 +150,20 @@ namespace Aftermath {
              * @return A Treaty object representing the diplomatic
              * relationship between the two players, from this player's
              * perspective.
+             *
+             * @see Diplomacy
              */
-            Treaty & getTreaty(const Player * player);
+            Treaty getTreaty(const Player * player) const;
 
             /**
-             * Gets the const Treaty object between these two players.
+             * Changes the diplomatic relationship that this player has with
+             * the given player. This does nothing unless both players are
+             * in this player's game.
              *
-             * @see getTreaty()
+             * @param player - The player that the treaty is with.
+             * @param treaty - The new treaty, from this player's perspective.
              */
-            const Treaty & getTreaty(const Player * player) const;
+            void setTreaty(const Player * player, const Treaty & treaty);
 
             /**
              * Returns whether or not this TileGroup can be claimed by this
@@ -135,35 +172,86 @@ namespace Aftermath {
              * @return true if TileGroup::isLand() returns true and this
              * player does not already control the given group.
              */
-            bool canAdd(const TileGroup *& group) const;
+            bool canAdd(TileGroup * const & group) const;
 
             /**
-             * Provides access to this Player's stockpile.
+             * Provides const access to this Player's stockpile. Use
+             * giveResource() and takeResource() to change it.
              *
              * @return A reference to this Player's stockpile.
              */
-            Count<const Resource *> & getStockpile();
+            const Count<const Resource *> & getStockpile() const;
 
             /**
-             * Provides const access to this Player's stockpile.
+             * Adds an amount of a resource to this Player's stockpile.
              *
-             * @see getStockpile();
+             * @param resource - The resource to add.
+             * @param amount - The amount to add.
              */
-            const Count<const Resource *> & getStockpile() const;
+            void giveResource(const Resource * resource, int amount);
+
+            /**
+             * Removes an amount of a resource from this Player's stockpile.
+             *
+             * @param resource - The resource to remove.
+             * @param amount - The amount to remove.
+             */
+            void takeResource(const Resource * resource, int amount);
 
             /**
-             * Provides access to this Player's technology.
+             * Provides const access to this Player's technology. Use
+             * giveTechnology() and takeTechnology() to change it.
              *
-             * @return A reference to this Player's technology.
+             * @return A mask of this Player's technology, indexed by the ids
+             * of the Mod's TechTree.
+             */
+            const TechTree::Mask & getTechnology() const;
+
+            /**
+             * @return A mask of the technologies that this Player does not
+             * know yet, but knows every prerequisite of.
              */
-            Collection<const Technology *> & getTechnology();
+            const TechTree::Mask & getResearchable() const;
 
             /**
-             * Provides const access to this Player's technology.
+             * @param technology - The technology to look for.
              *
-             * @see getTechnology()
+             * @return true if this Player knows the technology; false
+             * otherwise.
              */
-            const Collection<const Technology *> & getTechnology() const;
+            bool hasTechnology(const Technology * technology) const;
+
+            /**
+             * @param technology - A mask of technologies, such as the ones
+             * required by a ProductionFormula.
+             *
+             * @return true if this Player knows every technology in the
+             * mask; false otherwise.
+             */
+            bool hasTechnology(const TechTree::Mask & technology) const;
+
+            /**
+             * @param technology - The technology to look for.
+             *
+             * @return true if this Player can research the technology next;
+             * false otherwise.
+             */
+            bool canResearch(const Technology * technology) const;
+
+            /**
+             * Adds a technology to this Player, if it is not already known.
+             * The technology must be in the Mod's TechTree.
+             *
+             * @param technology - The technology to add.
+             */
+            void giveTechnology(const Technology * technology);
+
+            /**
+             * Removes a technology from this Player.
+             *
+             * @param technology - The technology to remove.
+             */
+            void takeTechnology(const Technology * technology);
 
             /**
              * Provides access to this Player's industry.
@@ -193,6 +281,17 @@ namespace Aftermath {
              */
             const TransportNetwork & getTransport() const;
 
+            /**
+             * @return This Player's upgrades in progress. Game finishes the
+             * ones that are done at the end of the player's turn.
+             */
+            UpgradeQueue & getUpgrades();
+
+            /**
+             * @see getUpgrades()
+             */
+            const UpgradeQueue & getUpgrades() const;
+
             /**
              * Gets the Tiles that have been surveyed by this Player.
              *
@@ -390,19 +489,24 @@ namespace Aftermath {
             Move * popMove();
 
         private:
+            int mId;
+            StateHash * mHash;
             std::string mName;
             const Nation * mNation;
-            std::map<const Player *, Treaty> mTreaties;
             Game & mGame;
             Collection<Tile *> mRevealed;
             Count<const Resource *> mStockpile;
             TileGroup * mCapital;
             TileGroup * mHarbor;
             int mMoney;
-            Collection<const Technology *> mTechnology;
+            TechTree::Mask mTechnology;
+            TechTree::Mask mResearchable;
             Industry * mIndustry;
             TransportNetwork * mTransport;
+            UpgradeQueue * mUpgrades;
             std::queue<Move *> mMoves;
+
+            Hash::Value getFacts() const;
     };
 
 }
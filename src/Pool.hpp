@@ -0,0 +1,240 @@
+//      Pool.hpp -- A slab allocator with slot handles.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef POOL_HPP_INCLUDED
+#define POOL_HPP_INCLUDED
+
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <new>
+#include <vector>
+
+#include <SFML/Config.hpp>
+
+/**
+ * @file Pool.hpp
+ *
+ * A slab allocator with slot handles.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A Pool hands out storage for objects of one type from large slabs, so
+     * that making and destroying objects does not go through the general
+     * heap once the pool has grown. Slabs are never given back until the
+     * pool is destroyed. Freed slots are reused first, which keeps the live
+     * objects packed together.
+     *
+     * Each slot has a number and a generation that goes up whenever the
+     * slot is freed. Together they make a Handle, which stays safe to look
+     * up after the object is gone: get() then returns NULL rather than
+     * whatever object took the slot.
+     *
+     * A Pool only provides storage. Use it from a class's operator new and
+     * operator delete. It is not thread safe.
+     *
+     * @param T - The type of object to store.
+     */
+    template <typename T>
+    class Pool {
+        public:
+            /**
+             * A handle to an object in a pool. 0 is never a valid handle.
+             */
+            typedef sf::Uint64 Handle;
+
+            /**
+             * Constructs an empty pool.
+             *
+             * @param slab - The number of objects in each slab.
+             */
+            Pool(unsigned slab = 256);
+
+            /**
+             * Frees every slab. Objects left in the pool are not destructed.
+             */
+            ~Pool();
+
+            /**
+             * @return Uninitialized storage for one object.
+             */
+            void * allocate();
+
+            /**
+             * Gives back the storage of an object.
+             *
+             * @param object - Storage returned by allocate(), or NULL.
+             */
+            void release(void * object);
+
+            /**
+             * @param object - Any pointer.
+             *
+             * @return true if the pointer is the storage of a slot of this
+             * pool; false otherwise.
+             */
+            bool contains(const T * object) const;
+
+            /**
+             * @param object - An object in this pool.
+             *
+             * @return The number of the object's slot.
+             */
+            unsigned find(const T * object) const;
+
+            /**
+             * @param object - An object in this pool.
+             *
+             * @return The handle of the given object.
+             */
+            Handle getHandle(const T * object) const;
+
+            /**
+             * @param handle - A handle returned by getHandle().
+             *
+             * @return The object with the given handle, or NULL if it has
+             * been released.
+             */
+            T * get(Handle handle) const;
+
+            /**
+             * @return The number of slots in this pool, live or not. Slots
+             * are numbered from 0, in the order that they lie in memory.
+             */
+            unsigned getCapacity() const;
+
+            /**
+             * @param slot - The number of a slot.
+             *
+             * @return The object in the given slot, or NULL if it is free.
+             */
+            T * getSlot(unsigned slot) const;
+
+            /**
+             * @return The number of live objects in this pool.
+             */
+            unsigned size() const;
+
+        private:
+            unsigned mSlab;
+            std::vector<T *> mSlabs;
+            std::map<const T *, unsigned, std::greater<const T *> > mStarts;
+            std::vector<sf::Uint32> mGenerations;
+            std::vector<bool> mLive;
+            std::vector<unsigned> mFree;
+    };
+
+    template <typename T>
+    inline Pool<T>::Pool(unsigned slab) : mSlab(slab) {}
+
+    template <typename T>
+    inline Pool<T>::~Pool() {
+        unsigned i;
+        for (i = 0; i < mSlabs.size(); ++i) free(mSlabs[i]);
+    }
+
+    template <typename T>
+    inline void * Pool<T>::allocate() {
+        if (mFree.empty()) {
+            T * slab = (T *) malloc(sizeof(T) * mSlab);
+            if (slab == NULL) throw std::bad_alloc();
+            unsigned first = getCapacity(), slot;
+            mStarts[slab] = first;
+            mSlabs.push_back(slab);
+            mGenerations.resize(first + mSlab, 1);
+            mLive.resize(first + mSlab, false);
+            // Hand out the lowest slots first
+            for (slot = first + mSlab; slot > first; --slot)
+                mFree.push_back(slot - 1);
+        }
+        unsigned slot = mFree.back();
+        mFree.pop_back();
+        mLive[slot] = true;
+        return mSlabs[slot / mSlab] + slot % mSlab;
+    }
+
+    template <typename T>
+    inline void Pool<T>::release(void * object) {
+        if (object == NULL) return;
+        unsigned slot = find((T *) object);
+        mLive[slot] = false;
+        ++mGenerations[slot];
+        mFree.push_back(slot);
+    }
+
+    template <typename T>
+    inline typename Pool<T>::Handle Pool<T>::getHandle(const T * object)
+        const {
+        unsigned slot = find(object);
+        return (static_cast<Handle>(mGenerations[slot]) << 32) | slot;
+    }
+
+    template <typename T>
+    inline T * Pool<T>::get(Handle handle) const {
+        unsigned slot = (unsigned) (handle & 0xFFFFFFFFUL);
+        if (slot >= getCapacity() || !mLive[slot] ||
+            mGenerations[slot] != (sf::Uint32) (handle >> 32))
+            return NULL;
+        return getSlot(slot);
+    }
+
+    template <typename T>
+    inline unsigned Pool<T>::getCapacity() const {
+        return mSlabs.size() * mSlab;
+    }
+
+    template <typename T>
+    inline T * Pool<T>::getSlot(unsigned slot) const {
+        if (!mLive[slot]) return NULL;
+        return mSlabs[slot / mSlab] + slot % mSlab;
+    }
+
+    template <typename T>
+    inline unsigned Pool<T>::size() const {
+        return getCapacity() - mFree.size();
+    }
+
+    // The slab that could hold an object is the one with the nearest start
+    // at or below it
+    template <typename T>
+    inline bool Pool<T>::contains(const T * object) const {
+        typename std::map<const T *, unsigned,
+            std::greater<const T *> >::const_iterator start;
+        start = mStarts.lower_bound(object);
+        return start != mStarts.end() &&
+            std::less<const T *>()(object, start->first + mSlab);
+    }
+
+    template <typename T>
+    inline unsigned Pool<T>::find(const T * object) const {
+        assert(contains(object));
+        typename std::map<const T *, unsigned,
+            std::greater<const T *> >::const_iterator start;
+        start = mStarts.lower_bound(object);
+        return start->second + (object - start->first);
+    }
+
+}
+
+#endif // POOL_HPP_INCLUDED
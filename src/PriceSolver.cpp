@@ -0,0 +1,189 @@
+//      PriceSolver -- Equilibrium prices for resources.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <cmath>
+
+#include "Game.hpp"
+#include "Industry.hpp"
+#include "Mod.hpp"
+#include "Player.hpp"
+#include "PriceSolver.hpp"
+#include "ProductionCenter.hpp"
+#include "ProductionCenterType.hpp"
+#include "ProductionFormula.hpp"
+#include "Resource.hpp"
+#include "TransportNetwork.hpp"
+
+using namespace Aftermath;
+
+// The price of a resource that is as scarce as it is wanted
+#define BASE_PRICE 100.0f
+
+// How far supply and demand move when the price doubles
+#define SUPPLY_ELASTICITY 0.5f
+#define DEMAND_ELASTICITY 0.5f
+
+// How much of the gap between supply and demand each round closes
+#define RATE 0.5f
+
+// The most that a price can change by in one round, as a log
+#define MAX_STEP 1.0f
+
+// Prices stay between 1/100 and 100 times the base price
+#define MIN_LOG_PRICE -4.6f
+#define MAX_LOG_PRICE 4.6f
+
+// Rounds stop when no price moves by more than this, as a log
+#define TOLERANCE 0.001f
+#define MAX_ROUNDS 32
+
+// The number of turns of history kept for each resource
+#define HISTORY_LENGTH 100
+
+PriceSolver::PriceSolver(const Mod & mod) : mMod(mod) {}
+
+int PriceSolver::update(const Game & game) {
+    index();
+    unsigned count = mResources.size(), resource;
+    std::fill(mSupply.begin(), mSupply.end(), 0.0f);
+    std::fill(mDemand.begin(), mDemand.end(), 0.0f);
+
+    // Add up the world's supply and demand
+    float money = 0.0f;
+    Game::const_iterator player;
+    for (player = game.begin(); player != game.end(); ++player) {
+        money += (*player)->getMoney();
+        const Count<const Resource *> & stockpile =
+            (*player)->getStockpile();
+        Count<const Resource *>::const_iterator stock;
+        for (stock = stockpile.begin(); stock != stockpile.end(); ++stock) {
+            int i = find(stock->first);
+            if (i >= 0) mSupply[i] += stock->second;
+        }
+        const TransportNetwork & transport = (*player)->getTransport();
+        for (resource = 0; resource < count; ++resource)
+            mSupply[resource] +=
+                transport.getAvailable(mResources[resource]);
+        const Industry & industry = (*player)->getIndustry();
+        Industry::const_iterator center;
+        for (center = industry.begin(); center != industry.end(); ++center) {
+            const Collection<const ProductionFormula *> & formulas =
+                (*center)->getType().getFormulas();
+            Collection<const ProductionFormula *>::const_iterator formula;
+            for (formula = formulas.begin(); formula != formulas.end();
+                    ++formula) {
+                // Idle formulas still want one batch of their inputs
+                int producing = (*center)->getProducing(*formula);
+                Count<const Transferable *>::const_iterator type;
+                for (type = (*formula)->getInput().begin();
+                        type != (*formula)->getInput().end(); ++type) {
+                    int i = find(type->first);
+                    if (i >= 0)
+                        mDemand[i] += type->second * std::max(producing, 1);
+                }
+                for (type = (*formula)->getOutput().begin();
+                        type != (*formula)->getOutput().end(); ++type) {
+                    int i = find(type->first);
+                    if (i >= 0) mSupply[i] += type->second * producing;
+                }
+            }
+        }
+    }
+
+    // Move every price towards equilibrium at once
+    std::vector<float> wanted(count);
+    int round;
+    for (round = 1; round < MAX_ROUNDS; ++round) {
+        float cost = 0.0f;
+        for (resource = 0; resource < count; ++resource) {
+            wanted[resource] = mDemand[resource] *
+                std::exp(-DEMAND_ELASTICITY * mLogPrice[resource]);
+            cost += wanted[resource] * BASE_PRICE *
+                std::exp(mLogPrice[resource]);
+        }
+        float budget = cost > money ? money / cost : 1.0f;
+        float largest = 0.0f;
+        for (resource = 0; resource < count; ++resource) {
+            float offered = mSupply[resource] *
+                std::exp(SUPPLY_ELASTICITY * mLogPrice[resource]);
+            float step = RATE * std::log((wanted[resource] * budget + 1.0f) /
+                (offered + 1.0f));
+            step = std::max(-MAX_STEP, std::min(MAX_STEP, step));
+            float price = std::max(MIN_LOG_PRICE,
+                std::min(MAX_LOG_PRICE, mLogPrice[resource] + step));
+            largest = std::max(largest,
+                std::fabs(price - mLogPrice[resource]));
+            mLogPrice[resource] = price;
+        }
+        if (largest < TOLERANCE) break;
+    }
+
+    for (resource = 0; resource < count; ++resource) {
+        std::deque<int> & history = mHistory[resource];
+        history.push_back(getPrice(mResources[resource]));
+        if (history.size() > HISTORY_LENGTH) history.pop_front();
+    }
+    return round;
+}
+
+int PriceSolver::getPrice(const Resource * resource) const {
+    int i = find(resource);
+    float price = BASE_PRICE * std::exp(i < 0 ? 0.0f : mLogPrice[i]);
+    return (int) (price + 0.5f);
+}
+
+const std::deque<int> & PriceSolver::getHistory(const Resource * resource)
+        const {
+    static const std::deque<int> empty;
+    int i = find(resource);
+    return i < 0 ? empty : mHistory[i];
+}
+
+int PriceSolver::getSupply(const Resource * resource) const {
+    int i = find(resource);
+    return i < 0 ? 0 : (int) mSupply[i];
+}
+
+int PriceSolver::getDemand(const Resource * resource) const {
+    int i = find(resource);
+    return i < 0 ? 0 : (int) mDemand[i];
+}
+
+int PriceSolver::find(const Transferable * type) const {
+    std::map<const Transferable *, unsigned>::const_iterator itr =
+        mIndex.find(type);
+    return itr == mIndex.end() ? -1 : (int) itr->second;
+}
+
+// Lists the resources of the Mod the first time they are needed
+void PriceSolver::index() {
+    if (!mResources.empty()) return;
+    const std::map<std::string, const Resource *> & resources =
+        mMod.getResources();
+    std::map<std::string, const Resource *>::const_iterator itr;
+    for (itr = resources.begin(); itr != resources.end(); ++itr) {
+        mIndex[itr->second] = mResources.size();
+        mResources.push_back(itr->second);
+    }
+    mSupply.assign(mResources.size(), 0.0f);
+    mDemand.assign(mResources.size(), 0.0f);
+    mLogPrice.assign(mResources.size(), 0.0f);
+    mHistory.assign(mResources.size(), std::deque<int>());
+}
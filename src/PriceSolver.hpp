@@ -0,0 +1,122 @@
+//      PriceSolver -- Equilibrium prices for resources.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef PRICESOLVER_HPP_INCLUDED
+#define PRICESOLVER_HPP_INCLUDED
+
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace Aftermath { class Game;
+                      class Mod;
+                      class Resource;
+                      class Transferable; }
+
+/**
+ * @file PriceSolver.hpp
+ *
+ * Equilibrium prices for resources.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A PriceSolver estimates what every resource is worth, for the AI and
+     * the interface to go by. It is separate from the Market, which only
+     * knows the prices that players actually asked for.
+     *
+     * Once per turn, update() adds up the world's supply of each resource
+     * (stockpiles, what transport networks deliver, and what industry is
+     * making) and its demand (the inputs of every ProductionFormula that
+     * industry can run). Supply rises and demand falls with price, and all
+     * demand together can not cost more than the money in the world. The
+     * prices are then moved towards where supply meets demand, all
+     * resources at once, starting from last turn's prices. This stops after
+     * a fixed number of rounds even if it has not settled, so its cost only
+     * grows with the number of resources, never with the number of players.
+     */
+    class PriceSolver {
+        public:
+            /**
+             * Constructs a new PriceSolver for the resources of the given
+             * Mod. Every resource starts at the base price.
+             *
+             * @param mod - The Mod that holds the resource types.
+             */
+            PriceSolver(const Mod & mod);
+
+            /**
+             * Finds new prices from the current state of the game, and adds
+             * them to the price history.
+             *
+             * @param game - The game to price.
+             *
+             * @return The number of rounds that the prices took to settle.
+             */
+            int update(const Game & game);
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The price of one unit of the resource.
+             */
+            int getPrice(const Resource * resource) const;
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The prices of the resource, one per update(), oldest
+             * first. Only the most recent turns are kept.
+             */
+            const std::deque<int> & getHistory(const Resource * resource)
+                const;
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The world supply of the resource at the last update().
+             */
+            int getSupply(const Resource * resource) const;
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The world demand for the resource at the last update().
+             */
+            int getDemand(const Resource * resource) const;
+
+        private:
+            int find(const Transferable * type) const;
+            void index();
+
+            const Mod & mMod;
+            std::vector<const Resource *> mResources;
+            std::map<const Transferable *, unsigned> mIndex;
+            std::vector<float> mSupply;
+            std::vector<float> mDemand;
+            std::vector<float> mLogPrice;
+            std::vector<std::deque<int> > mHistory;
+    };
+
+}
+
+#endif // PRICESOLVER_HPP_INCLUDED
@@ -48,6 +48,7 @@ bool ProductionCenter::canProduce(const Player & player, const
         if (itr->second * producing > getLevel().getMaxOutput())
             return false;
     return getType().getFormulas().contains(formula) &&
+           player.hasTechnology(formula->getTechnology()) &&
            player.canTake(formula->getInput()) &&
            player.canGive(formula->getOutput());
 }
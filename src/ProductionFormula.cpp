@@ -23,7 +23,12 @@ using namespace Aftermath;
 
 ProductionFormula::ProductionFormula(const Count<const Transferable *> *
     input, const Count<const Transferable *> * output) :
-        mInput(input), mOutput(output) {}
+        mInput(NULL), mOutput(output) {
+    Count<const Transferable *> * rest = new Count<const Transferable *>();
+    TechTree::split(*input, *rest, mTechnology);
+    delete input;
+    mInput = rest;
+}
 
 ProductionFormula::~ProductionFormula() {
     delete mInput;
@@ -34,6 +39,10 @@ const Count<const Transferable *> & ProductionFormula::getInput() const {
     return *mInput;
 }
 
+const TechTree::Mask & ProductionFormula::getTechnology() const {
+    return mTechnology;
+}
+
 const Count<const Transferable *> & ProductionFormula::getOutput() const {
     return *mOutput;
 }
@@ -23,6 +23,7 @@
 #include <map>
 
 #include "Count.hpp"
+#include "TechTree.hpp"
 
 namespace Aftermath { class Resource;
                       class Transferable; }
@@ -39,13 +40,15 @@ namespace Aftermath {
 
     /**
      * ProductionFormulas hold information about the requirements to produce
-     * a specified list of products (Transferables).
+     * a specified list of products (Transferables). Technology in the input
+     * is required rather than used up, and is kept apart as a mask.
      */
     class ProductionFormula {
         public:
             /**
              * Constructs a new ProductionFormula with the specified costs and
-             * outputs.
+             * outputs. Any Technology in the input must already be in the
+             * Mod's TechTree.
              *
              * @param input - The elements required for production.
              * @param output - The elements created by production.
@@ -59,10 +62,16 @@ namespace Aftermath {
             ~ProductionFormula();
 
             /**
-             * @return The cost of this production formula.
+             * @return The cost of this production formula, without its
+             * technology.
              */
             const Count<const Transferable *> & getInput() const;
 
+            /**
+             * @return The technology required by this production formula.
+             */
+            const TechTree::Mask & getTechnology() const;
+
             /**
              * @return The products produced by this formula.
              */
@@ -71,6 +80,7 @@ namespace Aftermath {
         private:
             const Count<const Transferable *> * mInput;
             const Count<const Transferable *> * mOutput;
+            TechTree::Mask mTechnology;
     };
 
 }
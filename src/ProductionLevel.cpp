@@ -23,8 +23,9 @@ using namespace Aftermath;
 
 ProductionLevel::ProductionLevel(const std::string & name, const std::string &
     description, const std::string & image, const Count<const Transferable
-    *> * cost, int maxOutput) : NamedType(name, description, image),
-    Level(cost), mMaxOutput(maxOutput) {}
+    *> * cost, int maxOutput, int duration) :
+    NamedType(name, description, image), Level(cost, duration),
+    mMaxOutput(maxOutput) {}
 
 int ProductionLevel::getMaxOutput() const {
     return mMaxOutput;
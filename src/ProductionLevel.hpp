@@ -54,10 +54,12 @@ namespace Aftermath {
              * @param image - The image of this level.
              * @param cost - The cost of upgrading to this level.
              * @param maxOutput - The maximum output for any single product.
+             * @param duration - The number of turns that upgrading to this
+             * level takes.
              */
             ProductionLevel(const std::string & name, const std::string &
                 description, const std::string & image, const Count<const
-                Transferable *> * cost, int maxOutput);
+                Transferable *> * cost, int maxOutput, int duration = 1);
 
             /**
              * The production of any single product cannot surpass the
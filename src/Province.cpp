@@ -17,14 +17,19 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include "Army.hpp"
 #include "Province.hpp"
+#include "StateHash.hpp"
 #include "Terrain.hpp"
 #include "Tile.hpp"
 #include "TileGroupUnit.hpp"
 
 using namespace Aftermath;
 
-Province::Province(const std::string & name) : TileGroup(name) {}
+Province::Province(const std::string & name) : TileGroup(name),
+        mOwner(NULL), mCapital(NULL) {
+    mUnits = new Army();
+}
 
 bool Province::isLand() const {
     return true;
@@ -43,6 +48,11 @@ const Player * Province::getOwner() const {
 }
 
 void Province::setOwner(Player * owner) {
+    if (mHash != NULL) {
+        mHash->replace(StateHash::owner(Hash::string(getName()), mOwner),
+            StateHash::owner(Hash::string(getName()), owner));
+        mHash->changeBorders();
+    }
     mOwner = owner;
 }
 
@@ -58,6 +68,6 @@ void Province::setCapital(Tile * capital) {
     mCapital = capital;
 }
 
-bool Province::canAdd(const Tile *& tile) const {
+bool Province::canAdd(Tile * const & tile) const {
     return tile->getTerrain()->isLandTerrain();
 }
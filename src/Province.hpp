@@ -118,7 +118,7 @@ namespace Aftermath {
              * @return true if the tile's Terrain::isLandTerrain() returns
              * true, false otherwise.
              */
-            bool canAdd(const Tile *& tile) const;
+            bool canAdd(Tile * const & tile) const;
 
         private:
             Player * mOwner;
@@ -27,7 +27,7 @@ Resource::Resource(const std::string & name, const std::string & description,
     const std::string & image) : NamedType(name, description, image) {}
 
 void Resource::giveTo(Player & player, int amount) const {
-    player.getStockpile()[this] += amount;
+    player.giveResource(this, amount);
 }
 
 bool Resource::canGiveTo(const Player & player, int amount) const {
@@ -35,7 +35,7 @@ bool Resource::canGiveTo(const Player & player, int amount) const {
 }
 
 void Resource::takeFrom(Player & player, int amount) const {
-    player.getStockpile()[this] -= amount;
+    player.takeResource(this, amount);
 }
 
 bool Resource::canTakeFrom(const Player & player, int amount) const {
@@ -17,13 +17,16 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include "Navy.hpp"
 #include "Sea.hpp"
 #include "Terrain.hpp"
 #include "Tile.hpp"
 
 using namespace Aftermath;
 
-Sea::Sea(const std::string & name) : TileGroup(name) {}
+Sea::Sea(const std::string & name) : TileGroup(name) {
+    mUnits = new Navy();
+}
 
 bool Sea::isLand() const {
     return false;
@@ -53,6 +56,6 @@ const Tile * Sea::getCapital() const {
 
 void Sea::setCapital(Tile * capital) {}
 
-bool Sea::canAdd(const Tile *& tile) const {
+bool Sea::canAdd(Tile * const & tile) const {
     return tile->getTerrain()->isSeaTerrain();
 }
@@ -109,7 +109,7 @@ namespace Aftermath {
              * @return true if the tile's Terrain::isSeaTerrain() returns
              * true and the tile is not already in this sea, false otherwise.
              */
-            bool canAdd(const Tile *& tile) const;
+            bool canAdd(Tile * const & tile) const;
     };
 
 }
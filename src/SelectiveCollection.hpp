@@ -21,6 +21,8 @@
 #ifndef SELECTIVECOLLECTION_HPP_INCLUDED
 #define SELECTIVECOLLECTION_HPP_INCLUDED
 
+#include <vector>
+
 #include "Collection.hpp"
 
 /**
@@ -68,6 +70,21 @@ namespace Aftermath {
                 if (canAdd(element))
                     Collection<T>::add(element);
             }
+
+            /**
+             * Adds several elements at once, skipping any that canAdd()
+             * rejects.
+             *
+             * @param elements - The elements to add.
+             */
+            virtual void addAll(const std::vector<T> & elements) {
+                std::vector<T> accepted;
+                accepted.reserve(elements.size());
+                typename std::vector<T>::const_iterator itr;
+                for (itr = elements.begin(); itr != elements.end(); ++itr)
+                    if (canAdd(*itr)) accepted.push_back(*itr);
+                Collection<T>::addAll(accepted);
+            }
     };
 
 }
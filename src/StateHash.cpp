@@ -0,0 +1,130 @@
+//      StateHash.cpp -- A running fingerprint of the game state.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include "Player.hpp"
+#include "Resource.hpp"
+#include "SpecialistType.hpp"
+#include "StateHash.hpp"
+#include "Technology.hpp"
+#include "Terrain.hpp"
+#include "TileGroupUnit.hpp"
+#include "TileUnit.hpp"
+#include "Treaty.hpp"
+#include "UnitLevel.hpp"
+#include "UnitType.hpp"
+
+using namespace Aftermath;
+
+// The kinds of facts that make up the state hash
+enum Fact {
+    FACT_MONEY,
+    FACT_STOCKPILE,
+    FACT_TECHNOLOGY,
+    FACT_TREATY,
+    FACT_OWNER,
+    FACT_UNIT,
+    FACT_TERRAIN,
+    FACT_RESOURCE,
+    FACT_TILE_UNIT
+};
+
+StateHash::StateHash() : mValue(0), mBorders(0) {}
+
+Hash::Value StateHash::getValue() const {
+    return mValue;
+}
+
+void StateHash::add(Hash::Value key) {
+    mValue += key;
+}
+
+void StateHash::remove(Hash::Value key) {
+    mValue -= key;
+}
+
+void StateHash::replace(Hash::Value before, Hash::Value after) {
+    mValue += after - before;
+}
+
+unsigned StateHash::getBorders() const {
+    return mBorders;
+}
+
+void StateHash::changeBorders() {
+    ++mBorders;
+}
+
+Hash::Value StateHash::money(int player, int money) {
+    return Hash::key(FACT_MONEY, player, money);
+}
+
+Hash::Value StateHash::stockpile(int player, const Resource * resource,
+        int amount) {
+    if (amount == 0) return 0;
+    return Hash::key(FACT_STOCKPILE, player,
+        Hash::string(resource->getName()), amount);
+}
+
+Hash::Value StateHash::technology(int player, const Technology * technology) {
+    return Hash::key(FACT_TECHNOLOGY, player,
+        Hash::string(technology->getName()));
+}
+
+Hash::Value StateHash::treaty(int player, int other, const Treaty & treaty) {
+    Treaty initial;
+    if (treaty.getMission() == initial.getMission() &&
+        treaty.getGrant() == initial.getGrant() &&
+        treaty.getSubsidy() == initial.getSubsidy() &&
+        treaty.getBoycott() == initial.getBoycott() &&
+        treaty.getRelationship() == initial.getRelationship())
+        return 0;
+    return Hash::key(FACT_TREATY, player, other,
+        Hash::combine(treaty.getMission(), treaty.getBoycott()),
+        Hash::combine(Hash::combine(treaty.getGrant(), treaty.getSubsidy()),
+            treaty.getRelationship()));
+}
+
+Hash::Value StateHash::owner(Hash::Value group, const Player * owner) {
+    if (owner == NULL) return 0;
+    return Hash::key(FACT_OWNER, group, owner->getId());
+}
+
+Hash::Value StateHash::unit(Hash::Value group, const TileGroupUnit & unit) {
+    return Hash::key(FACT_UNIT, group, unit.getOwner().getId(),
+        Hash::combine(Hash::string(unit.getType().getName()),
+            Hash::string(unit.getLevel().getName())),
+        unit.getToughness());
+}
+
+Hash::Value StateHash::terrain(unsigned tile, const Terrain * terrain,
+        int yield) {
+    if (terrain == NULL) return 0;
+    return Hash::key(FACT_TERRAIN, tile, Hash::string(terrain->getName()),
+        yield);
+}
+
+Hash::Value StateHash::resource(unsigned tile, const Resource * resource) {
+    return Hash::key(FACT_RESOURCE, tile, Hash::string(resource->getName()));
+}
+
+Hash::Value StateHash::tileUnit(unsigned tile, const TileUnit * unit) {
+    if (unit == NULL) return 0;
+    return Hash::key(FACT_TILE_UNIT, tile, unit->getOwner().getId(),
+        Hash::string(unit->getType()->getName()));
+}
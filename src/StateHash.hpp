@@ -0,0 +1,175 @@
+//      StateHash.hpp -- A running fingerprint of the game state.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef STATEHASH_HPP_INCLUDED
+#define STATEHASH_HPP_INCLUDED
+
+#include "Hash.hpp"
+
+namespace Aftermath { class Player;
+                      class Resource;
+                      class Technology;
+                      class Terrain;
+                      class TileGroupUnit;
+                      class TileUnit;
+                      class Treaty; }
+
+/**
+ * @file StateHash.hpp
+ *
+ * A running fingerprint of the game state.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A StateHash is the sum of the keys of every fact about a game, like
+     * "player 2 has 500 money" or "tile 17 is hills with a yield of 1". The
+     * static functions below build those keys. Objects that belong to a
+     * Game hold a pointer to its StateHash and, whenever they change a
+     * fact, remove the key of the old fact and add the key of the new one.
+     * That keeps the fingerprint up to date at a constant cost per change.
+     *
+     * Keys are added rather than xor'ed, so two identical facts (like two
+     * identical units in the same province) do not cancel out. Facts that
+     * hold a default value, like an empty stockpile, have a key of 0.
+     *
+     * A StateHash also counts changes to borders, that is, to who owns each
+     * province and to the treaties between players. Caches that depend on
+     * borders, like the Pathfinder's, compare getBorders() to the count they
+     * were built at.
+     */
+    class StateHash {
+        public:
+            /**
+             * Constructs the hash of a game with no facts.
+             */
+            StateHash();
+
+            /**
+             * @return The fingerprint of every fact added so far.
+             */
+            Hash::Value getValue() const;
+
+            /**
+             * Adds a fact to the state.
+             *
+             * @param key - The key of the fact.
+             */
+            void add(Hash::Value key);
+
+            /**
+             * Removes a fact from the state.
+             *
+             * @param key - The key of the fact.
+             */
+            void remove(Hash::Value key);
+
+            /**
+             * Replaces one fact with another.
+             *
+             * @param before - The key of the old fact.
+             * @param after - The key of the new fact.
+             */
+            void replace(Hash::Value before, Hash::Value after);
+
+            /**
+             * @return The number of times that borders have changed.
+             */
+            unsigned getBorders() const;
+
+            /**
+             * Notes that the owner of a province or a treaty has changed.
+             */
+            void changeBorders();
+
+            /**
+             * @return The key of a player having an amount of money.
+             */
+            static Hash::Value money(int player, int money);
+
+            /**
+             * @return The key of a player having an amount of a resource.
+             */
+            static Hash::Value stockpile(int player, const Resource * resource,
+                int amount);
+
+            /**
+             * @return The key of a player knowing a technology.
+             */
+            static Hash::Value technology(int player,
+                const Technology * technology);
+
+            /**
+             * @return The key of a player's treaty with another player.
+             */
+            static Hash::Value treaty(int player, int other,
+                const Treaty & treaty);
+
+            /**
+             * @return The key of a TileGroup having an owner.
+             *
+             * @param group - The hash of the group's name.
+             * @param owner - The owner, which may be NULL.
+             */
+            static Hash::Value owner(Hash::Value group, const Player * owner);
+
+            /**
+             * @return The key of a unit being in a TileGroup.
+             *
+             * @param group - The hash of the group's name.
+             * @param unit - The unit.
+             */
+            static Hash::Value unit(Hash::Value group,
+                const TileGroupUnit & unit);
+
+            /**
+             * @return The key of a tile's terrain and yield.
+             *
+             * @param tile - The index of the tile in its map.
+             * @param terrain - The terrain, which may be NULL.
+             * @param yield - The yield of the tile.
+             */
+            static Hash::Value terrain(unsigned tile, const Terrain * terrain,
+                int yield);
+
+            /**
+             * @return The key of a resource being on a tile.
+             */
+            static Hash::Value resource(unsigned tile,
+                const Resource * resource);
+
+            /**
+             * @return The key of a TileUnit being on a tile.
+             *
+             * @param tile - The index of the tile in its map.
+             * @param unit - The unit, which may be NULL.
+             */
+            static Hash::Value tileUnit(unsigned tile, const TileUnit * unit);
+
+        private:
+            Hash::Value mValue;
+            unsigned mBorders;
+    };
+
+}
+
+#endif // STATEHASH_HPP_INCLUDED
@@ -0,0 +1,126 @@
+//      TechTree.cpp -- Prerequisites between technologies.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include "Technology.hpp"
+#include "TechTree.hpp"
+
+using namespace Aftermath;
+
+#define BITS 32
+
+TechTree::TechTree() {}
+
+bool TechTree::add(Technology * technology, const std::vector<const
+        Technology *> & prerequisites) {
+    if (technology->getId() >= 0) return false;
+    int id = mTechnology.size();
+    Mask required;
+    std::vector<const Technology *>::const_iterator itr;
+    for (itr = prerequisites.begin(); itr != prerequisites.end(); ++itr)
+        if (get((*itr)->getId()) != *itr) return false;
+    for (itr = prerequisites.begin(); itr != prerequisites.end(); ++itr) {
+        set(required, (*itr)->getId());
+        mDependents[(*itr)->getId()].push_back(id);
+    }
+    technology->setId(id);
+    mTechnology.push_back(technology);
+    mPrerequisites.push_back(required);
+    mDependents.push_back(std::vector<int>());
+    return true;
+}
+
+unsigned TechTree::size() const {
+    return mTechnology.size();
+}
+
+const Technology * TechTree::get(int id) const {
+    if (id < 0 || (unsigned) id >= mTechnology.size()) return NULL;
+    return mTechnology[id];
+}
+
+const TechTree::Mask & TechTree::getPrerequisites(const Technology *
+        technology) const {
+    return mPrerequisites[technology->getId()];
+}
+
+void TechTree::findResearchable(const Mask & known, Mask & researchable)
+        const {
+    researchable.assign((mTechnology.size() + BITS - 1) / BITS, 0);
+    unsigned id;
+    for (id = 0; id < mTechnology.size(); ++id)
+        if (!test(known, id) && contains(known, mPrerequisites[id]))
+            set(researchable, id);
+}
+
+void TechTree::grant(const Technology * technology, Mask & known,
+        Mask & researchable) const {
+    int id = technology->getId();
+    set(known, id);
+    set(researchable, id, false);
+    std::vector<int>::const_iterator itr;
+    for (itr = mDependents[id].begin(); itr != mDependents[id].end(); ++itr)
+        if (!test(known, *itr) && contains(known, mPrerequisites[*itr]))
+            set(researchable, *itr);
+}
+
+void TechTree::revoke(const Technology * technology, Mask & known,
+        Mask & researchable) const {
+    int id = technology->getId();
+    set(known, id, false);
+    set(researchable, id, contains(known, mPrerequisites[id]));
+    std::vector<int>::const_iterator itr;
+    for (itr = mDependents[id].begin(); itr != mDependents[id].end(); ++itr)
+        set(researchable, *itr, false);
+}
+
+bool TechTree::test(const Mask & mask, int id) {
+    if (id < 0 || (unsigned) id / BITS >= mask.size()) return false;
+    return (mask[id / BITS] >> (id % BITS)) & 1;
+}
+
+void TechTree::set(Mask & mask, int id, bool on) {
+    if (id < 0) return;
+    if ((unsigned) id / BITS >= mask.size()) {
+        if (!on) return;
+        mask.resize(id / BITS + 1, 0);
+    }
+    if (on) mask[id / BITS] |= 1UL << (id % BITS);
+    else mask[id / BITS] &= ~(1UL << (id % BITS));
+}
+
+bool TechTree::contains(const Mask & mask, const Mask & subset) {
+    unsigned word;
+    for (word = 0; word < subset.size(); ++word) {
+        sf::Uint32 have = word < mask.size() ? mask[word] : 0;
+        if (subset[word] & ~have) return false;
+    }
+    return true;
+}
+
+void TechTree::split(const Count<const Transferable *> & types,
+        Count<const Transferable *> & rest, Mask & technology) {
+    Count<const Transferable *>::const_iterator itr;
+    for (itr = types.begin(); itr != types.end(); ++itr) {
+        const Technology * tech =
+            dynamic_cast<const Technology *>(itr->first);
+        if (tech != NULL && tech->getId() >= 0 && itr->second > 0)
+            set(technology, tech->getId());
+        else rest[itr->first] = itr->second;
+    }
+}
@@ -0,0 +1,186 @@
+//      TechTree.hpp -- Prerequisites between technologies.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef TECHTREE_HPP_INCLUDED
+#define TECHTREE_HPP_INCLUDED
+
+#include <vector>
+
+#include <SFML/Config.hpp>
+
+#include "Count.hpp"
+
+namespace Aftermath { class Technology;
+                      class Transferable; }
+
+/**
+ * @file TechTree.hpp
+ *
+ * Prerequisites between technologies.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A TechTree holds the technologies of a Mod and what each of them
+     * requires. Every Technology added to the tree is given an id, counting
+     * up from 0, and sets of technologies are kept as bit masks over those
+     * ids. A Technology can only be added after all of its prerequisites,
+     * so the tree can never hold a cycle, and a technology's id is always
+     * greater than the ids of the technologies it requires.
+     *
+     * Players keep two masks: the technologies they know, and the ones they
+     * can research next. grant() and revoke() keep the second up to date by
+     * looking only at the technologies that directly require the one that
+     * changed.
+     */
+    class TechTree {
+        public:
+            /**
+             * A set of technologies, with one bit per id. Masks grow as
+             * needed, and missing words count as zero.
+             */
+            typedef std::vector<sf::Uint32> Mask;
+
+            /**
+             * Constructs an empty tree.
+             */
+            TechTree();
+
+            /**
+             * Adds a technology to this tree and gives it the next id.
+             *
+             * @param technology - The technology to add.
+             * @param prerequisites - The technologies that must be known
+             * before this one can be researched.
+             *
+             * @return true if the technology was added; false if it is
+             * already in a tree or one of its prerequisites is not in this
+             * one.
+             */
+            bool add(Technology * technology, const std::vector<const
+                Technology *> & prerequisites);
+
+            /**
+             * @return The number of technologies in this tree.
+             */
+            unsigned size() const;
+
+            /**
+             * @param id - The id of a technology.
+             *
+             * @return The technology with the given id, or NULL.
+             */
+            const Technology * get(int id) const;
+
+            /**
+             * @param technology - A technology in this tree.
+             *
+             * @return The mask of the technology's direct prerequisites.
+             */
+            const Mask & getPrerequisites(const Technology * technology)
+                const;
+
+            /**
+             * Fills a mask with every technology that is not known but
+             * whose prerequisites are. This looks at the whole tree, and is
+             * meant for setting a player up.
+             *
+             * @param known - The technologies that are known.
+             * @param researchable - Filled with the technologies that can be
+             * researched next.
+             */
+            void findResearchable(const Mask & known, Mask & researchable)
+                const;
+
+            /**
+             * Learns a technology. Only the technologies that directly
+             * require it can become researchable.
+             *
+             * @param technology - The technology to learn.
+             * @param known - The technologies that are known.
+             * @param researchable - The technologies that can be researched
+             * next, as found by findResearchable().
+             */
+            void grant(const Technology * technology, Mask & known,
+                Mask & researchable) const;
+
+            /**
+             * Forgets a technology. The technologies that directly require
+             * it can no longer be researched, and the technology itself can
+             * be if its prerequisites are still known.
+             *
+             * @param technology - The technology to forget.
+             * @param known - The technologies that are known.
+             * @param researchable - The technologies that can be researched
+             * next.
+             */
+            void revoke(const Technology * technology, Mask & known,
+                Mask & researchable) const;
+
+            /**
+             * @param mask - The mask to look in.
+             * @param id - The id of a technology.
+             *
+             * @return true if the technology is in the mask; false
+             * otherwise.
+             */
+            static bool test(const Mask & mask, int id);
+
+            /**
+             * Adds a technology to a mask or removes it.
+             *
+             * @param mask - The mask to change.
+             * @param id - The id of the technology.
+             * @param on - Whether the technology is in the mask.
+             */
+            static void set(Mask & mask, int id, bool on = true);
+
+            /**
+             * @param mask - The mask to look in.
+             * @param subset - The technologies to look for.
+             *
+             * @return true if every technology in the subset is in the
+             * mask; false otherwise.
+             */
+            static bool contains(const Mask & mask, const Mask & subset);
+
+            /**
+             * Separates the technologies in a cost from everything else, so
+             * that the technologies can be checked with a single mask test.
+             * The technologies must already be in a tree.
+             *
+             * @param types - The cost to split.
+             * @param rest - Given every type that is not a technology.
+             * @param technology - Given every technology in the cost.
+             */
+            static void split(const Count<const Transferable *> & types,
+                Count<const Transferable *> & rest, Mask & technology);
+
+        private:
+            std::vector<const Technology *> mTechnology;
+            std::vector<Mask> mPrerequisites;
+            std::vector<std::vector<int> > mDependents;
+    };
+
+}
+
+#endif // TECHTREE_HPP_INCLUDED
@@ -17,7 +17,6 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
-#include "Collection.hpp"
 #include "Player.hpp"
 #include "Technology.hpp"
 
@@ -25,10 +24,18 @@ using namespace Aftermath;
 
 Technology::Technology(const std::string & name, const std::string &
     description, const std::string & image) :
-        NamedType(name, description, image) {}
+        NamedType(name, description, image), mId(-1) {}
+
+int Technology::getId() const {
+    return mId;
+}
+
+void Technology::setId(int id) {
+    mId = id;
+}
 
 void Technology::giveTo(Player & player, int amount) const {
-    if (amount > 0) player.getTechnology().add(this);
+    if (amount > 0) player.giveTechnology(this);
 }
 
 bool Technology::canGiveTo(const Player & player, int amount) const {
@@ -36,10 +43,10 @@ bool Technology::canGiveTo(const Player & player, int amount) const {
 }
 
 void Technology::takeFrom(Player & player, int amount) const {
-    if (amount > 0) player.getTechnology().remove(this);
+    if (amount > 0) player.takeTechnology(this);
 }
 
 bool Technology::canTakeFrom(const Player & player, int amount) const {
-    return (amount == 0 && !player.getTechnology().contains(this)) ||
-           (amount >  0 &&  player.getTechnology().contains(this))  ;
+    return (amount == 0 && !player.hasTechnology(this)) ||
+           (amount >  0 &&  player.hasTechnology(this))  ;
 }
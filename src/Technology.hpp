@@ -38,7 +38,8 @@ namespace Aftermath { class Player; }
 namespace Aftermath {
 
     /**
-     * A Technology is a technological advance researched by a Player.
+     * A Technology is a technological advance researched by a Player. Its
+     * place in the Mod's TechTree is given by its id.
      */
     class Technology : public NamedType, public Transferable {
         public:
@@ -53,6 +54,19 @@ namespace Aftermath {
             Technology(const std::string & name, const std::string &
                 description, const std::string & image);
 
+            /**
+             * @return The id of this technology in its TechTree, or -1 if
+             * it has not been added to one.
+             */
+            int getId() const;
+
+            /**
+             * For use by TechTree. Sets the id of this technology.
+             *
+             * @param id - The new id.
+             */
+            void setId(int id);
+
             /**
              * This adds this technology to the given player's technology.
              *
@@ -91,6 +105,9 @@ namespace Aftermath {
              * and the amount is 0; false otherwise.
              */
             bool canTakeFrom(const Player & player, int amount = 0) const;
+
+        private:
+            int mId;
     };
 
 }
@@ -17,15 +17,18 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <algorithm>
+
 #include "Terrain.hpp"
 
 using namespace Aftermath;
 
 Terrain::Terrain(const std::string & name, const std::string & description,
     bool isLand, bool isSea, const std::string & image,
-    const std::map <const Resource *, float> * probabilities, bool isRevealed)
-        : NamedType(name, description, image), mLand(isLand), mSea(isSea),
-          mProbabilities(probabilities), mRevealed(isRevealed) {}
+    const std::map <const Resource *, float> * probabilities, bool isRevealed,
+    int moveCost) : NamedType(name, description, image), mLand(isLand),
+          mSea(isSea), mProbabilities(probabilities), mRevealed(isRevealed),
+          mMoveCost(moveCost < 1 ? 1 : moveCost) {}
 
 Terrain::~Terrain() {
     delete mProbabilities;
@@ -56,3 +59,16 @@ Terrain::iterator Terrain::end() const {
 bool Terrain::isRevealed() const {
     return mRevealed;
 }
+
+int Terrain::getMoveCost() const {
+    return mMoveCost;
+}
+
+void Terrain::update(Terrain & other) {
+    NamedType::update(other);
+    mLand = other.mLand;
+    mSea = other.mSea;
+    std::swap(mProbabilities, other.mProbabilities);
+    mRevealed = other.mRevealed;
+    mMoveCost = other.mMoveCost;
+}
@@ -62,11 +62,13 @@ namespace Aftermath {
              * generating resources for tiles.
              * @param isRevealed - Whether or not this terrain must be
              * surveyed to discover its resources.
+             * @param moveCost - The cost for a unit to enter a tile of this
+             * terrain type.
              */
             Terrain(const std::string & name, const std::string & description,
                 bool isLand, bool isSea, const std::string & image,
                 const std::map <const Resource *, float> * probabilities,
-                bool isRevealed);
+                bool isRevealed, int moveCost = 1);
 
             /**
              * Deletes this terrain and free its image and probabilities map.
@@ -123,11 +125,29 @@ namespace Aftermath {
              */
             bool isRevealed() const;
 
+            /**
+             * Gets the cost for a unit to enter a tile of this terrain type.
+             * Open ground and sea cost 1.
+             *
+             * @return The movement cost, at least 1.
+             */
+            int getMoveCost() const;
+
+            /**
+             * Takes the definition of another terrain, as when the terrain
+             * file is reloaded. The two terrains trade resource
+             * probabilities, so other frees the old ones.
+             *
+             * @param other - The new definition of this terrain.
+             */
+            void update(Terrain & other);
+
         private:
             bool mLand;
             bool mSea;
             const std::map<const Resource *, float> * mProbabilities;
             bool mRevealed;
+            int mMoveCost;
     };
 
 }
@@ -18,6 +18,7 @@
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
 #include "engine/Random.hpp"
+#include "StateHash.hpp"
 #include "Terrain.hpp"
 #include "Tile.hpp"
 #include "TileUnit.hpp"
@@ -25,14 +26,27 @@
 using namespace Aftermath;
 
 Tile::Tile(const Terrain * terrain, bool genResources) :
-        mTileGroup(NULL), mTileUnit(NULL), mYield(1) {
+        mTileGroup(NULL), mTerrain(NULL), mTileUnit(NULL), mYield(1),
+        mHash(NULL), mIndex(0) {
     setTerrain(terrain, genResources);
 }
 
 Tile::~Tile() {
+    attach(NULL, 0);
     delete mTileUnit;
 }
 
+void Tile::attach(StateHash * hash, unsigned index) {
+    if (mHash != NULL) mHash->remove(getFacts());
+    mHash = hash;
+    mIndex = index;
+    if (mHash != NULL) mHash->add(getFacts());
+}
+
+unsigned Tile::getIndex() const {
+    return mIndex;
+}
+
 TileGroup * Tile::getTileGroup() {
     return mTileGroup;
 }
@@ -50,7 +64,9 @@ const Terrain * Tile::getTerrain() const {
 }
 
 void Tile::setTerrain(const Terrain * terrain, bool genResources) {
+    Hash::Value before = getTerrainKey();
     mTerrain = terrain;
+    if (mHash != NULL) mHash->replace(before, getTerrainKey());
     if (genResources) {
         Terrain::iterator itr;
         for (itr = terrain->begin(); itr != terrain->end(); ++itr)
@@ -67,21 +83,57 @@ const TileUnit * Tile::getTileUnit() const {
 }
 
 void Tile::setTileUnit(TileUnit * unit) {
+    if (mHash != NULL)
+        mHash->replace(StateHash::tileUnit(mIndex, mTileUnit),
+            StateHash::tileUnit(mIndex, unit));
     mTileUnit = unit;
 }
 
-bool Tile::canAdd(const Resource *& resource) const {
+bool Tile::canAdd(const Resource * const & resource) const {
     return getTerrain()->getProbability(resource) > 0.0;
 }
 
+void Tile::add(const Resource * const & resource) {
+    if (contains(resource) || !canAdd(resource)) return;
+    SelectiveCollection<const Resource *>::add(resource);
+    if (mHash != NULL) mHash->add(StateHash::resource(mIndex, resource));
+}
+
+void Tile::remove(const Resource * const & resource) {
+    if (!contains(resource)) return;
+    SelectiveCollection<const Resource *>::remove(resource);
+    if (mHash != NULL) mHash->remove(StateHash::resource(mIndex, resource));
+}
+
+void Tile::clear() {
+    while (begin() != end()) remove(*begin());
+}
+
 int Tile::getYield() const {
     return mYield;
 }
 
 void Tile::setYield(int yield) {
+    Hash::Value before = getTerrainKey();
     mYield = yield;
+    if (mHash != NULL) mHash->replace(before, getTerrainKey());
 }
 
 void Tile::addYield(int yield) {
-    mYield += yield;
+    setYield(mYield + yield);
+}
+
+// The key of this tile's terrain and yield
+Hash::Value Tile::getTerrainKey() const {
+    return StateHash::terrain(mIndex, mTerrain, mYield);
+}
+
+// The sum of the keys of everything on this tile
+Hash::Value Tile::getFacts() const {
+    Hash::Value facts = getTerrainKey() +
+        StateHash::tileUnit(mIndex, mTileUnit);
+    const_iterator itr;
+    for (itr = begin(); itr != end(); ++itr)
+        facts += StateHash::resource(mIndex, *itr);
+    return facts;
 }
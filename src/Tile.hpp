@@ -20,9 +20,11 @@
 #ifndef TILE_HPP_INCLUDED
 #define TILE_HPP_INCLUDED
 
+#include "Hash.hpp"
 #include "SelectiveCollection.hpp"
 
 namespace Aftermath { class Resource;
+                      class StateHash;
                       class Terrain;
                       class TileGroup;
                       class TileUnit; }
@@ -64,6 +66,24 @@ namespace Aftermath {
              */
             ~Tile();
 
+            /**
+             * For use by Game. Adds this Tile's terrain, yield, resources,
+             * and TileUnit to the given state hash, and keeps them up to
+             * date from then on. The facts are removed from the previous
+             * hash, if any.
+             *
+             * @param hash - The hash of the game, or NULL.
+             * @param index - The index of this Tile in its map, which is
+             * row * columns + column.
+             */
+            void attach(StateHash * hash, unsigned index);
+
+            /**
+             * @return The index of this Tile in its map, as given to
+             * attach(), or 0 if it was never attached.
+             */
+            unsigned getIndex() const;
+
             /**
              * Gets the TileGroup that this Tile belongs to.
              *
@@ -136,7 +156,26 @@ namespace Aftermath {
              * @return true if this Tile's terrain type supports adding this
              * resource, false otherwise.
              */
-            bool canAdd(const Resource *& resource) const;
+            bool canAdd(const Resource * const & resource) const;
+
+            /**
+             * Adds a resource to this Tile, if canAdd() allows it.
+             *
+             * @param resource - The resource to add.
+             */
+            void add(const Resource * const & resource);
+
+            /**
+             * Removes a resource from this Tile.
+             *
+             * @param resource - The resource to remove.
+             */
+            void remove(const Resource * const & resource);
+
+            /**
+             * Removes all resources from this Tile.
+             */
+            void clear();
 
             /**
              * Gets the amount of each resource present that this Tile
@@ -166,6 +205,11 @@ namespace Aftermath {
             const Terrain * mTerrain;
             TileUnit * mTileUnit;
             int mYield;
+            StateHash * mHash;
+            unsigned mIndex;
+
+            Hash::Value getTerrainKey() const;
+            Hash::Value getFacts() const;
     };
 
 }
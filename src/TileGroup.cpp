@@ -17,18 +17,32 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include "AdjacencyGraph.hpp"
+#include "StateHash.hpp"
 #include "Tile.hpp"
 #include "TileGroup.hpp"
 #include "TileGroupUnit.hpp"
+#include "UnitCollection.hpp"
 
 using namespace Aftermath;
 
-TileGroup::TileGroup(const std::string & name) : mName(name) {}
+TileGroup::TileGroup(const std::string & name) : mUnits(NULL), mHash(NULL),
+    mAdjacency(NULL), mName(name) {}
 
 TileGroup::~TileGroup() {
-    SelectiveCollection<TileGroupUnit *>::iterator itr;
-    for (itr = getUnits().begin(); itr != getUnits().end(); ++itr)
-        delete *itr;
+    delete mUnits;
+}
+
+void TileGroup::attach(StateHash * hash) {
+    Hash::Value name = Hash::string(mName);
+    if (mHash != NULL) mHash->remove(StateHash::owner(name, getOwner()));
+    mHash = hash;
+    if (mHash != NULL) mHash->add(StateHash::owner(name, getOwner()));
+    mUnits->attach(mHash, name);
+}
+
+void TileGroup::setAdjacency(AdjacencyGraph * graph) {
+    mAdjacency = graph;
 }
 
 const std::string & TileGroup::getName() const {
@@ -36,7 +50,11 @@ const std::string & TileGroup::getName() const {
 }
 
 void TileGroup::setName(const std::string & name) {
+    // The name is part of every key of this group
+    StateHash * hash = mHash;
+    attach(NULL);
     mName = name;
+    attach(hash);
 }
 
 SelectiveCollection<TileGroupUnit *> & TileGroup::getUnits() {
@@ -48,7 +66,15 @@ const SelectiveCollection<const TileGroupUnit *> & TileGroup::getUnits()
     return *((SelectiveCollection<const TileGroupUnit *> *) ((void*) mUnits));
 }
 
-void TileGroup::add(Tile *& tile) {
+void TileGroup::add(Tile * const & tile) {
     SelectiveCollection<Tile *>::add(tile);
     tile->setTileGroup(this);
+    if (mAdjacency != NULL) mAdjacency->update(tile->getIndex());
+}
+
+void TileGroup::remove(Tile * const & tile) {
+    SelectiveCollection<Tile *>::remove(tile);
+    if (tile->getTileGroup() != this) return;
+    tile->setTileGroup(NULL);
+    if (mAdjacency != NULL) mAdjacency->update(tile->getIndex());
 }
@@ -24,9 +24,12 @@
 
 #include "SelectiveCollection.hpp"
 
-namespace Aftermath { class Player;
+namespace Aftermath { class AdjacencyGraph;
+                      class Player;
+                      class StateHash;
                       class Tile;
-                      class TileGroupUnit; }
+                      class TileGroupUnit;
+                      class UnitCollection; }
 
 /**
  * @file TileGroup.hpp
@@ -54,6 +57,23 @@ namespace Aftermath {
              */
             virtual ~TileGroup();
 
+            /**
+             * For use by Game. Adds this TileGroup's owner and units to the
+             * given state hash, and keeps them up to date from then on. The
+             * facts are removed from the previous hash, if any.
+             *
+             * @param hash - The hash of the game, or NULL.
+             */
+            void attach(StateHash * hash);
+
+            /**
+             * For use by Game. Tells the given graph whenever a tile joins
+             * or leaves this TileGroup.
+             *
+             * @param graph - The adjacency graph of the game, or NULL.
+             */
+            void setAdjacency(AdjacencyGraph * graph);
+
             /**
              * Gets the name of this TileGroup.
              *
@@ -91,7 +111,15 @@ namespace Aftermath {
              *
              * @param tile - The tile to add.
              */
-            void add(Tile *& tile);
+            void add(Tile * const & tile);
+
+            /**
+             * Removes a tile from this TileGroup. If the tile belonged to
+             * this group, it then belongs to no group.
+             *
+             * @param tile - The tile to remove.
+             */
+            void remove(Tile * const & tile);
 
             /**
              * Gets whether this TileGroup is a land-based group.
@@ -158,9 +186,16 @@ namespace Aftermath {
              * The unit list. This should be initialized in any derived
              * class's constructor.
              */
-            SelectiveCollection<TileGroupUnit *> * mUnits;
+            UnitCollection * mUnits;
+
+            /**
+             * The hash of the game, or NULL. Derived classes should update
+             * it when the owner changes.
+             */
+            StateHash * mHash;
 
         private:
+            AdjacencyGraph * mAdjacency;
             std::string mName;
     };
 
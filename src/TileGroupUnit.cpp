@@ -21,12 +21,35 @@
 #include "MerchantMarine.hpp"
 #include "Mod.hpp"
 #include "Player.hpp"
+#include "StateHash.hpp"
 #include "TileGroupUnit.hpp"
 #include "UnitLevel.hpp"
 #include "UnitType.hpp"
 
 using namespace Aftermath;
 
+// The storage of every unit
+static Pool<TileGroupUnit> & getPool() {
+    static Pool<TileGroupUnit> pool;
+    return pool;
+}
+
+// The hot fields of every unit, by slot. Slabs added to the pool since the
+// last call get entries for their free slots.
+static TileGroupUnit::Columns & getPoolColumns() {
+    static TileGroupUnit::Columns columns;
+    unsigned slots = getPool().getCapacity();
+    if (columns.types.size() < slots) {
+        columns.types.resize(slots, NULL);
+        columns.levels.resize(slots, NULL);
+        columns.power.resize(slots, 0);
+        columns.toughness.resize(slots, 0);
+        columns.owners.resize(slots, NULL);
+        columns.locations.resize(slots, NULL);
+    }
+    return columns;
+}
+
 // Give cargo to owner
 #define GIVE_CARGO(CARGO) \
     mOwner.give(mOwner.getGame().getMod().getMerchantMarine(), (CARGO))
@@ -37,12 +60,41 @@ using namespace Aftermath;
 
 TileGroupUnit::TileGroupUnit(const UnitType * type, Player & owner) :
         Upgradable(type->getLevels()),
-        mToughness(getLevel().getPower()), mType(type), mOwner(owner) {
+        mToughness(getLevel().getPower()), mType(type), mOwner(owner),
+        mHash(NULL), mGroup(0), mCargo(true),
+        mSlot(getPool().contains(this) ? getPool().find(this) : -1) {
     GIVE_CARGO(getLevel().getCargo());
+    store();
+}
+
+TileGroupUnit::TileGroupUnit(const UnitType * type, Player & owner,
+        int level) : Upgradable(type->getLevels(), level),
+        mToughness(type->getLevels()[0]->getPower()), mType(type), mOwner(owner),
+        mHash(NULL), mGroup(0), mCargo(true),
+        mSlot(getPool().contains(this) ? getPool().find(this) : -1) {
+    store();
 }
 
 TileGroupUnit::~TileGroupUnit() {
-    TAKE_CARGO(getLevel().getCargo());
+    attach(NULL, 0);
+    if (mCargo) TAKE_CARGO(getLevel().getCargo());
+    if (mSlot < 0) return;
+    Columns & columns = getPoolColumns();
+    columns.types[mSlot] = NULL;
+    columns.levels[mSlot] = NULL;
+    columns.power[mSlot] = 0;
+    columns.toughness[mSlot] = 0;
+    columns.owners[mSlot] = NULL;
+    columns.locations[mSlot] = NULL;
+}
+
+void TileGroupUnit::attach(StateHash * hash, Hash::Value group,
+        const UnitCollection * location) {
+    if (mHash != NULL) mHash->remove(StateHash::unit(mGroup, *this));
+    mHash = hash;
+    mGroup = group;
+    if (mHash != NULL) mHash->add(StateHash::unit(mGroup, *this));
+    if (mSlot >= 0) getPoolColumns().locations[mSlot] = location;
 }
 
 const UnitType & TileGroupUnit::getType() const {
@@ -54,11 +106,14 @@ int TileGroupUnit::getToughness() const {
 }
 
 void TileGroupUnit::setToughness(int toughness) {
+    Hash::Value before = StateHash::unit(mGroup, *this);
     mToughness = toughness;
+    if (mHash != NULL) mHash->replace(before, StateHash::unit(mGroup, *this));
+    store();
 }
 
 void TileGroupUnit::addToughness(int toughness) {
-    mToughness += toughness;
+    setToughness(mToughness + toughness);
 }
 
 const Player & TileGroupUnit::getOwner() const {
@@ -66,7 +121,58 @@ const Player & TileGroupUnit::getOwner() const {
 }
 
 void TileGroupUnit::finishUpgrade() {
-    TAKE_CARGO(getLevel().getCargo());
-    GIVE_CARGO(getNextLevel().getCargo());
+    Hash::Value before = StateHash::unit(mGroup, *this);
+    if (mCargo) {
+        TAKE_CARGO(getLevel().getCargo());
+        GIVE_CARGO(getNextLevel().getCargo());
+    }
     Upgradable<UnitLevel>::finishUpgrade();
+    if (mHash != NULL) mHash->replace(before, StateHash::unit(mGroup, *this));
+    store();
+}
+
+void TileGroupUnit::releaseCargo() {
+    mCargo = false;
+}
+
+Pool<TileGroupUnit>::Handle TileGroupUnit::getHandle() const {
+    return getPool().getHandle(this);
+}
+
+TileGroupUnit * TileGroupUnit::find(Pool<TileGroupUnit>::Handle handle) {
+    return getPool().get(handle);
+}
+
+unsigned TileGroupUnit::getSlotCount() {
+    return getPool().getCapacity();
+}
+
+TileGroupUnit * TileGroupUnit::getSlot(unsigned slot) {
+    return getPool().getSlot(slot);
+}
+
+const TileGroupUnit::Columns & TileGroupUnit::getColumns() {
+    return getPoolColumns();
+}
+
+// Copies this unit's hot fields into the columns
+void TileGroupUnit::store() const {
+    if (mSlot < 0) return;
+    Columns & columns = getPoolColumns();
+    columns.types[mSlot] = mType;
+    columns.levels[mSlot] = &getLevel();
+    columns.power[mSlot] = getLevel().getPower();
+    columns.toughness[mSlot] = mToughness;
+    columns.owners[mSlot] = &mOwner;
+}
+
+void * TileGroupUnit::operator new(std::size_t size) {
+    // Anything bigger than a unit can not share its slabs
+    if (size != sizeof(TileGroupUnit)) return ::operator new(size);
+    return getPool().allocate();
+}
+
+void TileGroupUnit::operator delete(void * unit, std::size_t size) {
+    if (size != sizeof(TileGroupUnit)) ::operator delete(unit);
+    else getPool().release(unit);
 }
@@ -20,9 +20,16 @@
 #ifndef TILEGROUPUNIT_HPP_INCLUDED
 #define TILEGROUPUNIT_HPP_INCLUDED
 
+#include <cstddef>
+#include <vector>
+
+#include "Hash.hpp"
+#include "Pool.hpp"
 #include "Upgradable.hpp"
 
 namespace Aftermath { class Player;
+                      class StateHash;
+                      class UnitCollection;
                       class UnitLevel;
                       class UnitType; }
 
@@ -39,9 +46,45 @@ namespace Aftermath {
     /**
      * A TileGroupUnit is a unit that travels across TileGroups. They are
      * primarily Army or Navy units.
+     *
+     * TileGroupUnits made with new live side by side in a shared Pool, so
+     * making and destroying them does not touch the general heap, and
+     * getSlot() walks every unit in memory order. A unit's Handle can be
+     * kept instead of a pointer, and safely looked up with find() after the
+     * unit is gone.
+     *
+     * The fields that passes over every unit read most are also kept in
+     * getColumns(), one array per field, indexed by slot. A pass that
+     * streams through those arrays touches far less memory than one that
+     * visits each unit, and only needs getSlot() for the units it changes.
+     *
+     * The columns are shared by every game, and every setter writes them
+     * without a lock. Units must only be changed, and the columns only be
+     * read, on one thread at a time; worker threads get copies of what
+     * they need.
      */
     class TileGroupUnit : public Upgradable<UnitLevel> {
         public:
+            /**
+             * The hot fields of every unit in the unit pool, indexed by
+             * slot. Free slots have a NULL type, level, owner, and
+             * location.
+             */
+            struct Columns {
+                /** The type of each unit. */
+                std::vector<const UnitType *> types;
+                /** The current level of each unit. */
+                std::vector<const UnitLevel *> levels;
+                /** The power of each unit's current level. */
+                std::vector<int> power;
+                /** The toughness of each unit. */
+                std::vector<int> toughness;
+                /** The owner of each unit. */
+                std::vector<const Player *> owners;
+                /** The collection that holds each unit, or NULL. */
+                std::vector<const UnitCollection *> locations;
+            };
+
             /**
              * Constructs a new TileGroupUnit of the given UnitType and adds
              * its merchant marine capacity to its owner.
@@ -51,12 +94,39 @@ namespace Aftermath {
              */
             TileGroupUnit(const UnitType * type, Player & owner);
 
+            /**
+             * For use by UnitType::spawn(). Constructs a new TileGroupUnit
+             * already at the given level, without touching its owner. The
+             * caller gives the owner the unit's merchant marine capacity.
+             * Like a unit upgraded from the first level, it starts with the
+             * toughness of the first level.
+             *
+             * @param type - The unit type of this unit.
+             * @param owner - The owner of this unit.
+             * @param level - The level to start at.
+             */
+            TileGroupUnit(const UnitType * type, Player & owner, int level);
+
             /**
              * Frees this TileGroupUnit and removes its merchant marine
              * capacity from its owner.
              */
             ~TileGroupUnit();
 
+            /**
+             * For use by UnitCollection. Adds this unit to the given state
+             * hash as a unit of the given group, and keeps it up to date
+             * from then on. The unit is removed from the previous hash, if
+             * any.
+             *
+             * @param hash - The hash of the game, or NULL.
+             * @param group - The hash of the name of the unit's TileGroup.
+             * @param location - The collection that holds the unit, or
+             * NULL if it is being removed.
+             */
+            void attach(StateHash * hash, Hash::Value group,
+                const UnitCollection * location = NULL);
+
             /**
              * Gets the UnitType of this unit.
              *
@@ -98,10 +168,65 @@ namespace Aftermath {
              */
             void finishUpgrade();
 
+            /**
+             * For use by UnitType::disband(). Makes the owner forget this
+             * unit's merchant marine capacity, so that destructing the unit
+             * does not take it. The caller takes it instead.
+             */
+            void releaseCargo();
+
+            /**
+             * @return The handle of this unit in the unit pool.
+             */
+            Pool<TileGroupUnit>::Handle getHandle() const;
+
+            /**
+             * @param handle - A handle returned by getHandle().
+             *
+             * @return The unit with the given handle, or NULL if it has been
+             * destroyed.
+             */
+            static TileGroupUnit * find(Pool<TileGroupUnit>::Handle handle);
+
+            /**
+             * @return The number of slots in the unit pool, live or not.
+             */
+            static unsigned getSlotCount();
+
+            /**
+             * @param slot - The number of a slot, less than getSlotCount().
+             *
+             * @return The unit in the given slot, or NULL if it is free.
+             */
+            static TileGroupUnit * getSlot(unsigned slot);
+
+            /**
+             * @return The hot fields of every unit in the unit pool. The
+             * arrays are getSlotCount() long, and change whenever a unit
+             * does, so they must not be read while units are changing.
+             */
+            static const Columns & getColumns();
+
+            /**
+             * Allocates a unit from the unit pool.
+             */
+            static void * operator new(std::size_t size);
+
+            /**
+             * Returns a unit to the unit pool.
+             */
+            static void operator delete(void * unit, std::size_t size);
+
         private:
             int mToughness;
             const UnitType * mType;
             Player & mOwner;
+            StateHash * mHash;
+            Hash::Value mGroup;
+            bool mCargo;
+            int mSlot;
+
+            void store() const;
     };
 
 }
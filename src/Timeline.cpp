@@ -0,0 +1,99 @@
+//      Timeline.cpp -- Events scheduled for later turns.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include "Game.hpp"
+#include "Mod.hpp"
+#include "Player.hpp"
+#include "Timeline.hpp"
+
+using namespace Aftermath;
+
+Event::Event() : mCancelled(false) {}
+
+Event::~Event() {}
+
+void Event::cancel() {
+    mCancelled = true;
+}
+
+bool Event::isCancelled() const {
+    return mCancelled;
+}
+
+TreatyEvent::TreatyEvent(int player, int other, const Treaty & treaty) :
+    mPlayer(player), mOther(other), mTreaty(treaty) {}
+
+void TreatyEvent::fire(Game & game) {
+    Player * player = game.getPlayer(mPlayer);
+    const Player * other = game.getPlayer(mOther);
+    if (player != NULL && other != NULL) player->setTreaty(other, mTreaty);
+}
+
+Timeline::Timeline(Game & game) : mGame(game), mOrder(0) {}
+
+Timeline::~Timeline() {
+    while (!mEvents.empty()) {
+        delete mEvents.top().event;
+        mEvents.pop();
+    }
+}
+
+void Timeline::schedule(Event * event, int turn) {
+    Entry entry;
+    entry.turn = turn;
+    entry.order = mOrder++;
+    entry.event = event;
+    mEvents.push(entry);
+}
+
+void Timeline::scheduleDate(Event * event, int date) {
+    const Mod & mod = mGame.getMod();
+    int perTurn = mod.getDatePerTurn(), turn = 0;
+    // The first turn whose date is not before the given one
+    if (perTurn > 0 && date > mod.getStartDate())
+        turn = (date - mod.getStartDate() + perTurn - 1) / perTurn;
+    schedule(event, turn);
+}
+
+int Timeline::advance() {
+    int fired = 0;
+    while (!mEvents.empty() && mEvents.top().turn <= mGame.getTurn()) {
+        Event * event = mEvents.top().event;
+        mEvents.pop();
+        if (!event->isCancelled()) {
+            event->fire(mGame);
+            ++fired;
+        }
+        delete event;
+    }
+    return fired;
+}
+
+int Timeline::getNextTurn() const {
+    return mEvents.empty() ? -1 : mEvents.top().turn;
+}
+
+unsigned Timeline::size() const {
+    return mEvents.size();
+}
+
+bool Timeline::Later::operator()(const Entry & a, const Entry & b) const {
+    if (a.turn != b.turn) return a.turn > b.turn;
+    return a.order > b.order;
+}
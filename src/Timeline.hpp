@@ -0,0 +1,192 @@
+//      Timeline.hpp -- Events scheduled for later turns.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef TIMELINE_HPP_INCLUDED
+#define TIMELINE_HPP_INCLUDED
+
+#include <queue>
+#include <vector>
+
+#include "Treaty.hpp"
+
+namespace Aftermath { class Game; }
+
+/**
+ * @file Timeline.hpp
+ *
+ * Events scheduled for later turns.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * An Event is something that happens to a Game on a given turn, such as
+     * a treaty running out or a scripted piece of history. Events are
+     * scheduled on a Timeline, which frees them once they have happened.
+     */
+    class Event {
+        public:
+            /**
+             * Constructs a new event that has not been cancelled.
+             */
+            Event();
+
+            /**
+             * Virtual destructor for Event.
+             */
+            virtual ~Event();
+
+            /**
+             * Keeps this event from happening. It is still freed by its
+             * Timeline when its turn comes.
+             */
+            void cancel();
+
+            /**
+             * @return true if this event has been cancelled; false
+             * otherwise.
+             */
+            bool isCancelled() const;
+
+            /**
+             * Makes this event happen.
+             *
+             * @param game - The game that this event happens in.
+             */
+            virtual void fire(Game & game) = 0;
+
+        private:
+            bool mCancelled;
+    };
+
+    /**
+     * A TreatyEvent changes the treaty between two players. Scheduling one
+     * with the default Treaty lets a treaty expire.
+     */
+    class TreatyEvent : public Event {
+        public:
+            /**
+             * Constructs a new event that sets a treaty.
+             *
+             * @param player - The id of the player that holds the treaty.
+             * @param other - The id of the player that the treaty is with.
+             * @param treaty - The new treaty.
+             */
+            TreatyEvent(int player, int other, const Treaty & treaty);
+
+            /**
+             * Sets the treaty, if both players are still in the game.
+             *
+             * @param game - The game that this event happens in.
+             */
+            void fire(Game & game);
+
+        private:
+            int mPlayer;
+            int mOther;
+            Treaty mTreaty;
+    };
+
+    /**
+     * A Timeline holds the events of a Game that have yet to happen, in a
+     * priority queue ordered by turn. At the start of every game turn, the
+     * Game fires the events that are due, so a turn costs time in the
+     * number of events that happen, not in the number still waiting.
+     *
+     * Events due on the same turn fire in the order they were scheduled, so
+     * every peer of a networked game sees the same history.
+     */
+    class Timeline {
+        public:
+            /**
+             * Constructs an empty timeline for the given game.
+             *
+             * @param game - The game that the events happen in.
+             */
+            Timeline(Game & game);
+
+            /**
+             * Frees every event that has not happened.
+             */
+            ~Timeline();
+
+            /**
+             * Schedules an event for a turn. An event for a turn that has
+             * already begun fires at the start of the next one.
+             *
+             * @param event - The event to schedule. The timeline takes
+             * ownership of it.
+             * @param turn - The game turn that the event happens on.
+             */
+            void schedule(Event * event, int turn);
+
+            /**
+             * Schedules an event for the first turn on or after a date.
+             *
+             * @param event - The event to schedule. The timeline takes
+             * ownership of it.
+             * @param date - The game date that the event happens on.
+             */
+            void scheduleDate(Event * event, int date);
+
+            /**
+             * Fires every event that is due by the current turn, in order,
+             * and frees them. Cancelled events are freed without firing.
+             * Events that those events schedule for the current turn fire
+             * too. This is called by the Game at the start of each turn.
+             *
+             * @return The number of events fired.
+             */
+            int advance();
+
+            /**
+             * @return The turn of the next event to happen, or -1 if there
+             * is none.
+             */
+            int getNextTurn() const;
+
+            /**
+             * @return The number of events waiting to happen, counting
+             * cancelled ones that have not been freed yet.
+             */
+            unsigned size() const;
+
+        private:
+            // An event and where it falls in the timeline
+            struct Entry {
+                int turn;
+                unsigned long order;
+                Event * event;
+            };
+
+            // Orders entries so that the earliest one is on top
+            struct Later {
+                bool operator()(const Entry & a, const Entry & b) const;
+            };
+
+            Game & mGame;
+            std::priority_queue<Entry, std::vector<Entry>, Later> mEvents;
+            unsigned long mOrder;
+    };
+
+}
+
+#endif // TIMELINE_HPP_INCLUDED
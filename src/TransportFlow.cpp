@@ -0,0 +1,425 @@
+//      TransportFlow -- Routes a player's resources to their capital.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <map>
+#include <utility>
+
+#include "AdjacencyGraph.hpp"
+#include "Game.hpp"
+#include "Mod.hpp"
+#include "Player.hpp"
+#include "Tile.hpp"
+#include "TileGroup.hpp"
+#include "TileMap.hpp"
+#include "TransportFlow.hpp"
+
+using namespace Aftermath;
+
+// An edge with no limit of its own
+#define UNLIMITED (INT_MAX / 4)
+
+// The cost of moving one unit from one group to the next
+#define STEP_COST 1
+
+// The residual graph of one resource's flow. The nodes are the groups of the
+// map, followed by the harbor's dock, the source, and the sink. Every edge is
+// stored next to its reverse, so edge ^ 1 is the reverse of edge, and the
+// edges themselves have even numbers.
+//
+// The graph has an edge for everything that could carry the resource:
+// every border, a supply edge into every group, a dock edge into every group
+// and a sink edge out of every group. The shape of the network is set by
+// the capacities alone, so a change of owner, capital or harbor only
+// changes a few capacities, and a new border only adds an edge.
+class TransportFlow::Graph {
+    public:
+        Graph(unsigned groups) : mGroups(groups), mDock(groups),
+            mSource(groups + 1), mSink(groups + 2), mEdges(groups + 3),
+            mChanged(true) {
+            unsigned group;
+            for (group = 0; group < groups; ++group) {
+                mSupplyEdge.push_back(add(mSource, group, 0, 0));
+                mDockEdge.push_back(add(mDock, group, 0, 0));
+                mSinkEdge.push_back(add(group, mSink, 0, 0));
+            }
+        }
+
+        int getFlow(int edge) const {
+            return mCapacity[edge] - mResidual[edge];
+        }
+
+        // The flow of a set of edges, one for each group
+        int getFlow(const std::vector<int> & edges) const {
+            int flow = 0;
+            std::vector<int>::const_iterator edge;
+            for (edge = edges.begin(); edge != edges.end(); ++edge)
+                flow += getFlow(*edge);
+            return flow;
+        }
+
+        // Changes the capacity of an edge. If the edge carries more than it
+        // can now take, the excess is taken back from the sink to the source.
+        void setCapacity(int edge, int capacity) {
+            if (capacity == mCapacity[edge]) return;
+            int flow = getFlow(edge);
+            if (capacity < flow) {
+                cancel(edge, flow - capacity);
+                flow = capacity;
+            }
+            mChanged = true;
+            mCapacity[edge] = capacity;
+            mResidual[edge] = capacity - flow;
+        }
+
+        // Sets the capacity of the link from one group to another, adding
+        // the link if it is new. A link into the harbor ends at the dock,
+        // since unloading is limited by the merchant marine.
+        void link(int group, int next, bool dock, int capacity) {
+            std::map<std::pair<int, int>, int>::iterator found =
+                mLinks.find(std::make_pair(group, next));
+            if (found == mLinks.end()) {
+                if (capacity == 0) return;
+                mLinks[std::make_pair(group, next)] =
+                    add(group, dock ? mDock : next, capacity, STEP_COST);
+                mChanged = true;
+                return;
+            }
+            setCapacity(found->second, capacity);
+        }
+
+        // Closes the links to groups that no longer border each other
+        void unlink(const AdjacencyGraph & adjacency) {
+            std::map<std::pair<int, int>, int>::iterator itr;
+            for (itr = mLinks.begin(); itr != mLinks.end(); ++itr)
+                if (adjacency.getBorder(itr->first.first,
+                        itr->first.second) == 0)
+                    setCapacity(itr->second, 0);
+        }
+
+        // Brings the flow up to the most that the network can carry, at the
+        // least cost
+        void augment() {
+            if (mChanged) cancelCycles();
+            mChanged = false;
+            unsigned nodes = mEdges.size();
+            for (;;) {
+                std::vector<int> distance(nodes, INT_MAX), through(nodes, -1);
+                std::vector<bool> queued(nodes, false);
+                std::deque<int> queue;
+                distance[mSource] = 0;
+                queue.push_back(mSource);
+                while (!queue.empty()) {
+                    int node = queue.front();
+                    queue.pop_front();
+                    queued[node] = false;
+                    std::vector<int>::const_iterator edge;
+                    for (edge = mEdges[node].begin();
+                            edge != mEdges[node].end(); ++edge) {
+                        int next = mTo[*edge];
+                        if (mResidual[*edge] <= 0 ||
+                            distance[node] + mCost[*edge] >= distance[next])
+                            continue;
+                        distance[next] = distance[node] + mCost[*edge];
+                        through[next] = *edge;
+                        if (!queued[next]) {
+                            queued[next] = true;
+                            queue.push_back(next);
+                        }
+                    }
+                }
+                if (through[mSink] < 0) return;
+                int amount = UNLIMITED, node;
+                for (node = mSink; node != mSource;
+                        node = mTo[through[node] ^ 1])
+                    amount = std::min(amount, mResidual[through[node]]);
+                for (node = mSink; node != mSource;
+                        node = mTo[through[node] ^ 1])
+                    push(through[node], amount);
+            }
+        }
+
+        const unsigned mGroups;
+        const int mDock, mSource, mSink;
+        std::vector<int> mSupplyEdge, mDockEdge, mSinkEdge;
+
+    private:
+        std::vector<std::vector<int> > mEdges;
+        std::vector<int> mTo, mCapacity, mResidual, mCost;
+        // The edge of each link between groups
+        std::map<std::pair<int, int>, int> mLinks;
+        // Whether a capacity has changed since the last augment()
+        bool mChanged;
+
+        int add(int from, int to, int capacity, int cost) {
+            int edge = mTo.size();
+            mTo.push_back(to);
+            mCapacity.push_back(capacity);
+            mResidual.push_back(capacity);
+            mCost.push_back(cost);
+            mEdges[from].push_back(edge);
+            mTo.push_back(from);
+            mCapacity.push_back(0);
+            mResidual.push_back(0);
+            mCost.push_back(-cost);
+            mEdges[to].push_back(edge + 1);
+            return edge;
+        }
+
+        void push(int edge, int amount) {
+            mResidual[edge] -= amount;
+            mResidual[edge ^ 1] += amount;
+        }
+
+        // Takes back units that pass through an edge. Every link costs
+        // something, so a least cost flow has no cycles, and following
+        // edges that carry flow always leads back to the source and on to
+        // the sink.
+        void cancel(int edge, int amount) {
+            while (amount > 0 && getFlow(edge) > 0) {
+                std::vector<int> path(1, edge);
+                int node = mTo[edge ^ 1];
+                while (node != mSource && (edge = carrying(node, 1)) >= 0) {
+                    path.push_back(edge);
+                    node = mTo[edge ^ 1];
+                }
+                node = mTo[path.front()];
+                while (node != mSink && (edge = carrying(node, 0)) >= 0) {
+                    path.push_back(edge);
+                    node = mTo[edge];
+                }
+                edge = path.front();
+                int taken = amount;
+                std::vector<int>::const_iterator itr;
+                for (itr = path.begin(); itr != path.end(); ++itr)
+                    taken = std::min(taken, getFlow(*itr));
+                for (itr = path.begin(); itr != path.end(); ++itr)
+                    push(*itr ^ 1, taken);
+                amount -= taken;
+            }
+        }
+
+        // Finds an edge carrying flow into a node (side 1) or out of it
+        // (side 0), or returns -1
+        int carrying(int node, int side) const {
+            std::vector<int>::const_iterator edge;
+            for (edge = mEdges[node].begin(); edge != mEdges[node].end();
+                    ++edge)
+                if ((*edge & 1) == side && getFlow(*edge & ~1) > 0)
+                    return *edge & ~1;
+            return -1;
+        }
+
+        // Reroutes flow around every cycle of negative cost in the residual
+        // graph, so that the flow is again the cheapest for its size. New
+        // links and capacities can open cheaper routes for units that are
+        // already flowing.
+        void cancelCycles() {
+            unsigned nodes = mEdges.size();
+            for (;;) {
+                // Start from every node at once, to find every cycle
+                std::vector<int> distance(nodes, 0), through(nodes, -1);
+                std::vector<unsigned> relaxed(nodes, 0);
+                std::vector<bool> queued(nodes, true);
+                std::deque<int> queue;
+                unsigned i;
+                for (i = 0; i < nodes; ++i) queue.push_back(i);
+                int cycle = -1;
+                while (!queue.empty() && cycle < 0) {
+                    int node = queue.front();
+                    queue.pop_front();
+                    queued[node] = false;
+                    std::vector<int>::const_iterator edge;
+                    for (edge = mEdges[node].begin();
+                            edge != mEdges[node].end(); ++edge) {
+                        int next = mTo[*edge];
+                        if (mResidual[*edge] <= 0 ||
+                            distance[node] + mCost[*edge] >= distance[next])
+                            continue;
+                        distance[next] = distance[node] + mCost[*edge];
+                        through[next] = *edge;
+                        if (++relaxed[next] >= nodes) {
+                            relaxed[next] = 0;
+                            if ((cycle = findCycle(through)) >= 0) break;
+                        }
+                        if (!queued[next]) {
+                            queued[next] = true;
+                            queue.push_back(next);
+                        }
+                    }
+                }
+                if (cycle < 0) return;
+                int amount = UNLIMITED, edge = cycle;
+                do {
+                    amount = std::min(amount, mResidual[edge]);
+                    edge = through[mTo[edge ^ 1]];
+                } while (edge != cycle);
+                do {
+                    push(edge, amount);
+                    edge = through[mTo[edge ^ 1]];
+                } while (edge != cycle);
+            }
+        }
+
+        // Finds a cycle among the edges that last lowered each node's
+        // distance, and returns one of its edges, or -1 if there is none
+        int findCycle(const std::vector<int> & through) const {
+            std::vector<int> seen(through.size(), -1);
+            int start;
+            for (start = 0; start < (int) through.size(); ++start) {
+                int node = start;
+                while (node >= 0 && seen[node] < 0) {
+                    seen[node] = start;
+                    node = through[node] < 0 ? -1 : mTo[through[node] ^ 1];
+                }
+                if (node >= 0 && seen[node] == start) return through[node];
+            }
+            return -1;
+        }
+};
+
+TransportFlow::TransportFlow() : mVersion(0), mCapital(-1), mHarbor(-1),
+    mSolves(0) {}
+
+TransportFlow::~TransportFlow() {
+    std::map<const Resource *, Graph *>::iterator itr;
+    for (itr = mGraphs.begin(); itr != mGraphs.end(); ++itr)
+        delete itr->second;
+}
+
+void TransportFlow::update(const Player & player, int capacity,
+        int marine) {
+    const TileMap & map = player.getGame().getMap();
+    const AdjacencyGraph & adjacency = player.getGame().getAdjacency();
+    unsigned groups = adjacency.getGroupCount(), group;
+
+    // Groups are only renumbered when the map gains a group
+    if (!mGraphs.empty() && mGraphs.begin()->second->mGroups != groups) {
+        std::map<const Resource *, Graph *>::iterator itr;
+        for (itr = mGraphs.begin(); itr != mGraphs.end(); ++itr)
+            delete itr->second;
+        mGraphs.clear();
+    }
+
+    // A change to the shape of the network reshapes every graph in place
+    std::vector<bool> owned(groups, false);
+    for (group = 0; group < groups; ++group)
+        owned[group] = adjacency.getGroup(group)->isLand() &&
+                       adjacency.getGroup(group)->getOwner() == &player;
+    int capital = adjacency.find(player.getCapital());
+    int harbor = adjacency.find(player.getHarbor());
+    if (capital >= 0 && !owned[capital]) capital = -1;
+    if (harbor >= 0 && !owned[harbor]) harbor = -1;
+    bool reshape = owned != mOwned || capital != mCapital ||
+                   harbor != mHarbor || adjacency.getVersion() != mVersion;
+    mOwned = owned;
+    mVersion = adjacency.getVersion();
+    mCapital = capital;
+    mHarbor = harbor;
+
+    // Add up the supply of every resource
+    std::map<const Resource *, std::vector<int> > supply;
+    unsigned row, column;
+    for (row = 0; row < map.rows(); ++row) {
+        for (column = 0; column < map.columns(); ++column) {
+            const Tile & tile = map(row, column);
+            int index = adjacency.getTileGroup(row * map.columns() + column);
+            if (index < 0 || !mOwned[index]) continue;
+            Tile::const_iterator itr;
+            for (itr = tile.begin(); itr != tile.end(); ++itr) {
+                std::vector<int> & amounts = supply[*itr];
+                if (amounts.empty()) amounts.assign(groups, 0);
+                amounts[index] += tile.getYield();
+            }
+        }
+    }
+
+    // Route each resource with what capacity is left
+    int remaining = mCapital < 0 ? 0 : std::max(capacity, 0);
+    int marineLeft = mHarbor < 0 ? 0 : std::max(marine, 0);
+    const std::map<std::string, const Resource *> & resources =
+        player.getGame().getMod().getResources();
+    std::map<std::string, const Resource *>::const_iterator itr;
+    for (itr = resources.begin(); itr != resources.end(); ++itr) {
+        std::vector<int> & amounts = supply[itr->second];
+        if (amounts.empty()) amounts.assign(groups, 0);
+        Graph *& graph = mGraphs[itr->second];
+        if (graph == NULL) {
+            graph = new Graph(groups);
+            shape(*graph, adjacency);
+            ++mSolves;
+        } else if (reshape) {
+            shape(*graph, adjacency);
+        }
+        for (group = 0; group < groups; ++group) {
+            graph->setCapacity(graph->mSupplyEdge[group], amounts[group]);
+            graph->setCapacity(graph->mDockEdge[group],
+                (int) group == mHarbor ? marineLeft : 0);
+            graph->setCapacity(graph->mSinkEdge[group],
+                (int) group == mCapital ? remaining : 0);
+        }
+        graph->augment();
+        remaining -= graph->getFlow(graph->mSinkEdge);
+        marineLeft -= graph->getFlow(graph->mDockEdge);
+    }
+}
+
+int TransportFlow::getRouted(const Resource * resource) const {
+    std::map<const Resource *, Graph *>::const_iterator itr =
+        mGraphs.find(resource);
+    return itr == mGraphs.end() ? 0 :
+        itr->second->getFlow(itr->second->mSinkEdge);
+}
+
+int TransportFlow::getShipped(const Resource * resource) const {
+    std::map<const Resource *, Graph *>::const_iterator itr =
+        mGraphs.find(resource);
+    return itr == mGraphs.end() ? 0 :
+        itr->second->getFlow(itr->second->mDockEdge);
+}
+
+unsigned TransportFlow::getSolveCount() const {
+    return mSolves;
+}
+
+// Opens the links that the player can use and closes the rest
+void TransportFlow::shape(Graph & graph,
+        const AdjacencyGraph & adjacency) const {
+    graph.unlink(adjacency);
+    unsigned groups = adjacency.getGroupCount(), group, edge;
+    for (group = 0; group < groups; ++group) {
+        bool sea = adjacency.getGroup(group)->isSea();
+        for (edge = adjacency.begin(group); edge != adjacency.end(group);
+                ++edge) {
+            int next = adjacency.getNeighbour(edge);
+            if (adjacency.getLength(edge) <= 0) continue;
+            bool nextSea = adjacency.getGroup(next)->isSea();
+            int capacity = 0;
+            if (mOwned[group])
+                // Overland to our own provinces, or onto the sea
+                capacity = mOwned[next] || nextSea ? UNLIMITED : 0;
+            else if (sea)
+                // Across the sea, but only ashore at the harbor
+                capacity = nextSea || next == mHarbor ? UNLIMITED : 0;
+            graph.link(group, next, sea && !nextSea, capacity);
+        }
+    }
+}
@@ -0,0 +1,126 @@
+//      TransportFlow -- Routes a player's resources to their capital.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef TRANSPORTFLOW_HPP_INCLUDED
+#define TRANSPORTFLOW_HPP_INCLUDED
+
+#include <map>
+#include <vector>
+
+namespace Aftermath { class AdjacencyGraph;
+                      class Player;
+                      class Resource; }
+
+/**
+ * @file TransportFlow.hpp
+ *
+ * Routes a player's resources to their capital.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A TransportFlow works out how much of each resource a player can move
+     * from their provinces to their capital. Every TileGroup on the map is a
+     * node, joined to the groups it borders in Game::getAdjacency().
+     * Resources travel overland between the player's own provinces, and can
+     * be loaded onto the sea from any coastal province, but can only come
+     * back ashore at the player's harbor. The yield of each resource in a
+     * province is its supply.
+     *
+     * Each resource is routed with a minimum cost flow, one resource at a
+     * time in name order. The total delivered to the capital is limited by
+     * the transport capacity, and the total unloaded at the harbor by the
+     * merchant marine; both are shared by all resources.
+     *
+     * The flow of every resource is kept between calls to update(), and is
+     * repaired rather than routed again. The graph of each resource has an
+     * edge for every border the resource could cross, so a change of
+     * owner, capital or harbor only changes the capacities of a few edges,
+     * and a new border adds one. Where an edge loses capacity, just the
+     * units that crossed it are taken back; where one gains capacity, the
+     * flow is rerouted around any cheaper cycle it opens. The flow is then
+     * augmented, so a quiet turn costs a single path search per resource.
+     * A resource is only routed from scratch the first time, or when the
+     * map gains a group.
+     */
+    class TransportFlow {
+        public:
+            /**
+             * Constructs an empty TransportFlow.
+             */
+            TransportFlow();
+
+            /**
+             * Destructs this TransportFlow.
+             */
+            ~TransportFlow();
+
+            /**
+             * Routes the player's resources again, reusing as much of the
+             * previous flow as possible.
+             *
+             * @param player - The player whose resources to route.
+             * @param capacity - The total units that can be delivered to the
+             * capital.
+             * @param marine - The total units that can be shipped by sea.
+             */
+            void update(const Player & player, int capacity, int marine);
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The units of the resource delivered to the capital by
+             * the last update().
+             */
+            int getRouted(const Resource * resource) const;
+
+            /**
+             * @param resource - The resource to check.
+             *
+             * @return The units of the resource that were shipped by sea in
+             * the last update().
+             */
+            int getShipped(const Resource * resource) const;
+
+            /**
+             * @return The number of times a resource has been routed from
+             * scratch.
+             */
+            unsigned getSolveCount() const;
+
+        private:
+            class Graph;
+
+            void shape(Graph & graph, const AdjacencyGraph & adjacency)
+                const;
+
+            std::vector<bool> mOwned;
+            unsigned mVersion;
+            int mCapital;
+            int mHarbor;
+            std::map<const Resource *, Graph *> mGraphs;
+            unsigned mSolves;
+    };
+
+}
+
+#endif // TRANSPORTFLOW_HPP_INCLUDED
@@ -17,11 +17,31 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include "Game.hpp"
+#include "Mod.hpp"
 #include "Player.hpp"
+#include "Resource.hpp"
+#include "TransportFlow.hpp"
 #include "TransportNetwork.hpp"
 
 using namespace Aftermath;
 
+TransportNetwork::TransportNetwork() : mCapacity(0), mMarine(0),
+    mFlow(new TransportFlow()) {}
+
+TransportNetwork::~TransportNetwork() {
+    delete mFlow;
+}
+
+void TransportNetwork::route(const Player & player) {
+    mFlow->update(player, mCapacity, mMarine);
+    const std::map<std::string, const Resource *> & resources =
+        player.getGame().getMod().getResources();
+    std::map<std::string, const Resource *>::const_iterator itr;
+    for (itr = resources.begin(); itr != resources.end(); ++itr)
+        mAvailable[itr->second] = mFlow->getRouted(itr->second);
+}
+
 int TransportNetwork::getAvailable(const Resource * resource) const {
     return mAvailable.getCount(resource);
 }
@@ -88,7 +108,7 @@ void TransportNetwork::startBidding(const Resource * resource) {
 }
 
 void TransportNetwork::cancelBidding(const Resource * resource) {
-    mBidding.add(resource);
+    mBidding.remove(resource);
 }
 
 int TransportNetwork::getCapacity() const {
@@ -107,3 +127,6 @@ void TransportNetwork::addMerchantMarine(int capacity) {
     mMarine += capacity;
 }
 
+int TransportNetwork::getShipped(const Resource * resource) const {
+    return mFlow->getShipped(resource);
+}
@@ -24,7 +24,8 @@
 #include "Count.hpp"
 
 namespace Aftermath { class Player;
-                      class Resource; }
+                      class Resource;
+                      class TransportFlow; }
 
 /**
  * @file TransportNetwork.hpp
@@ -43,6 +44,28 @@ namespace Aftermath {
      */
     class TransportNetwork {
         public:
+            /**
+             * Constructs a new TransportNetwork with no capacity.
+             */
+            TransportNetwork();
+
+            /**
+             * Destructs this TransportNetwork.
+             */
+            ~TransportNetwork();
+
+            /**
+             * Routes the yield of the player's provinces to their capital,
+             * within the capacity and merchant marine of this network, and
+             * sets the available resources to what arrives. This should be
+             * called at the start of every player's turn.
+             *
+             * @param player - The player that owns this network.
+             *
+             * @see TransportFlow
+             */
+            void route(const Player & player);
+
             /**
              * Gets the amount of the given resource type that is connected to
              * this transport network.
@@ -212,6 +235,16 @@ namespace Aftermath {
              */
             void addMerchantMarine(int capacity);
 
+            /**
+             * Gets the amount of the given resource type that reached the
+             * capital by sea in the last call to route().
+             *
+             * @param resource - The type of resource to check.
+             *
+             * @return The units of the resource that were shipped.
+             */
+            int getShipped(const Resource * resource) const;
+
         private:
             Count<const Resource *> mTransporting;
             Count<const Resource *> mAvailable;
@@ -219,6 +252,7 @@ namespace Aftermath {
             Collection<const Resource *> mBidding;
             int mCapacity;
             int mMarine;
+            TransportFlow * mFlow;
     };
 
 }
@@ -0,0 +1,101 @@
+//      TurnOrders.cpp -- The moves of one player for one turn.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include "Game.hpp"
+#include "Move.hpp"
+#include "TurnOrders.hpp"
+
+using namespace Aftermath;
+
+TurnOrders::TurnOrders(int player, int turn) : mPlayer(player), mTurn(turn),
+    mHash(0) {}
+
+int TurnOrders::getPlayer() const {
+    return mPlayer;
+}
+
+int TurnOrders::getTurn() const {
+    return mTurn;
+}
+
+Hash::Value TurnOrders::getHash() const {
+    return mHash;
+}
+
+void TurnOrders::setHash(Hash::Value hash) {
+    mHash = hash;
+}
+
+void TurnOrders::add(const Move & move) {
+    std::string * str = move.serialize();
+    mMoves.push_back(*str);
+    delete str;
+}
+
+const std::vector<std::string> & TurnOrders::getMoves() const {
+    return mMoves;
+}
+
+void TurnOrders::clear() {
+    mMoves.clear();
+}
+
+int TurnOrders::apply(Game & game) const {
+    int applied = 0;
+    std::vector<std::string>::const_iterator itr;
+    for (itr = mMoves.begin(); itr != mMoves.end(); ++itr) {
+        Move * move = Move::parse(*itr);
+        if (move == NULL) continue;
+        if (move->isLegal(game)) {
+            move->apply(game);
+            ++applied;
+        }
+        delete move;
+    }
+    return applied;
+}
+
+namespace Aftermath {
+
+    sf::Packet & operator <<(sf::Packet & packet, const TurnOrders & orders) {
+        packet << (sf::Int32) orders.mPlayer << (sf::Int32) orders.mTurn
+               << (sf::Uint32) (orders.mHash >> 32)
+               << (sf::Uint32) orders.mHash
+               << (sf::Uint32) orders.mMoves.size();
+        std::vector<std::string>::const_iterator itr;
+        for (itr = orders.mMoves.begin(); itr != orders.mMoves.end(); ++itr)
+            packet << *itr;
+        return packet;
+    }
+
+    sf::Packet & operator >>(sf::Packet & packet, TurnOrders & orders) {
+        sf::Int32 player, turn;
+        sf::Uint32 high, low, count;
+        if (!(packet >> player >> turn >> high >> low >> count))
+            return packet;
+        orders.mPlayer = player;
+        orders.mTurn = turn;
+        orders.mHash = Hash::make(high, low);
+        orders.mMoves.clear();
+        std::string move;
+        while (count-- > 0 && packet >> move) orders.mMoves.push_back(move);
+        return packet;
+    }
+
+}
@@ -0,0 +1,145 @@
+//      TurnOrders.hpp -- The moves of one player for one turn.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef TURNORDERS_HPP_INCLUDED
+#define TURNORDERS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <SFML/Network/Packet.hpp>
+
+#include "Hash.hpp"
+
+namespace Aftermath { class Game;
+                      class Move; }
+
+/**
+ * @file TurnOrders.hpp
+ *
+ * The moves of one player for one turn.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * The types of messages sent between a LockstepServer and its clients.
+     * Each packet starts with one of these as an sf::Uint8.
+     */
+    enum LockstepMessage {
+        LOCKSTEP_WELCOME, /**< Server to client: id and player count.    */
+        LOCKSTEP_ORDERS,  /**< Client to server: one player's orders.    */
+        LOCKSTEP_TURN,    /**< Server to client: every player's orders.  */
+        LOCKSTEP_DESYNC   /**< Server to client: the state hashes differ. */
+    };
+
+    /**
+     * TurnOrders are the serialized moves that one player makes in one turn
+     * of a lockstep game, along with that player's hash of the game state
+     * before the turn. Only the moves travel over the network, so the size
+     * of the orders depends on how much the player did, not on the size of
+     * the game.
+     */
+    class TurnOrders {
+        public:
+            /**
+             * Constructs empty orders for the given player and turn.
+             *
+             * @param player - The id of the player giving the orders.
+             * @param turn - The turn that the orders are for.
+             */
+            TurnOrders(int player = 0, int turn = 0);
+
+            /**
+             * @return The id of the player giving these orders.
+             */
+            int getPlayer() const;
+
+            /**
+             * @return The turn that these orders are for.
+             */
+            int getTurn() const;
+
+            /**
+             * Gets the state hash that the player computed before this turn.
+             *
+             * @return The value given to setHash(), or 0.
+             */
+            Hash::Value getHash() const;
+
+            /**
+             * Sets the state hash that the player computed before this turn.
+             *
+             * @param hash - The result of Game::hash().
+             */
+            void setHash(Hash::Value hash);
+
+            /**
+             * Serializes the given move and adds it to these orders.
+             *
+             * @param move - The move to add.
+             */
+            void add(const Move & move);
+
+            /**
+             * @return The serialized moves, in the order they were added.
+             */
+            const std::vector<std::string> & getMoves() const;
+
+            /**
+             * Removes all moves from these orders.
+             */
+            void clear();
+
+            /**
+             * Parses every move in these orders and applies the legal ones to
+             * the given game, in order. Moves that fail to parse or are not
+             * legal are skipped. Since every peer skips the same moves, this
+             * does not cause a desync.
+             *
+             * @param game - The game to apply the moves to.
+             *
+             * @return The number of moves that were applied.
+             */
+            int apply(Game & game) const;
+
+            /**
+             * Writes the given orders to a packet.
+             */
+            friend sf::Packet & operator <<(sf::Packet & packet,
+                const TurnOrders & orders);
+
+            /**
+             * Reads orders from a packet.
+             */
+            friend sf::Packet & operator >>(sf::Packet & packet,
+                TurnOrders & orders);
+
+        private:
+            int mPlayer;
+            int mTurn;
+            Hash::Value mHash;
+            std::vector<std::string> mMoves;
+    };
+
+}
+
+#endif // TURNORDERS_HPP_INCLUDED
@@ -0,0 +1,67 @@
+//      UnitCollection.cpp -- The units in a TileGroup.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <algorithm>
+
+#include "TileGroupUnit.hpp"
+#include "UnitCollection.hpp"
+
+using namespace Aftermath;
+
+UnitCollection::UnitCollection() : mHash(NULL), mGroup(0) {}
+
+UnitCollection::~UnitCollection() {}
+
+void UnitCollection::attach(StateHash * hash, Hash::Value group) {
+    mHash = hash;
+    mGroup = group;
+    iterator itr;
+    for (itr = begin(); itr != end(); ++itr)
+        (*itr)->attach(mHash, mGroup, this);
+}
+
+void UnitCollection::add(TileGroupUnit * const & unit) {
+    if (contains(unit) || !canAdd(unit)) return;
+    SelectiveCollection<TileGroupUnit *>::add(unit);
+    unit->attach(mHash, mGroup, this);
+}
+
+void UnitCollection::addAll(const std::vector<TileGroupUnit *> & units) {
+    // Sorted and without repeats, so each unit is attached once
+    std::vector<TileGroupUnit *> sorted(units), added;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    added.reserve(sorted.size());
+    std::vector<TileGroupUnit *>::const_iterator itr;
+    for (itr = sorted.begin(); itr != sorted.end(); ++itr)
+        if (!contains(*itr) && canAdd(*itr)) added.push_back(*itr);
+    Collection<TileGroupUnit *>::addAll(added);
+    for (itr = added.begin(); itr != added.end(); ++itr)
+        (*itr)->attach(mHash, mGroup, this);
+}
+
+void UnitCollection::remove(TileGroupUnit * const & unit) {
+    if (!contains(unit)) return;
+    SelectiveCollection<TileGroupUnit *>::remove(unit);
+    unit->attach(NULL, 0);
+}
+
+void UnitCollection::clear() {
+    while (begin() != end()) remove(*begin());
+}
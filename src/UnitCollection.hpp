@@ -0,0 +1,101 @@
+//      UnitCollection.hpp -- The units in a TileGroup.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef UNITCOLLECTION_HPP_INCLUDED
+#define UNITCOLLECTION_HPP_INCLUDED
+
+#include <vector>
+
+#include "Hash.hpp"
+#include "SelectiveCollection.hpp"
+
+namespace Aftermath { class StateHash;
+                      class TileGroupUnit; }
+
+/**
+ * @file UnitCollection.hpp
+ *
+ * The units in a TileGroup.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * A UnitCollection is the base of Army and Navy. It keeps the units it
+     * holds attached to the state hash of its TileGroup, so that adding,
+     * removing, damaging, or upgrading a unit updates the hash.
+     */
+    class UnitCollection : public SelectiveCollection<TileGroupUnit *> {
+        public:
+            /**
+             * Constructs an empty collection that is not part of a game.
+             */
+            UnitCollection();
+
+            /**
+             * Virtual destructor. This does not free the units.
+             */
+            virtual ~UnitCollection();
+
+            /**
+             * For use by TileGroup::attach(). Attaches every unit in this
+             * collection, and every unit added later, to the given hash.
+             *
+             * @param hash - The hash of the game, or NULL.
+             * @param group - The hash of the name of the TileGroup.
+             */
+            void attach(StateHash * hash, Hash::Value group);
+
+            /**
+             * Adds a unit, if canAdd() allows it.
+             *
+             * @param unit - The unit to add.
+             */
+            void add(TileGroupUnit * const & unit);
+
+            /**
+             * Adds several units at once, skipping any that canAdd() rejects
+             * or that are already here.
+             *
+             * @param units - The units to add.
+             */
+            void addAll(const std::vector<TileGroupUnit *> & units);
+
+            /**
+             * Removes a unit. This does not free the unit.
+             *
+             * @param unit - The unit to remove.
+             */
+            void remove(TileGroupUnit * const & unit);
+
+            /**
+             * Removes all units. This does not free the units.
+             */
+            void clear();
+
+        private:
+            StateHash * mHash;
+            Hash::Value mGroup;
+    };
+
+}
+
+#endif // UNITCOLLECTION_HPP_INCLUDED
@@ -24,9 +24,14 @@ using namespace Aftermath;
 UnitLevel::UnitLevel(const std::string & name, const std::string &
     description, const std::string & image, const Count<const Transferable
     *> * upgradeCost, const Count<const Transferable *> * autoUpgradeCost,
-    int power, int cargo) : NamedType(name, description, image),
-        Level(upgradeCost), mAutoCost(autoUpgradeCost), mPower(power),
-        mCargo(cargo) {}
+    int power, int cargo, int duration) :
+        NamedType(name, description, image), Level(upgradeCost, duration),
+        mAutoCost(NULL), mPower(power), mCargo(cargo) {
+    Count<const Transferable *> * rest = new Count<const Transferable *>();
+    TechTree::split(*autoUpgradeCost, *rest, mAutoTechnology);
+    delete autoUpgradeCost;
+    mAutoCost = rest;
+}
 
 UnitLevel::~UnitLevel() {
     delete mAutoCost;
@@ -36,6 +41,10 @@ const Count<const Transferable *> & UnitLevel::getAutoCost() const {
     return *mAutoCost;
 }
 
+const TechTree::Mask & UnitLevel::getAutoTechnology() const {
+    return mAutoTechnology;
+}
+
 int UnitLevel::getPower() const {
     return mPower;
 }
@@ -25,6 +25,7 @@
 #include "Count.hpp"
 #include "Level.hpp"
 #include "NamedType.hpp"
+#include "TechTree.hpp"
 
 namespace Aftermath { class Transferable; }
 
@@ -54,15 +55,18 @@ namespace Aftermath {
              * @param image - The image of the unit level.
              * @param upgradeCost - The cost to upgrade to this level.
              * @param autoUpgradeCost - The cost to automatically upgrade to
-             * this level at a ProductionCenter (as the unit is built).
+             * this level at a ProductionCenter (as the unit is built). Any
+             * Technology in it must already be in the Mod's TechTree.
              * @param power - The power of this unit. This is used in combat.
              * @param cargo - The amount of cargo that this unit can carry.
              * This is added to the merchant marine of its owner.
+             * @param duration - The number of turns that upgrading to this
+             * level takes.
              */
             UnitLevel(const std::string & name, const std::string &
                 description, const std::string & image, const Count<const
                 Transferable *> * upgradeCost, const Count<const Transferable
-                *> * autoUpgradeCost, int power, int cargo);
+                *> * autoUpgradeCost, int power, int cargo, int duration = 1);
 
             /**
              * Frees this level, its cost, and its auto cost.
@@ -71,13 +75,21 @@ namespace Aftermath {
 
             /**
              * Gets the cost that is required for a unit to upgrade to this
-             * level automatially when built at a ProductionCenter. This
-             * normally includes Technology objects, but not Resource objects.
+             * level automatially when built at a ProductionCenter, apart
+             * from its technology.
              *
              * @return A Count of the types required to automatically upgrade.
              */
             const Count<const Transferable *> & getAutoCost() const;
 
+            /**
+             * Gets the technology that is required for a unit to upgrade to
+             * this level automatically. This is taken out of the auto cost.
+             *
+             * @return A mask of the technology required.
+             */
+            const TechTree::Mask & getAutoTechnology() const;
+
             /**
              * Gets the power of this level. This is used to determine the
              * health and damage that this unit has and can inflict.
@@ -96,6 +108,7 @@ namespace Aftermath {
 
         private:
             const Count<const Transferable *> * mAutoCost;
+            TechTree::Mask mAutoTechnology;
             int mPower;
             int mCargo;
     };
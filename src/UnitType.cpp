@@ -17,6 +17,11 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <algorithm>
+
+#include "Game.hpp"
+#include "MerchantMarine.hpp"
+#include "Mod.hpp"
 #include "Player.hpp"
 #include "TileGroup.hpp"
 #include "TileGroupUnit.hpp"
@@ -52,19 +57,13 @@ const std::vector<const UnitLevel *> & UnitType::getLevels() const {
 int UnitType::getStartingLevel(const Player & player) const {
     std::vector<const UnitLevel *>::const_iterator itr;
     for (itr = mLevels->begin(); itr != mLevels->end() &&
-                                player.canTake((*itr)->getAutoCost()); ++itr);
+        player.hasTechnology((*itr)->getAutoTechnology()) &&
+        player.canTake((*itr)->getAutoCost()); ++itr);
     return itr - mLevels->begin();
 }
 
 void UnitType::giveTo(Player & player, int amount) const {
-    while (amount-- > 0) {
-        TileGroupUnit * unit = new TileGroupUnit(this, player);
-        int level = getStartingLevel(player);
-        while (level-- > 0) unit->finishUpgrade();
-        if (isLandUnit()) player.getCapital()->getUnits().add(unit);
-        else if (isSeaUnit()) player.getHarbor()->getUnits().add(unit);
-        else delete unit;
-    }
+    spawn(player, amount);
 }
 
 bool UnitType::canGiveTo(const Player & player, int amount) const {
@@ -76,3 +75,64 @@ void UnitType::takeFrom(Player & player, int amount) const {}
 bool UnitType::canTakeFrom(const Player & player, int amount) const {
     return true;
 }
+
+// Orders units weakest first
+static bool isWeaker(const TileGroupUnit * a, const TileGroupUnit * b) {
+    if (a->getToughness() != b->getToughness())
+        return a->getToughness() < b->getToughness();
+    if (a->getLevel().getPower() != b->getLevel().getPower())
+        return a->getLevel().getPower() < b->getLevel().getPower();
+    return a->getLevel().getName() < b->getLevel().getName();
+}
+
+int UnitType::spawn(Player & player, int amount) const {
+    TileGroup * group = NULL;
+    if (isLandUnit()) group = player.getCapital();
+    else if (isSeaUnit()) group = player.getHarbor();
+    if (group == NULL || amount <= 0) return 0;
+    int level = std::min(getStartingLevel(player), (int) mLevels->size() - 1);
+    std::vector<TileGroupUnit *> units;
+    units.reserve(amount);
+    int i;
+    for (i = 0; i < amount; ++i)
+        units.push_back(new TileGroupUnit(this, player, level));
+    group->getUnits().addAll(units);
+
+    // Units that the group turned away are never given to the player
+    int made = 0;
+    std::vector<TileGroupUnit *>::iterator unit;
+    for (unit = units.begin(); unit != units.end(); ++unit) {
+        if (group->getUnits().contains(*unit)) {
+            ++made;
+        } else {
+            (*unit)->releaseCargo();
+            delete *unit;
+        }
+    }
+    player.give(player.getGame().getMod().getMerchantMarine(),
+        made * (*mLevels)[level]->getCargo());
+    return made;
+}
+
+int UnitType::disband(Player & player, TileGroup & group, int amount) const {
+    std::vector<TileGroupUnit *> units;
+    SelectiveCollection<TileGroupUnit *>::iterator itr;
+    for (itr = group.getUnits().begin(); itr != group.getUnits().end(); ++itr)
+        if (&(*itr)->getType() == this && &(*itr)->getOwner() == &player)
+            units.push_back(*itr);
+    if (amount < (int) units.size()) {
+        std::partial_sort(units.begin(), units.begin() + std::max(amount, 0),
+            units.end(), isWeaker);
+        units.resize(std::max(amount, 0));
+    }
+    int cargo = 0;
+    std::vector<TileGroupUnit *>::iterator unit;
+    for (unit = units.begin(); unit != units.end(); ++unit) {
+        cargo += (*unit)->getLevel().getCargo();
+        group.getUnits().remove(*unit);
+        (*unit)->releaseCargo();
+        delete *unit;
+    }
+    player.take(player.getGame().getMod().getMerchantMarine(), cargo);
+    return units.size();
+}
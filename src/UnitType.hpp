@@ -27,6 +27,7 @@
 #include "Transferable.hpp"
 
 namespace Aftermath { class Player;
+                      class TileGroup;
                       class UnitLevel; }
 
 /**
@@ -139,6 +140,35 @@ namespace Aftermath {
              */
             bool canTakeFrom(const Player & player, int amount = 0) const;
 
+            /**
+             * Constructs many TileGroupUnits of this type at once and gives
+             * them to the given player, as giveTo() does. The starting level
+             * is worked out once, the merchant marine capacity of all of the
+             * units is given in one transfer, and the units are added to
+             * their province or sea together.
+             *
+             * @param player - The player to receive the units.
+             * @param amount - The number of units to make.
+             *
+             * @return The number of units made. This is 0 for a type that
+             * is neither a land nor a sea unit. Units that the province or
+             * sea does not accept are not made.
+             */
+            int spawn(Player & player, int amount) const;
+
+            /**
+             * Destroys many of the given player's TileGroupUnits of this
+             * type in a TileGroup at once, weakest first. Their merchant
+             * marine capacity is taken from the player in one transfer.
+             *
+             * @param player - The owner of the units.
+             * @param group - The group that holds the units.
+             * @param amount - The most units to destroy.
+             *
+             * @return The number of units destroyed.
+             */
+            int disband(Player & player, TileGroup & group, int amount) const;
+
         private:
             bool mLand;
             bool mSea;
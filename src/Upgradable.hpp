@@ -20,11 +20,13 @@
 #ifndef UPGRADABLE_HPP_INCLUDED
 #define UPGRADABLE_HPP_INCLUDED
 
+#include <cstddef>
 #include <vector>
 
 #include "Count.hpp"
+#include "UpgradeQueue.hpp"
 
-namespace Aftermath { class NamedType; }
+namespace Aftermath { class Transferable; }
 
 /**
  * @file Upgradable.hpp
@@ -41,24 +43,26 @@ namespace Aftermath {
      * of Resources and money. There are two methods of upgrading: upgrade()
      * will upgrade immediately and offer no chance to cancel the upgrade.
      * This is suitable for upgrades that happen in one turn like unit
-     * upgrades. startUpgrade() starts a turn-long upgrade, which can be
-     * cancelled at any time with cancelUpgrade(). A turn-long upgrade must
-     * be completed the next turn with finishUpgrade().
+     * upgrades. startUpgrade() starts an upgrade that takes the next level's
+     * Level::getDuration() turns, which can be cancelled at any time with
+     * cancelUpgrade(). The upgrade waits in the player's UpgradeQueue, which
+     * calls finishUpgrade() when its time is up.
      *
      * @param LevelType - The type of level to upgrade from and to. This
      * should be a derived class of Level.
      */
     template <class LevelType>
-    class Upgradable {
+    class Upgradable : public UpgradableBase {
         public:
             /**
-             * Constructs a new Upgradable at level 0 and with the given set
-             * of levels.
+             * Constructs a new Upgradable with the given set of levels.
              *
              * @param levels - The levels to upgrade through, starting at 0.
+             * @param level - The level to start at.
              */
-            Upgradable(const std::vector<const LevelType *> & levels) :
-                 mUpgrading(false), mLevel(0), mLevels(levels) {};
+            Upgradable(const std::vector<const LevelType *> & levels,
+                       int level = 0) :
+                 mUpgrading(false), mLevel(level), mLevels(levels) {};
 
             /**
              * Virtual destructor for this Upgradable. This does nothing.
@@ -100,7 +104,7 @@ namespace Aftermath {
              *
              * @return The cost of the next upgrade.
              */
-            const Count<const NamedType *> & getCost() const {
+            const Count<const Transferable *> & getCost() const {
                 return mLevels[mLevel + 1]->getCost();
             }
 
@@ -148,8 +152,9 @@ namespace Aftermath {
             }
 
             /**
-             * Starts a turn-long upgrade, deducting the required resoures and
-             * money from the given player. This upgrade can be finished with
+             * Starts an upgrade, deducting the required resoures and money
+             * from the given player, and adds it to the player's
+             * UpgradeQueue. This upgrade can be finished early with
              * finishUpgrade() or cancelled with cancelUpgrade().
              *
              * @param player - The player to pay for the upgrade.
@@ -158,10 +163,12 @@ namespace Aftermath {
             void startUpgrade(PlayerType & player) {
                 mUpgrading = true;
                 player.take(getCost());
+                player.getUpgrades().add(*this,
+                    getNextLevel().getDuration());
             }
 
             /**
-             * Cancels a turn-long upgrade, refunding the required money and
+             * Cancels an upgrade, refunding the required money and
              * resources.
              *
              * @param player - The player to refund.
@@ -170,15 +177,17 @@ namespace Aftermath {
             void cancelUpgrade(PlayerType & player) {
                 player.give(getCost());
                 mUpgrading = false;
+                if (getQueue() != NULL) getQueue()->remove(*this);
             }
 
             /**
-             * Completes a turn-long upgrade. This actually advances this
+             * Completes an upgrade. This actually advances this
              * Upgradable's level.
              */
             virtual void finishUpgrade() {
                 mUpgrading = false;
                 ++mLevel;
+                if (getQueue() != NULL) getQueue()->remove(*this);
             }
 
         private:
@@ -0,0 +1,87 @@
+//      UpgradeQueue.cpp -- Upgrades in progress.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#include <cstddef>
+
+#include "UpgradeQueue.hpp"
+
+using namespace Aftermath;
+
+UpgradableBase::UpgradableBase() : mQueue(NULL) {}
+
+UpgradableBase::~UpgradableBase() {
+    if (mQueue != NULL) mQueue->remove(*this);
+}
+
+UpgradeQueue * UpgradableBase::getQueue() const {
+    return mQueue;
+}
+
+void UpgradableBase::setQueue(UpgradeQueue * queue) {
+    mQueue = queue;
+}
+
+UpgradeQueue::UpgradeQueue() {}
+
+UpgradeQueue::~UpgradeQueue() {
+    unsigned i;
+    for (i = 0; i < mUpgrades.size(); ++i) mUpgrades[i].first->setQueue(NULL);
+}
+
+void UpgradeQueue::add(UpgradableBase & object, int turns) {
+    if (object.getQueue() != NULL) object.getQueue()->remove(object);
+    mUpgrades.push_back(std::make_pair(&object, turns < 1 ? 1 : turns));
+    object.setQueue(this);
+}
+
+void UpgradeQueue::remove(UpgradableBase & object) {
+    if (object.getQueue() != this) return;
+    std::vector<std::pair<UpgradableBase *, int> >::iterator itr;
+    for (itr = mUpgrades.begin(); itr->first != &object; ++itr);
+    mUpgrades.erase(itr);
+    object.setQueue(NULL);
+}
+
+int UpgradeQueue::advance() {
+    // Take the finished upgrades out first, since finishing may add more
+    std::vector<UpgradableBase *> done;
+    unsigned i, kept = 0;
+    for (i = 0; i < mUpgrades.size(); ++i) {
+        if (--mUpgrades[i].second > 0) {
+            mUpgrades[kept++] = mUpgrades[i];
+        } else {
+            mUpgrades[i].first->setQueue(NULL);
+            done.push_back(mUpgrades[i].first);
+        }
+    }
+    mUpgrades.resize(kept);
+    for (i = 0; i < done.size(); ++i) done[i]->finishUpgrade();
+    return done.size();
+}
+
+int UpgradeQueue::getTurnsLeft(const UpgradableBase & object) const {
+    if (object.getQueue() != this) return 0;
+    std::vector<std::pair<UpgradableBase *, int> >::const_iterator itr;
+    for (itr = mUpgrades.begin(); itr->first != &object; ++itr);
+    return itr->second;
+}
+
+unsigned UpgradeQueue::size() const {
+    return mUpgrades.size();
+}
@@ -0,0 +1,143 @@
+//      UpgradeQueue.hpp -- Upgrades in progress.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+#ifndef UPGRADEQUEUE_HPP_INCLUDED
+#define UPGRADEQUEUE_HPP_INCLUDED
+
+#include <utility>
+#include <vector>
+
+namespace Aftermath { class UpgradeQueue; }
+
+/**
+ * @file UpgradeQueue.hpp
+ *
+ * Upgrades in progress.
+ *
+ * @author Kevin Harrison <keharriso@gmail.com>
+ */
+
+namespace Aftermath {
+
+    /**
+     * UpgradableBase is the part of every Upgradable that does not depend on
+     * its type of level, so that an UpgradeQueue can hold any of them. An
+     * object leaves its queue when it is destructed.
+     */
+    class UpgradableBase {
+        public:
+            /**
+             * Constructs an object that is not in a queue.
+             */
+            UpgradableBase();
+
+            /**
+             * Removes this object from its queue, if any.
+             */
+            virtual ~UpgradableBase();
+
+            /**
+             * Completes an upgrade.
+             */
+            virtual void finishUpgrade() = 0;
+
+            /**
+             * @return The queue that this object is waiting in, or NULL.
+             */
+            UpgradeQueue * getQueue() const;
+
+            /**
+             * For use by UpgradeQueue. Records the queue that this object is
+             * waiting in.
+             *
+             * @param queue - The queue, or NULL.
+             */
+            void setQueue(UpgradeQueue * queue);
+
+        private:
+            UpgradeQueue * mQueue;
+    };
+
+    /**
+     * An UpgradeQueue holds one player's upgrades in progress, and how many
+     * turns each has left. advance() is called at the end of the player's
+     * turn and finishes every upgrade whose time is up, so the cost of a
+     * turn grows with the number of upgrades under way rather than with
+     * the number of things the player owns.
+     *
+     * Upgradable::startUpgrade() adds to the queue, and cancelling or
+     * finishing an upgrade early removes it.
+     */
+    class UpgradeQueue {
+        public:
+            /**
+             * Constructs an empty queue.
+             */
+            UpgradeQueue();
+
+            /**
+             * Forgets every upgrade in progress. The objects are not
+             * upgraded.
+             */
+            ~UpgradeQueue();
+
+            /**
+             * Starts waiting on an upgrade. An object that is already in a
+             * queue is moved to this one, and its time is reset.
+             *
+             * @param object - The object being upgraded.
+             * @param turns - The number of turns the upgrade takes.
+             */
+            void add(UpgradableBase & object, int turns);
+
+            /**
+             * Stops waiting on an upgrade, without finishing it.
+             *
+             * @param object - The object being upgraded.
+             */
+            void remove(UpgradableBase & object);
+
+            /**
+             * Counts down one turn and finishes every upgrade that is done,
+             * in the order they were started.
+             *
+             * @return The number of upgrades finished.
+             */
+            int advance();
+
+            /**
+             * @param object - An object being upgraded.
+             *
+             * @return The number of turns left on the object's upgrade, or
+             * 0 if it is not in this queue.
+             */
+            int getTurnsLeft(const UpgradableBase & object) const;
+
+            /**
+             * @return The number of upgrades in progress.
+             */
+            unsigned size() const;
+
+        private:
+            std::vector<std::pair<UpgradableBase *, int> > mUpgrades;
+    };
+
+}
+
+#endif // UPGRADEQUEUE_HPP_INCLUDED
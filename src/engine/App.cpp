@@ -38,13 +38,16 @@ using namespace Aftermath::Engine;
 #define DEFAULT_MINOR           0u
 
 #define DEFAULT_MOD             "Aix-La-Chapelle"
+#define DEFAULT_IMAGE_CACHE     64u
 #define MOD                     "application.game.mod"
+#define HOT_RELOAD              "application.game.hot_reload"
 #define LOGGING_OPTION          "application.logging.enabled"
 #define LOG_FILE                "application.logging.file"
 #define VIDEO                   "application.video"
+#define IMAGE_CACHE             "application.cache.images"
 
 App::App(const std::string & title) : mRunning(false), mTitle(title),
-    mStateManager(*this), mMod(*this) {}
+    mMod(*this), mStateManager(*this) {}
 
 void App::handleArgs(int argc, char * argv[]) {}
 
@@ -85,6 +88,19 @@ void App::init() {
         mLogger << "Mod configuration not found, using default" << std::endl;
     if (!mMod.load(MOD_FOLDER + mod))
         mLogger << "Error loading mod" << std::endl;
+    // Watch the mod's files while it is being worked on
+    bool hotReload = false;
+    mConfig.lookupValue(HOT_RELOAD, hotReload);
+    if (hotReload) {
+        if (mWatcher.watch(MOD_FOLDER + mod))
+            mLogger << "Watching mod for changes" << std::endl;
+        else mLogger << "Error watching mod for changes" << std::endl;
+    }
+    // Read the image memory budget, in megabytes
+    unsigned imageCache = DEFAULT_IMAGE_CACHE;
+    if (!mConfig.lookupValue(IMAGE_CACHE, imageCache))
+        mLogger << "Image cache size not found, using default" << std::endl;
+    mMod.setImageBudget(imageCache * 1024 * 1024);
     // Read window config
     sf::VideoMode mode(DEFAULT_WIDTH, DEFAULT_HEIGHT, DEFAULT_BPP);
     unsigned long style = DEFAULT_SYLE;
@@ -120,10 +136,11 @@ void App::init() {
     mWindow.Create(mode, mTitle, style, settings);
     mLogger << "Window created" << std::endl;
 
-    // Initialize states
-    mStateManager.addState(new(std::nothrow) MenuState(*this));
+    // Initialize states. The menu starts once the splash screen has loaded
+    // its images.
     mStateManager.addState(new(std::nothrow) SplashState("InitialSplash",
         3.0f, "gui/splash.png", *this));
+    mStateManager.addState(new(std::nothrow) MenuState(*this), false);
 }
 
 void App::run() {
@@ -143,6 +160,15 @@ void App::run() {
     while(isRunning() && mWindow.IsOpened() && !mStateManager.isEmpty()) {
         State * state = mStateManager.getActiveState();
 
+        // Reload any mod files that have changed
+        if (mWatcher.isWatching()) {
+            std::vector<std::string> changed;
+            mWatcher.poll(changed);
+            std::vector<std::string>::const_iterator path;
+            for (path = changed.begin(); path != changed.end(); ++path)
+                mMod.reload(*path);
+        }
+
         // Create a fixed rate Update loop
         while(updateClock.GetElapsedTime() > nextUpdate) {
             // Handle some events and let the current active state handle the rest
@@ -28,6 +28,7 @@
 
 #include "Logger.hpp"
 #include "../Mod.hpp"
+#include "../ModWatcher.hpp"
 #include "StateManager.hpp"
 
 /**
@@ -135,8 +136,11 @@ namespace Aftermath { namespace Engine {
             Logger mLogger;
             std::string mTitle;
             sf::RenderWindow mWindow;
-            StateManager mStateManager;
+            // The states hold sprites from the mod, so they must be
+            // destructed before it
             Mod mMod;
+            ModWatcher mWatcher;
+            StateManager mStateManager;
     };
 
 } }
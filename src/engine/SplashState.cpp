@@ -17,11 +17,18 @@
 //      You should have received a copy of the GNU General Public License
 //      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
 
+#include <SFML/Graphics/Shape.hpp>
+
 #include "App.hpp"
+#include "../AssetLoader.hpp"
 #include "SplashState.hpp"
 
 using namespace Aftermath::Engine;
 
+// The progress bar, in pixels
+#define BAR_HEIGHT 8
+#define BAR_MARGIN 16
+
 SplashState::SplashState(const std::string & id, float time, const std::string
     & image, App & app) : State(id, app), mTime(time), mImage(image) {}
 
@@ -30,18 +37,30 @@ SplashState::~SplashState() {}
 void SplashState::init() {
     State::init();
     mSplashSprite = mApp.getMod().newSprite(mImage);
+    mApp.getMod().preloadImages();
 }
 
 void SplashState::handleEvent(sf::Event & event) {}
 
 void SplashState::update() {
-    if(!isPaused() && getElapsedTime() > mTime)
+    if(!isPaused() && getElapsedTime() > mTime &&
+            mApp.getMod().getAssets().getProgress() >= 1) {
+        mApp.getMod().packImages();
         mApp.getStateManager().removeActiveState();
+    }
 }
 
 void SplashState::draw() {
     mApp.getWindow().Clear();
     mApp.getWindow().Draw(*mSplashSprite);
+    // Show how much of the mod has been loaded
+    float width = mApp.getWindow().GetWidth() - 2 * BAR_MARGIN;
+    float top = mApp.getWindow().GetHeight() - BAR_MARGIN - BAR_HEIGHT;
+    float progress = mApp.getMod().getAssets().getProgress();
+    mApp.getWindow().Draw(sf::Shape::Rectangle(BAR_MARGIN, top, width,
+        BAR_HEIGHT, sf::Color(64, 64, 64)));
+    mApp.getWindow().Draw(sf::Shape::Rectangle(BAR_MARGIN, top,
+        width * progress, BAR_HEIGHT, sf::Color::White));
 }
 
 void SplashState::cleanup() {
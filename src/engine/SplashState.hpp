@@ -37,7 +37,10 @@ namespace Aftermath { namespace Engine { class App; } }
 namespace Aftermath { namespace Engine {
 
     /**
-     * The SplashState shows a splash screen.
+     * The SplashState shows a splash screen while the Mod's images are
+     * preloaded in the background, with a bar along the bottom showing how
+     * many have been decoded. It stays up for at least its given time, and
+     * until every image is ready, then packs the images into the Mod's atlas.
      */
     class SplashState : public State {
         public:
@@ -45,7 +48,8 @@ namespace Aftermath { namespace Engine {
              * Constructs a new SplashState with the given App.
              *
              * @param id - The id of the new state.
-             * @param time - The duration of the splash screen, in seconds.
+             * @param time - The least duration of the splash screen, in
+             * seconds.
              * @param image - The path of the image to show.
              * @param app - The App of the new state.
              */
@@ -58,7 +62,7 @@ namespace Aftermath { namespace Engine {
             ~SplashState();
 
             /**
-             * Initializes this State
+             * Initializes this State and starts preloading images.
              */
             void init();
 
@@ -0,0 +1,181 @@
+//      LoopbackHarness.cpp -- Runs a lockstep game over the loopback device.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+// Usage: Aftermath-loopback [clients] [turns] [port] [desync turn]
+//
+// Forks one process per client and runs a LockstepServer in the parent, all
+// talking over 127.0.0.1. Each client makes a few moves per turn. With a
+// desync turn, client 0 quietly changes its own state on that turn, and the
+// harness checks that the server notices. The exit code is 0 when the run
+// went as expected.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../engine/App.hpp"
+#include "../Game.hpp"
+#include "../LockstepClient.hpp"
+#include "../LockstepServer.hpp"
+#include "../Move.hpp"
+#include "../Player.hpp"
+#include "../TileMap.hpp"
+
+using namespace Aftermath;
+
+#define DEFAULT_CLIENTS  4
+#define DEFAULT_TURNS    50
+#define DEFAULT_PORT     45000
+#define STARTING_MONEY   1000
+#define MOVES_PER_TURN   3
+
+// Exit codes of the client processes
+#define CLIENT_OK        0
+#define CLIENT_DESYNC    1
+#define CLIENT_ERROR     2
+
+// Pays money from one player to another
+class PayMove : public Move {
+    public:
+        PayMove(int from, int to, int amount) : mFrom(from), mTo(to),
+            mAmount(amount) {}
+
+        bool isLegal(const Game & game) const {
+            const Player * from = game.getPlayer(mFrom);
+            return from != NULL && game.getPlayer(mTo) != NULL &&
+                   mAmount >= 0 && from->getMoney() >= mAmount;
+        }
+
+        void apply(Game & game) const {
+            game.getPlayer(mFrom)->takeMoney(mAmount);
+            game.getPlayer(mTo)->giveMoney(mAmount);
+        }
+
+        std::string * serialize() const {
+            std::ostringstream out;
+            out << "pay " << mFrom << " " << mTo << " " << mAmount;
+            return new std::string(out.str());
+        }
+
+        static Move * parse(std::istream & in) {
+            int from, to, amount;
+            if (!(in >> from >> to >> amount)) return NULL;
+            return new PayMove(from, to, amount);
+        }
+
+    private:
+        int mFrom, mTo, mAmount;
+};
+
+// Plays one client's side of the game
+static int runClient(unsigned short port, int turns, int desyncTurn) {
+    Engine::App app("Aftermath loopback client");
+    Game game(new TileMap("Loopback", 0, 0), app.getMod());
+    LockstepClient client(game);
+    if (!client.connect(sf::IpAddress::LocalHost, port)) return CLIENT_ERROR;
+
+    // Every peer builds the same players in the same order
+    unsigned i;
+    for (i = 0; i < client.getPlayerCount(); ++i) {
+        std::ostringstream name;
+        name << "Player " << i;
+        Player * player = new Player(name.str(), game);
+        player->giveMoney(STARTING_MONEY);
+        game.add(player);
+    }
+    game.start(game.getPlayer(0));
+
+    // The moves only need to be repeatable, not random
+    unsigned seed = client.getId() * 7919 + 1;
+    int turn, move;
+    for (turn = 0; turn < turns; ++turn) {
+        for (move = 0; move < MOVES_PER_TURN; ++move) {
+            seed = seed * 1103515245 + 12345;
+            int to = (seed >> 16) % client.getPlayerCount();
+            client.submit(PayMove(client.getId(), to, (seed >> 8) % 50));
+        }
+        if (turn == desyncTurn && client.getId() == 0)
+            game.getPlayer(0)->giveMoney(1);
+        if (!client.endTurn())
+            return client.isDesynced() ? CLIENT_DESYNC : CLIENT_ERROR;
+    }
+    return CLIENT_OK;
+}
+
+int main(int argc, char * argv[]) {
+    unsigned clients = argc > 1 ? atoi(argv[1]) : DEFAULT_CLIENTS;
+    int turns = argc > 2 ? atoi(argv[2]) : DEFAULT_TURNS;
+    unsigned short port = argc > 3 ? atoi(argv[3]) : DEFAULT_PORT;
+    int desyncTurn = argc > 4 ? atoi(argv[4]) : -1;
+
+    Move::registerType("pay", &PayMove::parse);
+
+    LockstepServer server(clients);
+    if (!server.listen(port)) {
+        std::cerr << "Could not listen on port " << port << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Start the clients
+    std::vector<pid_t> children;
+    unsigned i;
+    for (i = 0; i < clients; ++i) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            server.close();
+            _exit(runClient(port, turns, desyncTurn));
+        }
+        if (pid < 0) {
+            std::cerr << "Could not start client " << i << std::endl;
+            return EXIT_FAILURE;
+        }
+        children.push_back(pid);
+    }
+
+    // Relay the game
+    bool ok = server.acceptPlayers();
+    while (ok && server.getTurn() < turns) ok = server.relayTurn();
+    server.close();
+
+    // Collect the clients
+    int failures = 0, desyncs = 0;
+    for (i = 0; i < children.size(); ++i) {
+        int status = 0;
+        waitpid(children[i], &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : CLIENT_ERROR;
+        if (code == CLIENT_DESYNC) ++desyncs;
+        else if (code != CLIENT_OK) ++failures;
+    }
+
+    std::cout << clients << " clients, " << server.getTurn() << "/" << turns
+              << " turns, " << server.getBytesRelayed()
+              << " bytes of orders relayed" << std::endl;
+    if (server.isDesynced())
+        std::cout << "Desync detected on turn " << server.getTurn()
+                  << " by " << desyncs << " clients" << std::endl;
+
+    bool expected = desyncTurn >= 0 && desyncTurn < turns ?
+        server.isDesynced() && desyncs == (int) clients :
+        ok && !server.isDesynced() && failures == 0 && desyncs == 0;
+    return expected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
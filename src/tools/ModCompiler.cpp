@@ -0,0 +1,59 @@
+//      ModCompiler.cpp -- Compiles mods into binary bundles.
+//
+//      Copyright 2011 Kevin Harrison <keharriso@gmail.com>
+//
+//      This file is part of Aftermath.
+//
+//      Aftermath is free software: you can redistribute it and/or modify
+//      it under the terms of the GNU General Public License as published by
+//      the Free Software Foundation, either version 3 of the License, or
+//      (at your option) any later version.
+//
+//      Aftermath is distributed in the hope that it will be useful,
+//      but WITHOUT ANY WARRANTY; without even the implied warranty of
+//      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//      GNU General Public License for more details.
+//
+//      You should have received a copy of the GNU General Public License
+//      along with Aftermath.  If not, see <http://www.gnu.org/licenses/>
+
+// Usage: Aftermath-modc <mod folder>...
+//
+// Loads each mod from its text data files and writes a ModBundle next to
+// them, in "<mod folder>/data/mod.bundle". The game then loads the bundle
+// instead of parsing the files, until the files change. The exit code is 0
+// when every mod was compiled. What went wrong with a mod is written to
+// the log file in the current folder.
+
+#include <cstdlib>
+#include <iostream>
+
+#include "../engine/App.hpp"
+#include "../Mod.hpp"
+
+using namespace Aftermath;
+
+// The App is never initialized, so the log is opened here
+#define LOG_FILE "Aftermath-modc.log"
+
+int main(int argc, char * argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <mod folder>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+    Engine::App app("Aftermath mod compiler");
+    app.getLogger().open(LOG_FILE);
+    if (!app.getLogger().isOpen())
+        std::cerr << "Could not open " << LOG_FILE << std::endl;
+    int failures = 0, i;
+    for (i = 1; i < argc; ++i) {
+        // A fresh Mod each time, so that nothing is shared between mods
+        Mod mod(app);
+        if (!mod.load(argv[i]) || !mod.compile()) {
+            std::cerr << "Could not compile " << argv[i] << ", see "
+                      << LOG_FILE << std::endl;
+            ++failures;
+        } else std::cout << "Compiled " << argv[i] << std::endl;
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}